@@ -0,0 +1,340 @@
+/// This file contains the ColorConvert span converters.
+///
+/// Each converter has a word at a time loop, which does the same shifts
+/// and masks to two or more pixels at once, and a scalar loop that does
+/// the rest, or all of them when the word loop is not built. Words are
+/// loaded and stored with memcpy, which the compiler turns into a single
+/// load or store, so the byte pointers need no alignment.
+///
+#include <string.h>
+#include "ColorConvert.h"
+
+// The word loops assume a little endian target, as every Cortex-M is.
+#if !defined(COLOR_SCALAR) && !defined(__BIG_ENDIAN) \
+    && !(defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+#define COLOR_SWAR
+#endif
+
+
+static inline uint32_t Load32(const void * p)
+{
+    uint32_t w;
+
+    memcpy(&w, p, 4);
+    return w;
+}
+
+
+static inline void Store32(void * p, uint32_t w)
+{
+    memcpy(p, &w, 4);
+}
+
+
+#ifdef COLOR_SWAR
+// Swap the first and third bytes of each of the four three byte pixels
+// in w0..w2:  r0 g0 b0 r1 | g1 b1 r2 g2 | b2 r3 g3 b3
+// become      b0 g0 r0 b1 | g1 r1 b2 g2 | r2 b3 g3 r3
+static inline void SwapRB4(uint32_t & w0, uint32_t & w1, uint32_t & w2)
+{
+    uint32_t o0 = ((w0 >> 16) & 0xFF) | (w0 & 0xFF00) | ((w0 & 0xFF) << 16) | ((w1 & 0xFF00) << 16);
+    uint32_t o1 = (w1 & 0xFF) | ((w0 >> 16) & 0xFF00) | ((w2 & 0xFF) << 16) | (w1 & 0xFF000000);
+    uint32_t o2 = ((w1 >> 16) & 0xFF) | ((w2 >> 16) & 0xFF00) | (w2 & 0xFF0000) | ((w2 & 0xFF00) << 16);
+
+    w0 = o0;
+    w1 = o1;
+    w2 = o2;
+}
+
+
+// Pack the four RGB888 pixels in w0..w2 to RGB565, two to a word.
+static inline void Pack4(uint32_t w0, uint32_t w1, uint32_t w2, uint32_t & p01, uint32_t & p23)
+{
+    uint32_t p0 = ((w0 & 0xF8) << 8) | ((w0 >> 5) & 0x07E0) | ((w0 >> 19) & 0x1F);
+    uint32_t p1 = ((w0 >> 16) & 0xF800) | ((w1 & 0xFC) << 3) | ((w1 >> 11) & 0x1F);
+    uint32_t p2 = ((w1 >> 8) & 0xF800) | ((w1 >> 21) & 0x07E0) | ((w2 >> 3) & 0x1F);
+    uint32_t p3 = (w2 & 0xF800) | ((w2 >> 13) & 0x07E0) | (w2 >> 27);
+
+    p01 = p0 | (p1 << 16);
+    p23 = p2 | (p3 << 16);
+}
+
+
+// Pack the four BGR888 pixels in w0..w2 to RGB565, two to a word:
+//   b0 g0 r0 b1 | g1 r1 b2 g2 | r2 b3 g3 r3
+static inline void PackBGR4(uint32_t w0, uint32_t w1, uint32_t w2, uint32_t & p01, uint32_t & p23)
+{
+    uint32_t p0 = ((w0 >> 8) & 0xF800) | ((w0 >> 5) & 0x07E0) | ((w0 >> 3) & 0x1F);
+    uint32_t p1 = (w1 & 0xF800) | ((w1 & 0xFC) << 3) | (w0 >> 27);
+    uint32_t p2 = ((w2 & 0xF8) << 8) | ((w1 >> 21) & 0x07E0) | ((w1 >> 19) & 0x1F);
+    uint32_t p3 = ((w2 >> 16) & 0xF800) | ((w2 >> 13) & 0x07E0) | ((w2 >> 11) & 0x1F);
+
+    p01 = p0 | (p1 << 16);
+    p23 = p2 | (p3 << 16);
+}
+
+
+// Widen the two RGB565 colors in w to one channel word each, with a byte
+// of each color in bits 0..7 and 16..23.
+static inline void Widen2(uint32_t w, uint32_t & r, uint32_t & g, uint32_t & b)
+{
+    r = ((w >> 8) & 0x00F800F8) | ((w >> 13) & 0x00070007);
+    g = ((w >> 3) & 0x00FC00FC) | ((w >> 9) & 0x00030003);
+    b = ((w << 3) & 0x00F800F8) | ((w >> 2) & 0x00070007);
+}
+
+
+// Store the four colors widened to the channel words a and b, as three
+// byte pixels of the channels c0, c1, c2 in that order.
+static inline void Unpack4(uint8_t * dst, uint32_t a0, uint32_t a1, uint32_t a2,
+    uint32_t b0, uint32_t b1, uint32_t b2)
+{
+    Store32(dst, (a0 & 0xFF) | ((a1 & 0xFF) << 8) | ((a2 & 0xFF) << 16) | ((a0 & 0xFF0000) << 8));
+    Store32(dst + 4, (a1 >> 16) | ((a2 >> 8) & 0xFF00) | ((b0 & 0xFF) << 16) | ((b1 & 0xFF) << 24));
+    Store32(dst + 8, (b2 & 0xFF) | ((b0 >> 8) & 0xFF00) | (b1 & 0xFF0000) | ((b2 << 8) & 0xFF000000));
+}
+
+
+// Swap the bytes of the two colors in a word.
+static inline uint32_t Swap2(uint32_t w)
+{
+    return ((w & 0x00FF00FF) << 8) | ((w >> 8) & 0x00FF00FF);
+}
+#endif
+
+
+// Store a color, in host order or high byte first.
+static inline void StoreColor(uint8_t * dst, color_t c, bool wire)
+{
+    if (wire) {
+        dst[0] = (uint8_t)(c >> 8);
+        dst[1] = (uint8_t)c;
+    } else {
+        memcpy(dst, &c, 2);
+    }
+}
+
+
+static void Pack888(uint8_t * dst, const uint8_t * src, uint32_t count, bool bgr, bool wire)
+{
+#ifdef COLOR_SWAR
+    while (count >= 4) {
+        uint32_t w0 = Load32(src);
+        uint32_t w1 = Load32(src + 4);
+        uint32_t w2 = Load32(src + 8);
+        uint32_t p01, p23;
+
+        if (bgr)
+            PackBGR4(w0, w1, w2, p01, p23);
+        else
+            Pack4(w0, w1, w2, p01, p23);
+        if (wire) {
+            p01 = Swap2(p01);
+            p23 = Swap2(p23);
+        }
+        Store32(dst, p01);
+        Store32(dst + 4, p23);
+        src += 12;
+        dst += 8;
+        count -= 4;
+    }
+#endif
+    while (count--) {
+        color_t c = (bgr) ? RGB888To565(src[2], src[1], src[0]) : RGB888To565(src[0], src[1], src[2]);
+
+        StoreColor(dst, c, wire);
+        src += 3;
+        dst += 2;
+    }
+}
+
+
+void RGB888ToRGB565(color_t * dst, const uint8_t * src, uint32_t count)
+{
+    Pack888((uint8_t *)dst, src, count, false, false);
+}
+
+
+void BGR888ToRGB565(color_t * dst, const uint8_t * src, uint32_t count)
+{
+    Pack888((uint8_t *)dst, src, count, true, false);
+}
+
+
+void RGB888ToWire565(uint8_t * dst, const uint8_t * src, uint32_t count)
+{
+    Pack888(dst, src, count, false, true);
+}
+
+
+void BGR888ToWire565(uint8_t * dst, const uint8_t * src, uint32_t count)
+{
+    Pack888(dst, src, count, true, true);
+}
+
+
+void RGB565ToWire(uint8_t * dst, const color_t * src, uint32_t count)
+{
+#ifdef COLOR_SWAR
+    while (count >= 2) {
+        Store32(dst, Swap2(Load32(src)));       // high byte first is swapped, here
+        src += 2;
+        dst += 4;
+        count -= 2;
+    }
+#endif
+    while (count--) {
+        StoreColor(dst, *src++, true);
+        dst += 2;
+    }
+}
+
+
+void WireToRGB565(color_t * dst, const uint8_t * src, uint32_t count)
+{
+#ifdef COLOR_SWAR
+    while (count >= 2) {
+        Store32(dst, Swap2(Load32(src)));
+        src += 4;
+        dst += 2;
+        count -= 2;
+    }
+#endif
+    while (count--) {
+        *dst++ = (color_t)((src[0] << 8) | src[1]);
+        src += 2;
+    }
+}
+
+
+static void Unpack565(uint8_t * dst, const color_t * src, uint32_t count, bool bgr)
+{
+#ifdef COLOR_SWAR
+    while (count >= 4) {
+        uint32_t ra, ga, ba, rb, gb, bb;
+
+        Widen2(Load32(src), ra, ga, ba);
+        Widen2(Load32(src + 2), rb, gb, bb);
+        if (bgr)
+            Unpack4(dst, ba, ga, ra, bb, gb, rb);
+        else
+            Unpack4(dst, ra, ga, ba, rb, gb, bb);
+        src += 4;
+        dst += 12;
+        count -= 4;
+    }
+#endif
+    while (count--) {
+        color_t c = *src++;
+        uint8_t r = ((c >> 8) & 0xF8) | (c >> 13);
+        uint8_t g = ((c >> 3) & 0xFC) | ((c >> 9) & 0x03);
+        uint8_t b = ((c << 3) & 0xF8) | ((c >> 2) & 0x07);
+
+        *dst++ = (bgr) ? b : r;
+        *dst++ = g;
+        *dst++ = (bgr) ? r : b;
+    }
+}
+
+
+void RGB565ToRGB888(uint8_t * dst, const color_t * src, uint32_t count)
+{
+    Unpack565(dst, src, count, false);
+}
+
+
+void RGB565ToBGR888(uint8_t * dst, const color_t * src, uint32_t count)
+{
+    Unpack565(dst, src, count, true);
+}
+
+
+void RGB565ToRGB332(uint8_t * dst, const color_t * src, uint32_t count)
+{
+#ifdef COLOR_SWAR
+    while (count >= 4) {
+        uint32_t w0 = Load32(src);
+        uint32_t w1 = Load32(src + 2);
+
+        // each word leaves its two bytes in bits 0..7 and 16..23
+        w0 = ((w0 >> 8) & 0x00E000E0) | ((w0 >> 6) & 0x001C001C) | ((w0 >> 3) & 0x00030003);
+        w1 = ((w1 >> 8) & 0x00E000E0) | ((w1 >> 6) & 0x001C001C) | ((w1 >> 3) & 0x00030003);
+        Store32(dst, ((w0 | (w0 >> 8)) & 0xFFFF) | ((w1 | (w1 >> 8)) << 16));
+        src += 4;
+        dst += 4;
+        count -= 4;
+    }
+#endif
+    while (count--)
+        *dst++ = RGB565To332(*src++);
+}
+
+
+void RGB332ToRGB565(color_t * dst, const uint8_t * src, uint32_t count)
+{
+#ifdef COLOR_SWAR
+    while (count >= 4) {
+        uint32_t w = Load32(src);
+        uint32_t e = w & 0x00FF00FF;            // pixels 0 and 2, one to each half
+        uint32_t o = (w >> 8) & 0x00FF00FF;     // pixels 1 and 3
+
+        e = ((e & 0x00E000E0) << 8) | ((e & 0x00C000C0) << 5)
+            | ((e & 0x001C001C) << 6) | ((e & 0x001C001C) << 3)
+            | ((e & 0x00030003) << 3) | ((e & 0x00030003) << 1) | ((e & 0x00020002) >> 1);
+        o = ((o & 0x00E000E0) << 8) | ((o & 0x00C000C0) << 5)
+            | ((o & 0x001C001C) << 6) | ((o & 0x001C001C) << 3)
+            | ((o & 0x00030003) << 3) | ((o & 0x00030003) << 1) | ((o & 0x00020002) >> 1);
+        Store32(dst, (e & 0xFFFF) | (o << 16));
+        Store32(dst + 2, (e >> 16) | (o & 0xFFFF0000));
+        src += 4;
+        dst += 4;
+        count -= 4;
+    }
+#endif
+    while (count--)
+        *dst++ = RGB332To565(*src++);
+}
+
+
+void SwapRedBlue888(uint8_t * dst, const uint8_t * src, uint32_t count)
+{
+#ifdef COLOR_SWAR
+    while (count >= 4) {
+        uint32_t w0 = Load32(src);
+        uint32_t w1 = Load32(src + 4);
+        uint32_t w2 = Load32(src + 8);
+
+        SwapRB4(w0, w1, w2);
+        Store32(dst, w0);
+        Store32(dst + 4, w1);
+        Store32(dst + 8, w2);
+        src += 12;
+        dst += 12;
+        count -= 4;
+    }
+#endif
+    while (count--) {
+        uint8_t t = src[0];
+
+        dst[1] = src[1];
+        dst[0] = src[2];
+        dst[2] = t;
+        src += 3;
+        dst += 3;
+    }
+}
+
+
+void SwapColorBytes(color_t * dst, const color_t * src, uint32_t count)
+{
+#ifdef COLOR_SWAR
+    while (count >= 2) {
+        Store32(dst, Swap2(Load32(src)));
+        src += 2;
+        dst += 2;
+        count -= 2;
+    }
+#endif
+    while (count--)
+        *dst++ = SwapColorBytes(*src++);
+}
@@ -0,0 +1,201 @@
+/// ColorConvert - pixel format conversions, one pixel or a span at a time.
+///
+/// The formats are those the display and the image files use:
+///   - RGB565, as color_t, RRRR RGGG GGGB BBBB.
+///   - RGB332, one byte per pixel, RRRG GGBB, the display in 8-bit color.
+///   - RGB888, three bytes per pixel in R, G, B order, as from the JPEG
+///     decoder, and BGR888 in B, G, R order, as in a .bmp file.
+///   - byte-swapped RGB565, as read back by getPixel and getPixelStream.
+///   - wire order RGB565, as bytes, high byte first, as the display takes
+///     it. @see PixelFormat_T.
+///
+/// Narrowing keeps the high bits of each channel, and widening repeats
+/// them into the low bits, so full scale stays full scale, and any
+/// narrow color survives the trip through the wide format unchanged.
+///
+/// The span converters work a 32-bit word at a time on a little endian
+/// target, two to four pixels per step, and fall back to a pixel at a
+/// time elsewhere, or when COLOR_SCALAR is defined. Both give the same
+/// result as the one pixel converters.
+///
+/// This depends only on DisplayDefs.h, so it builds and can be tested
+/// on the host as well. test/host/ColorConvertTest.cpp checks every span
+/// against the one pixel converters, and reports pixels per cycle, with
+/// and without COLOR_SCALAR.
+///
+#ifndef COLORCONVERT_H
+#define COLORCONVERT_H
+#include <stdint.h>
+#include "DisplayDefs.h"
+
+/// Convert one 24-bit color to RGB565, the same as the RGB(r,g,b) macro.
+///
+/// @param[in] r is the red value, 0 to 255.
+/// @param[in] g is the green value, 0 to 255.
+/// @param[in] b is the blue value, 0 to 255.
+/// @returns the color in color_t format.
+///
+inline color_t RGB888To565(uint8_t r, uint8_t g, uint8_t b)
+{
+    return (color_t)(((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3));
+}
+
+/// Convert one RGB565 color to RGB332.
+///
+/// @param[in] c is the color in color_t format.
+/// @returns the color as RGB332.
+///
+inline uint8_t RGB565To332(color_t c)
+{
+    return (uint8_t)(((c >> 8) & 0xE0) | ((c >> 6) & 0x1C) | ((c >> 3) & 0x03));
+}
+
+/// Convert one RGB332 color to RGB565.
+///
+/// @param[in] c8 is the color as RGB332.
+/// @returns the color in color_t format.
+///
+inline color_t RGB332To565(uint8_t c8)
+{
+    color_t c = c8;
+
+    return (color_t)(((c & 0xE0) << 8) | ((c & 0xC0) << 5)
+        | ((c & 0x1C) << 6) | ((c & 0x1C) << 3)
+        | ((c & 0x03) << 3) | ((c & 0x03) << 1) | ((c & 0x03) >> 1));
+}
+
+/// Swap the bytes of one RGB565 color, to or from the order that
+/// getPixel and getPixelStream return.
+///
+/// @param[in] c is the color.
+/// @returns the color with its bytes swapped.
+///
+inline color_t SwapColorBytes(color_t c)
+{
+    return (color_t)((c << 8) | (c >> 8));
+}
+
+/// Convert a span of RGB888 pixels to RGB565.
+///
+/// dst may be the same as src, so a buffer can be converted in place.
+///
+/// @param[out] dst is where count colors are written.
+/// @param[in] src is count pixels of three bytes, in R, G, B order.
+/// @param[in] count is the number of pixels.
+///
+void RGB888ToRGB565(color_t * dst, const uint8_t * src, uint32_t count);
+
+/// Convert a span of BGR888 pixels, as in a .bmp file, to RGB565.
+///
+/// dst may be the same as src, so a buffer can be converted in place.
+///
+/// @param[out] dst is where count colors are written.
+/// @param[in] src is count pixels of three bytes, in B, G, R order.
+/// @param[in] count is the number of pixels.
+///
+void BGR888ToRGB565(color_t * dst, const uint8_t * src, uint32_t count);
+
+/// Convert a span of RGB888 pixels to wire order RGB565.
+///
+/// dst may be the same as src, so a buffer can be converted in place.
+///
+/// @param[out] dst is where count colors of two bytes are written, high
+///     byte first.
+/// @param[in] src is count pixels of three bytes, in R, G, B order.
+/// @param[in] count is the number of pixels.
+///
+void RGB888ToWire565(uint8_t * dst, const uint8_t * src, uint32_t count);
+
+/// Convert a span of BGR888 pixels, as in a .bmp file, to wire order
+/// RGB565.
+///
+/// dst may be the same as src, so a buffer can be converted in place.
+///
+/// @param[out] dst is where count colors of two bytes are written, high
+///     byte first.
+/// @param[in] src is count pixels of three bytes, in B, G, R order.
+/// @param[in] count is the number of pixels.
+///
+void BGR888ToWire565(uint8_t * dst, const uint8_t * src, uint32_t count);
+
+/// Convert a span of RGB565 colors to wire order.
+///
+/// dst may be the same as src, so a buffer can be converted in place.
+///
+/// @param[out] dst is where count colors of two bytes are written, high
+///     byte first.
+/// @param[in] src is count colors.
+/// @param[in] count is the number of pixels.
+///
+void RGB565ToWire(uint8_t * dst, const color_t * src, uint32_t count);
+
+/// Convert a span of wire order RGB565 to colors.
+///
+/// dst may be the same as src, so a buffer can be converted in place.
+///
+/// @param[out] dst is where count colors are written.
+/// @param[in] src is count colors of two bytes, high byte first.
+/// @param[in] count is the number of pixels.
+///
+void WireToRGB565(color_t * dst, const uint8_t * src, uint32_t count);
+
+/// Convert a span of RGB565 colors to RGB888.
+///
+/// @param[out] dst is where count pixels of three bytes are written, in
+///     R, G, B order. It must not overlap src.
+/// @param[in] src is count colors.
+/// @param[in] count is the number of pixels.
+///
+void RGB565ToRGB888(uint8_t * dst, const color_t * src, uint32_t count);
+
+/// Convert a span of RGB565 colors to BGR888, as in a .bmp file.
+///
+/// @param[out] dst is where count pixels of three bytes are written, in
+///     B, G, R order. It must not overlap src.
+/// @param[in] src is count colors.
+/// @param[in] count is the number of pixels.
+///
+void RGB565ToBGR888(uint8_t * dst, const color_t * src, uint32_t count);
+
+/// Convert a span of RGB565 colors to RGB332.
+///
+/// dst may be the same as src, so a buffer can be converted in place.
+///
+/// @param[out] dst is where count bytes are written.
+/// @param[in] src is count colors.
+/// @param[in] count is the number of pixels.
+///
+void RGB565ToRGB332(uint8_t * dst, const color_t * src, uint32_t count);
+
+/// Convert a span of RGB332 colors to RGB565.
+///
+/// @param[out] dst is where count colors are written. It must not
+///     overlap src.
+/// @param[in] src is count bytes.
+/// @param[in] count is the number of pixels.
+///
+void RGB332ToRGB565(color_t * dst, const uint8_t * src, uint32_t count);
+
+/// Swap red and blue in a span of three byte pixels, which converts
+/// RGB888 to BGR888, and back.
+///
+/// dst may be the same as src, so a buffer can be converted in place.
+///
+/// @param[out] dst is where count pixels of three bytes are written.
+/// @param[in] src is count pixels of three bytes.
+/// @param[in] count is the number of pixels.
+///
+void SwapRedBlue888(uint8_t * dst, const uint8_t * src, uint32_t count);
+
+/// Swap the bytes of a span of RGB565 colors, to or from the order that
+/// getPixel and getPixelStream return.
+///
+/// dst may be the same as src, so a buffer can be converted in place.
+///
+/// @param[out] dst is where count colors are written.
+/// @param[in] src is count colors.
+/// @param[in] count is the number of pixels.
+///
+void SwapColorBytes(color_t * dst, const color_t * src, uint32_t count);
+
+#endif // COLORCONVERT_H
@@ -0,0 +1,240 @@
+/// This file contains the DeferredFrame methods.
+///
+#include "DeferredFrame.h"
+
+//#define DEBUG "FRAM"
+// ...
+// INFO("Stuff to show %d", var); // new-line is automatically appended
+//
+#if (defined(DEBUG) && !defined(TARGET_LPC11U24))
+#define INFO(x, ...) std::printf("[INF %s %4d] "x"\r\n", DEBUG, __LINE__, ##__VA_ARGS__);
+#define WARN(x, ...) std::printf("[WRN %s %4d] "x"\r\n", DEBUG, __LINE__, ##__VA_ARGS__);
+#define ERR(x, ...)  std::printf("[ERR %s %4d] "x"\r\n", DEBUG, __LINE__, ##__VA_ARGS__);
+#else
+#define INFO(x, ...)
+#define WARN(x, ...)
+#define ERR(x, ...)
+#endif
+
+
+static uint32_t Area(const rect_t & r)
+{
+    return (uint32_t)(r.p2.x - r.p1.x + 1) * (uint32_t)(r.p2.y - r.p1.y + 1);
+}
+
+
+DeferredFrame::DeferredFrame(RA8875 & _lcd)
+    : lcd(_lcd)
+{
+    recording = false;
+    count = 0;
+    ClearStats();
+}
+
+
+void DeferredFrame::ClearStats(void)
+{
+    memset(&stats, 0, sizeof(stats));
+}
+
+
+void DeferredFrame::Begin(void)
+{
+    count = 0;
+    recording = true;
+}
+
+
+RetCode_t DeferredFrame::End(void)
+{
+    RetCode_t r = _Flush();
+
+    recording = false;
+    stats.frames++;
+    return r;
+}
+
+
+RetCode_t DeferredFrame::FillRect(rect_t r, color_t color)
+{
+    Draw_T d;
+
+    memset(&d, 0, sizeof(d));
+    d.r = r;
+    d.kind = DrawFill;
+    d.opaque = true;
+    d.color = color;
+    return _Record(d);
+}
+
+
+RetCode_t DeferredFrame::Image(rect_t r, const color_t * pixels, dim_t stride)
+{
+    Draw_T d;
+
+    if (pixels == NULL)
+        return bad_parameter;
+    memset(&d, 0, sizeof(d));
+    d.r = r;
+    d.kind = DrawImage;
+    d.opaque = true;
+    d.pixels = pixels;
+    d.stride = (stride) ? stride : r.p2.x - r.p1.x + 1;
+    return _Record(d);
+}
+
+
+RetCode_t DeferredFrame::Draw(rect_t bounds, FrameDraw_T draw, void * context,
+    bool opaque, uint32_t bytes)
+{
+    Draw_T d;
+
+    if (draw == NULL)
+        return bad_parameter;
+    memset(&d, 0, sizeof(d));
+    d.r = bounds;
+    d.kind = DrawCall;
+    d.opaque = opaque;
+    d.draw = draw;
+    d.context = context;
+    d.bytes = bytes;
+    return _Record(d);
+}
+
+
+RetCode_t DeferredFrame::_Record(const Draw_T & d)
+{
+    RetCode_t r = noerror;
+
+    if (d.r.p2.x < d.r.p1.x || d.r.p2.y < d.r.p1.y)
+        return bad_parameter;
+    if (count >= FRAME_MAX_DRAWS)
+        r = _Flush();                   // less is culled, but the order is kept
+    draws[count] = d;
+    draws[count].pieces = -1;
+    count++;
+    stats.draws++;
+    if (!recording)
+        r = _Flush();
+    return r;
+}
+
+
+// Work back from the last draw, with what the later opaque draws cover,
+// to find what each draw shows.
+void DeferredFrame::_Cull(void)
+{
+    Region cover(coverStore, FRAME_COVER_RECTS);
+    Region backup(backupStore, FRAME_COVER_RECTS);
+    rect_t showStore[FRAME_COVER_RECTS];
+    Region show(showStore, FRAME_COVER_RECTS);
+    int used = 0;
+    int bytesPerPixel = lcd.color_bpp() / 8;
+
+    for (int i=count - 1; i>=0; i--) {
+        Draw_T * d = &draws[i];
+
+        d->pieces = -1;
+        if (!cover.IsEmpty()) {
+            show.Set(d->r);
+            show.Subtract(cover);               // when it fails, it shows more
+            if (show.IsEmpty()) {
+                d->pieces = 0;
+            } else if (show.Area() < Area(d->r)) {
+                int room = FRAME_MAX_PIECES - used;
+                int n = 0;
+
+                if (d->kind == DrawImage && room > 0) {
+                    n = show.Simplify(&piece[used], room, FRAME_DRAW_COST, bytesPerPixel);
+                } else if (room > 0 && (d->kind == DrawCall || show.Count() == 1)) {
+                    piece[used] = show.Bounds();
+                    n = 1;
+                }
+                if (n) {
+                    d->first = used;
+                    d->pieces = n;
+                    used += n;
+                }
+            }
+        }
+        if (d->opaque) {
+            // A cover that overflows grows, and would hide what shows, so
+            // then it stays as it was.
+            backup.Set(cover);
+            if (cover.Union(d->r) != noerror)
+                cover.Set(backup);
+        }
+    }
+}
+
+
+uint32_t DeferredFrame::_Cost(const Draw_T & d, rect_t r)
+{
+    switch (d.kind) {
+        case DrawImage:
+            return FRAME_DRAW_COST + Area(r) * (lcd.color_bpp() / 8);
+        case DrawCall:
+            return FRAME_DRAW_COST + d.bytes;
+        default:
+            return FRAME_DRAW_COST;
+    }
+}
+
+
+void DeferredFrame::_Send(const Draw_T & d, rect_t r)
+{
+    dim_t w = r.p2.x - r.p1.x + 1;
+
+    switch (d.kind) {
+        case DrawFill:
+            lcd.fillrect(r, d.color);
+            break;
+        case DrawImage:
+            lcd.window(r);
+            if (r.p1.x == d.r.p1.x && w == d.stride) {         // rows follow on in memory
+                lcd.pixelStream((color_t *)d.pixels + (r.p1.y - d.r.p1.y) * d.stride,
+                    Area(r), r.p1.x, r.p1.y);
+            } else {
+                for (loc_t y = r.p1.y; y <= r.p2.y; y++)
+                    lcd.pixelStream((color_t *)d.pixels + (y - d.r.p1.y) * d.stride + (r.p1.x - d.r.p1.x),
+                        w, r.p1.x, y);
+            }
+            lcd.window();
+            break;
+        case DrawCall:
+            lcd.window(r);
+            d.draw(lcd, d.context);
+            lcd.window();
+            break;
+    }
+}
+
+
+RetCode_t DeferredFrame::_Flush(void)
+{
+    _Cull();
+    for (int i=0; i<count; i++) {
+        const Draw_T & d = draws[i];
+        uint32_t whole = _Cost(d, d.r);
+        uint32_t sent = 0;
+
+        if (d.pieces < 0) {
+            _Send(d, d.r);
+            sent = whole;
+        } else if (d.pieces == 0) {
+            stats.culled++;
+        } else {
+            for (int k=0; k<d.pieces; k++) {
+                _Send(d, piece[d.first + k]);
+                sent += _Cost(d, piece[d.first + k]);
+            }
+            stats.clipped++;
+        }
+        stats.bytes += sent;
+        if (sent < whole)
+            stats.culledBytes += whole - sent;
+    }
+    INFO("flush %d draws, %d culled", count, stats.culled);
+    count = 0;
+    return noerror;
+}
@@ -0,0 +1,170 @@
+/// DeferredFrame - record a frame, and skip what a later draw hides.
+///
+/// Within a frame, an opaque draw hides whatever was drawn beneath it,
+/// yet each of those pixels has already gone over the bus. A deferred
+/// frame records the draws instead, and at the end of the frame works
+/// back from the last one, to find what each earlier draw still shows.
+/// A draw that is hidden is skipped, and an image that is partly hidden
+/// sends only the part that shows.
+///
+#ifndef DEFERREDFRAME_H
+#define DEFERREDFRAME_H
+#include "RA8875.h"
+#include "Region.h"
+
+/// The most draws recorded. When there are more, those recorded are
+/// drawn, and the frame continues.
+#ifndef FRAME_MAX_DRAWS
+#define FRAME_MAX_DRAWS 32
+#endif
+
+/// The rectangles for the parts of draws that show, shared by the frame.
+#ifndef FRAME_MAX_PIECES
+#define FRAME_MAX_PIECES 64
+#endif
+
+/// The rectangles that track what the opaque draws hide.
+#ifndef FRAME_COVER_RECTS
+#define FRAME_COVER_RECTS 32
+#endif
+
+/// The bytes to start a draw, for the window, the cursor and the command,
+/// beyond its pixels.
+#define FRAME_DRAW_COST 40
+
+/// A draw that the frame cannot see into, such as text or lines.
+///
+/// @param[in] lcd is the display, with the window set to the part of
+///         the bounds that shows.
+/// @param[in] context is the pointer given to @ref DeferredFrame::Draw.
+///
+typedef void (* FrameDraw_T)(RA8875 & lcd, void * context);
+
+/// A frame of draws, of which only what shows is sent.
+///
+/// The order of the draws is kept, so a draw that is not opaque, such
+/// as text, is drawn over what was recorded before it. Outside of
+/// @ref Begin and @ref End, each draw is sent at once.
+///
+/// @code
+/// DeferredFrame frame(lcd);
+///
+/// frame.Begin();
+/// frame.Image(screenRect, wallpaper);        // hidden, but for the border
+/// frame.FillRect(panelRect, Black);
+/// frame.Draw(panelRect, DrawReadings, &readings);
+/// frame.End();                                // now it is sent
+/// @endcode
+///
+class DeferredFrame
+{
+public:
+    /// Statistics of the frames, since @ref ClearStats.
+    typedef struct {
+        uint32_t frames;        ///< frames ended
+        uint32_t draws;         ///< draws recorded
+        uint32_t culled;        ///< draws skipped, as hidden
+        uint32_t clipped;       ///< draws sent only in part
+        uint32_t bytes;         ///< bytes sent, by estimate
+        uint32_t culledBytes;   ///< bytes not sent, by estimate
+    } FrameStats_T;
+
+    /// Constructor for a deferred frame.
+    ///
+    /// @param[in] lcd is the display.
+    ///
+    DeferredFrame(RA8875 & lcd);
+
+    /// Start recording a frame.
+    ///
+    void Begin(void);
+
+    /// End the frame, and send what shows.
+    ///
+    /// @returns success/failure code. @see RetCode_t.
+    ///
+    RetCode_t End(void);
+
+    /// Fill a rectangle, which is opaque.
+    ///
+    /// A fill is a hardware operation, so whatever its size it costs
+    /// the same few bytes. It is skipped when hidden, and otherwise sent
+    /// whole, unless what shows is one rectangle.
+    ///
+    /// @param[in] r is the rectangle.
+    /// @param[in] color is the fill color.
+    /// @returns success/failure code. @see RetCode_t.
+    ///
+    RetCode_t FillRect(rect_t r, color_t color);
+
+    /// Draw an image from memory, which is opaque.
+    ///
+    /// @param[in] r is where it goes, which is the size of the image.
+    /// @param[in] pixels is the image, which must remain until the
+    ///         frame ends.
+    /// @param[in] stride is the pixels from one row to the next, or 0
+    ///         when it is the width.
+    /// @returns success/failure code. @see RetCode_t.
+    ///
+    RetCode_t Image(rect_t r, const color_t * pixels, dim_t stride = 0);
+
+    /// Draw with a callback, within some bounds.
+    ///
+    /// The callback is skipped when the bounds are hidden, and is
+    /// otherwise called once.
+    ///
+    /// @param[in] bounds holds all that it draws.
+    /// @param[in] draw is the callback.
+    /// @param[in] context is passed to the callback, and must remain
+    ///         until the frame ends.
+    /// @param[in] opaque is true when it covers all of the bounds.
+    /// @param[in] bytes is an estimate of what it sends, for the statistics.
+    /// @returns success/failure code. @see RetCode_t.
+    ///
+    RetCode_t Draw(rect_t bounds, FrameDraw_T draw, void * context,
+        bool opaque = false, uint32_t bytes = 0);
+
+    /// Get the statistics.
+    ///
+    /// @returns a reference to them.
+    ///
+    const FrameStats_T & GetStats(void) { return stats; }
+
+    /// Clear the statistics.
+    ///
+    void ClearStats(void);
+
+private:
+    typedef enum { DrawFill, DrawImage, DrawCall } Kind_T;
+
+    typedef struct {
+        rect_t r;
+        Kind_T kind;
+        bool opaque;
+        color_t color;
+        const color_t * pixels;
+        dim_t stride;
+        FrameDraw_T draw;
+        void * context;
+        uint32_t bytes;
+        int16_t first;              ///< the first piece
+        int16_t pieces;             ///< 0 when hidden, -1 when drawn whole
+    } Draw_T;
+
+    RetCode_t _Record(const Draw_T & d);
+    void _Cull(void);
+    void _Send(const Draw_T & d, rect_t r);
+    uint32_t _Cost(const Draw_T & d, rect_t r);
+    RetCode_t _Flush(void);
+
+    RA8875 & lcd;
+    bool recording;
+    Draw_T draws[FRAME_MAX_DRAWS];
+    int count;
+    rect_t piece[FRAME_MAX_PIECES];
+    rect_t coverStore[FRAME_COVER_RECTS];
+    rect_t backupStore[FRAME_COVER_RECTS];
+    FrameStats_T stats;
+};
+
+#endif // DEFERREDFRAME_H
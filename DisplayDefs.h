@@ -1,7 +1,7 @@
 #ifndef DISPLAYDEFS_H
 #define DISPLAYDEFS_H
 
-#define RGB(r,g,b) ( ((r<<8)&0xF800) | ((g<<3)&0x07E0) | (b>>3) )
+#define RGB(r,g,b) ( (((r)<<8)&0xF800) | (((g)<<3)&0x07E0) | ((b)>>3) )
 
 
 /// Return values from functions. Use this number, or use the 
@@ -86,6 +86,27 @@ typedef struct
 ///
 typedef uint16_t color_t;   
 
+/// The format of the pixels in a @ref PixelBuffer_T.
+///
+/// The display takes RGB565 high byte first, and RGB332 one byte per
+/// pixel. A color_t on a little endian processor is low byte first in
+/// memory, so it is swapped on the way out. Pixels already in the order
+/// of the wire are sent as they are.
+typedef enum
+{
+    HostRGB565,     ///< color_t, in the byte order of the processor
+    WireRGB565,     ///< RGB565, high byte first in memory, as the display takes it
+    WireRGB332,     ///< RGB332, one byte per pixel, as the display takes it in 8-bit color
+} PixelFormat_T;
+
+/// A buffer of pixels that carries its format. @see PixelFormat_T.
+typedef struct
+{
+    const void * data;      ///< the first pixel
+    uint32_t count;         ///< the number of pixels
+    PixelFormat_T format;   ///< the format, and so the byte order, of the pixels
+} PixelBuffer_T;
+
 /// background fill info for drawing Text, Rectangles, RoundedRectanges, Circles, Ellipses and Triangles.
 typedef enum
 {
@@ -0,0 +1,213 @@
+/// This file contains the Gauge methods.
+///
+#include "Gauge.h"
+
+//#define DEBUG "GAUG"
+// ...
+// INFO("Stuff to show %d", var); // new-line is automatically appended
+//
+#if (defined(DEBUG) && !defined(TARGET_LPC11U24))
+#define INFO(x, ...) std::printf("[INF %s %4d] "x"\r\n", DEBUG, __LINE__, ##__VA_ARGS__);
+#define WARN(x, ...) std::printf("[WRN %s %4d] "x"\r\n", DEBUG, __LINE__, ##__VA_ARGS__);
+#define ERR(x, ...)  std::printf("[ERR %s %4d] "x"\r\n", DEBUG, __LINE__, ##__VA_ARGS__);
+#else
+#define INFO(x, ...)
+#define WARN(x, ...)
+#define ERR(x, ...)
+#endif
+
+#define GAUGE_PI 3.14159265f
+#define GAUGE_START (225.0f * GAUGE_PI / 180.0f)    // the minimum, at the lower left
+#define GAUGE_SWEEP (270.0f * GAUGE_PI / 180.0f)    // clockwise to the maximum
+#define GAUGE_HUB 4                                 // radius of the hub
+
+
+Gauge::Gauge(RA8875 & _lcd, loc_t x, loc_t y, dim_t diameter, float _minimum, float _maximum,
+    int _divisions)
+    : Widget(x, y, diameter, diameter), lcd(_lcd)
+{
+    minimum = _minimum;
+    maximum = (_maximum > _minimum) ? _maximum : _minimum + 1.0f;
+    divisions = (_divisions > 0) ? _divisions : 1;
+    value = minimum;
+    needleColor = BrightRed;
+    cacheSet = false;
+    cacheLayer = 1;
+    cachePoint = bounds.p1;         // see _RenderFace
+    faceReady = false;
+    cached = false;
+    needleBox = bounds;
+    needleTip[0] = needleTip[1] = -1;
+}
+
+
+void Gauge::SetCache(uint16_t layer, point_t where)
+{
+    cacheSet = true;
+    cacheLayer = layer;
+    cachePoint = where;
+    faceReady = false;
+}
+
+
+void Gauge::SetNeedleColor(color_t color)
+{
+    needleColor = color;
+    Invalidate();
+}
+
+
+// The point at fraction f of the scale, at radius r from the center.
+point_t Gauge::_Polar(point_t center, float f, float r)
+{
+    float a = GAUGE_START - f * GAUGE_SWEEP;
+    point_t p;
+
+    p.x = center.x + (loc_t)(r * cos(a) + 0.5f);
+    p.y = center.y - (loc_t)(r * sin(a) + 0.5f);
+    return p;
+}
+
+
+// Draw the face with its top left at origin, on the current layer.
+void Gauge::_DrawFace(point_t origin)
+{
+    dim_t d = bounds.p2.x - bounds.p1.x + 1;
+    float r = (d - 1) / 2.0f;
+    point_t c = { (loc_t)(origin.x + (loc_t)r), (loc_t)(origin.y + (loc_t)r) };
+    int minors = divisions * 5;
+
+    lcd.fillrect(origin.x, origin.y, origin.x + d - 1, origin.y + d - 1,
+        (screen) ? screen->GetBackground() : Black);
+    lcd.fillcircle(c, (dim_t)r, bg);
+    lcd.circle(c, (dim_t)r, fg);
+    lcd.circle(c, (dim_t)r - 1, fg);
+    for (int i=0; i<=minors; i++) {
+        float f = (float)i / minors;
+        bool major = (i % 5) == 0;
+
+        lcd.line(_Polar(c, f, r * ((major) ? 0.80f : 0.88f)), _Polar(c, f, r * 0.95f), fg);
+    }
+    if (d >= 120) {                             // room for labels in the internal font
+        // The application's font and colors are put back after.
+        const uint8_t * saveFont = lcd.GetUserFont();
+        color_t saveFg = lcd.GetForeColor();
+        color_t saveBg = lcd.GetBackColor();
+
+        lcd.SelectUserFont();
+        lcd.foreground(fg);
+        lcd.background(bg);
+        for (int i=0; i<=divisions; i++) {
+            char buf[8];
+            float f = (float)i / divisions;
+            point_t p = _Polar(c, f, r * 0.64f);
+
+            snprintf(buf, sizeof(buf), "%d", (int)(minimum + f * (maximum - minimum)));
+            lcd.puts(p.x - (loc_t)(strlen(buf) * 4), p.y - 8, buf);
+        }
+        lcd.foreground(saveFg);
+        lcd.background(saveBg);
+        lcd.SelectUserFont(saveFont);
+    }
+}
+
+
+// Render the face into the cache, and report if the cache is usable.
+bool Gauge::_RenderFace(void)
+{
+    dim_t d = bounds.p2.x - bounds.p1.x + 1;
+    uint16_t prev = lcd.GetDrawingLayer();
+
+    if (!cacheSet) {                                    // the other layer, at the same place
+        cacheLayer = prev ^ 1;
+        cachePoint = bounds.p1;
+    }
+    lcd.SelectDrawingLayer(cacheLayer);
+    cached = (lcd.GetDrawingLayer() == cacheLayer)      // not when there is only one layer
+        && !lcd.IsLayerClaimed(cacheLayer);             // or it belongs to an overlay
+    if (cached) {
+        lcd.window(cachePoint.x, cachePoint.y, d, d);
+        _DrawFace(cachePoint);
+    }
+    lcd.SelectDrawingLayer(prev);
+    faceReady = true;
+    return cached;
+}
+
+
+// Stop using the cache when its layer was claimed after the face was
+// cached there, as by OverlayLayer::Begin, which fills it with its key color.
+void Gauge::_CheckCache(void)
+{
+    if (cached && lcd.IsLayerClaimed(cacheLayer))
+        cached = false;
+}
+
+
+void Gauge::_DrawNeedle(void)
+{
+    dim_t d = bounds.p2.x - bounds.p1.x + 1;
+    float r = (d - 1) / 2.0f;
+    point_t c = { (loc_t)(bounds.p1.x + (loc_t)r), (loc_t)(bounds.p1.y + (loc_t)r) };
+    float f = (value - minimum) / (maximum - minimum);
+    point_t tip = _Polar(c, f, r * 0.78f);
+    point_t b1 = _Polar(c, f + 0.25f, GAUGE_HUB - 1);
+    point_t b2 = _Polar(c, f - 0.25f, GAUGE_HUB - 1);
+
+    lcd.filltriangle(tip.x, tip.y, b1.x, b1.y, b2.x, b2.y, needleColor);
+    lcd.fillcircle(c, GAUGE_HUB, needleColor);
+    needleBox.p1.x = min(tip.x, c.x - GAUGE_HUB) - 1;
+    needleBox.p1.y = min(tip.y, c.y - GAUGE_HUB) - 1;
+    needleBox.p2.x = max(tip.x, c.x + GAUGE_HUB) + 1;
+    needleBox.p2.y = max(tip.y, c.y + GAUGE_HUB) + 1;
+    needleTip[0] = tip.x;
+    needleTip[1] = tip.y;
+}
+
+
+RetCode_t Gauge::SetValue(float _value)
+{
+    dim_t d = bounds.p2.x - bounds.p1.x + 1;
+    float r = (d - 1) / 2.0f;
+    point_t c = { (loc_t)(bounds.p1.x + (loc_t)r), (loc_t)(bounds.p1.y + (loc_t)r) };
+    point_t tip;
+
+    _value = (_value < minimum) ? minimum : (_value > maximum) ? maximum : _value;
+    value = _value;
+    if (!visible || !faceReady)
+        return noerror;                         // drawn when it is first drawn
+    tip = _Polar(c, (value - minimum) / (maximum - minimum), r * 0.78f);
+    if (tip.x == needleTip[0] && tip.y == needleTip[1])
+        return noerror;                         // not a pixel of difference
+    lcd.window(bounds);
+    _CheckCache();
+    if (cached) {
+        point_t src = { (loc_t)(cachePoint.x + needleBox.p1.x - bounds.p1.x),
+            (loc_t)(cachePoint.y + needleBox.p1.y - bounds.p1.y) };
+
+        lcd.BlockMove(lcd.GetDrawingLayer(), 0, needleBox.p1, cacheLayer, 0, src,
+            needleBox.p2.x - needleBox.p1.x + 1, needleBox.p2.y - needleBox.p1.y + 1, 0x2, 0xC);
+    } else {
+        _DrawFace(bounds.p1);
+    }
+    _DrawNeedle();
+    return lcd.window();
+}
+
+
+void Gauge::Draw(RA8875 & display, rect_t clip)
+{
+    dim_t d = bounds.p2.x - bounds.p1.x + 1;
+
+    if (!faceReady) {
+        _RenderFace();
+        display.window(clip);
+    }
+    _CheckCache();
+    if (cached)
+        display.BlockMove(display.GetDrawingLayer(), 0, bounds.p1, cacheLayer, 0, cachePoint,
+            d, d, 0x2, 0xC);
+    else
+        _DrawFace(bounds.p1);
+    _DrawNeedle();
+}
@@ -0,0 +1,102 @@
+/// Gauge - a round dial, whose face is drawn once and cached off-screen.
+///
+/// The face, with its ring, ticks and labels, is rendered once into
+/// display memory that is not shown. When the value changes, the box
+/// that held the old needle is restored from that copy with a BTE block
+/// move, and only the new needle is drawn. So an update costs a few
+/// hundred bytes on the bus, rather than the whole face.
+///
+#ifndef GAUGE_H
+#define GAUGE_H
+#include "Widgets.h"
+
+/// A round gauge, with a needle that sweeps 270 degrees clockwise from
+/// the lower left.
+///
+/// By default the face is cached in the other layer, at the same place.
+/// That layer must not be shown, and nothing else may be drawn there.
+/// @ref SetCache can put it elsewhere. When the display has only one
+/// layer, or the cache layer is claimed, as by an OverlayLayer, each
+/// update redraws the face. See @ref RA8875::ClaimLayer.
+///
+/// @code
+/// Gauge rpm(lcd, 300, 20, 160, 0, 8000, 8);
+///
+/// rpm.Draw(lcd, rpm.GetBounds());
+/// while (1)
+///     rpm.SetValue(ReadRPM());
+/// @endcode
+///
+class Gauge : public Widget
+{
+public:
+    /// Constructor for a gauge.
+    ///
+    /// @param[in] lcd is the display, which the gauge draws on as the value changes.
+    /// @param[in] x is the left edge.
+    /// @param[in] y is the top edge.
+    /// @param[in] diameter is the width and height.
+    /// @param[in] minimum is the value at the start of the scale.
+    /// @param[in] maximum is the value at the end of the scale.
+    /// @param[in] divisions is the number of labeled divisions of the scale.
+    ///
+    Gauge(RA8875 & lcd, loc_t x, loc_t y, dim_t diameter, float minimum, float maximum,
+        int divisions = 10);
+
+    /// Set where the face is cached.
+    ///
+    /// @param[in] layer is the layer, 0 or 1.
+    /// @param[in] where is the top left of a diameter square that is not shown.
+    ///
+    void SetCache(uint16_t layer, point_t where);
+
+    /// Set the color of the needle.
+    ///
+    /// @param[in] color is the color.
+    ///
+    void SetNeedleColor(color_t color);
+
+    /// Set the value, which moves the needle.
+    ///
+    /// @param[in] value is the value, which is limited to the scale.
+    /// @returns success/failure code. @see RetCode_t.
+    ///
+    RetCode_t SetValue(float value);
+
+    /// Get the value.
+    ///
+    /// @returns the value.
+    ///
+    float GetValue(void) { return value; }
+
+    /// Forget the cached face, so it is rendered again, as after a
+    /// change of colors.
+    ///
+    void FlushCache(void) { faceReady = false; }
+
+    virtual void Draw(RA8875 & lcd, rect_t clip);
+    virtual rect_t RedrawArea(rect_t /*damage*/) { return bounds; }
+
+private:
+    point_t _Polar(point_t center, float f, float r);
+    void _DrawFace(point_t origin);
+    bool _RenderFace(void);
+    void _CheckCache(void);
+    void _DrawNeedle(void);
+
+    RA8875 & lcd;
+    float minimum;
+    float maximum;
+    int divisions;
+    float value;
+    color_t needleColor;
+    bool cacheSet;              ///< SetCache was used
+    uint16_t cacheLayer;
+    point_t cachePoint;
+    bool faceReady;             ///< the face is in the cache
+    bool cached;                ///< the cache is usable
+    rect_t needleBox;           ///< what the last needle covered
+    loc_t needleTip[2];         ///< the last needle tip, to skip updates that do not move it
+};
+
+#endif // GAUGE_H
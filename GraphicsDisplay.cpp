@@ -89,6 +89,7 @@ GraphicsDisplay::GraphicsDisplay(const char *name)
     : TextDisplay(name)
 {
     font = NULL;
+    dither8 = false;
 }
 
 //GraphicsDisplay::~GraphicsDisplay()
@@ -149,11 +150,55 @@ RetCode_t GraphicsDisplay::_putp(color_t color)
     return noerror;
 }
 
+RetCode_t GraphicsDisplay::pixelStream8(uint8_t * p, uint32_t count, loc_t x, loc_t y)
+{
+    SetGraphicsCursor(x, y);
+    _x = x;
+    _y = y;
+    _StartGraphicsStream();
+    while (count--)
+        _putp(RGB332To565(*p++));
+    _EndGraphicsStream();
+    return noerror;
+}
+
+RetCode_t GraphicsDisplay::pixelStream(const PixelBuffer_T & buf, loc_t x, loc_t y)
+{
+    const uint8_t * p = (const uint8_t *)buf.data;
+
+    if (p == NULL && buf.count)
+        return bad_parameter;
+    SetGraphicsCursor(x, y);
+    _x = x;
+    _y = y;
+    _StartGraphicsStream();
+    for (uint32_t i = 0; i < buf.count; i++) {
+        if (buf.format == WireRGB332)
+            _putp(RGB332To565(p[i]));
+        else if (buf.format == WireRGB565)
+            _putp((color_t)((p[2 * i] << 8) | p[2 * i + 1]));
+        else
+            _putp(((const color_t *)p)[i]);
+    }
+    _EndGraphicsStream();
+    return noerror;
+}
+
 RetCode_t GraphicsDisplay::fill(loc_t x, loc_t y, dim_t w, dim_t h, color_t color)
 {
     return fillrect(x,y, x+w, y+h, color);
 }
 
+RetCode_t GraphicsDisplay::_ClearCells(void)
+{
+    color_t restore = _foreground;
+    RetCode_t ret;
+
+    ret = fillrect(0, 0, width() - 1, height() - 1, _background);
+    foreground(restore);                // fillrect leaves its color as the foreground
+    return ret;
+}
+
 RetCode_t GraphicsDisplay::cls(uint16_t layers)
 {
     int restore = GetDrawingLayer();
@@ -247,16 +292,59 @@ int GraphicsDisplay::fontblit(loc_t x, loc_t y, const unsigned char c)
 //      BBBB BBBB GGGG GGGG RRRR RRRR 0000 0000
 // RGB16 is
 //      RRRR RGGG GGGB BBBB
-// swap to little endian
-//      GGGB BBBB RRRR RGGG
 color_t GraphicsDisplay::RGBQuadToRGB16(RGBQUAD * colorPalette, uint16_t i)
 {
-    color_t c;
- 
-    c  = ((colorPalette[i].rgbBlue  >> 3) <<  0);
-    c |= ((colorPalette[i].rgbGreen >> 2) <<  5);
-    c |= ((colorPalette[i].rgbRed   >> 3) << 11);
-    return c;
+    return RGB888To565(colorPalette[i].rgbRed, colorPalette[i].rgbGreen, colorPalette[i].rgbBlue);
+}
+
+RetCode_t GraphicsDisplay::SetColorDither(bool enable)
+{
+    dither8 = enable;
+    return noerror;
+}
+
+// 4x4 ordered dither (Bayer) matrix, indexed by [y & 3][x & 3]
+static const uint8_t Bayer4x4[16] = {
+     0,  8,  2, 10,
+    12,  4, 14,  6,
+     3, 11,  1,  9,
+    15,  7, 13,  5
+};
+
+// 24-bit color
+//      RRRR RRRR GGGG GGGG BBBB BBBB
+// RGB332
+//      RRRG GGBB
+uint8_t GraphicsDisplay::_RGB888To332(uint8_t r, uint8_t g, uint8_t b, loc_t x, loc_t y)
+{
+    if (dither8) {
+        // threshold 8..248 is added before the divide by 256, so a 4x4
+        // cell averages to the full scale level. This is not the same
+        // as the non-dithered path, which keeps the high bits, so a flat
+        // color can come out one step apart between the two.
+        uint16_t t = (Bayer4x4[((y & 3) << 2) | (x & 3)] << 4) + 8;
+        uint16_t r3 = (r * 7 + t) >> 8;
+        uint16_t g3 = (g * 7 + t) >> 8;
+        uint16_t b2 = (b * 3 + t) >> 8;
+        return (uint8_t)((r3 << 5) | (g3 << 2) | b2);
+    } else {
+        return (r & 0xE0) | ((g >> 3) & 0x1C) | (b >> 6);
+    }
+}
+
+// Extract the palette index of pixel i from a line of 1, 4 or 8-bit bitmap data.
+static uint8_t BitmapIndex(const uint8_t * lineBuffer, uint16_t bpp, unsigned int i)
+{
+    if (bpp == 1) {
+        return (lineBuffer[i/8] & (0x80 >> (i % 8))) ? 0 : 1;
+    } else if (bpp == 4) {
+        uint8_t dPix = lineBuffer[i/2];
+        if ((i & 1) == 0)
+            dPix >>= 4;
+        return dPix & 0x0F;
+    } else {
+        return lineBuffer[i];
+    }
 }
 
 // RGB16 little endian 
@@ -270,11 +358,8 @@ RGBQUAD GraphicsDisplay::RGB16ToRGBQuad(color_t c)
 {
     RGBQUAD q;
     
-    memset(&q, 0, sizeof(q));
-    c = (c << 8) | (c >> 8);    // swap
-    q.rgbBlue  = ((c & 0x001F) << 3) | (c & 0x07);          /* Blue value */
-    q.rgbGreen = ((c & 0x07E0) >> 3) | ((c >> 9) & 0x03);   /* Green value */
-    q.rgbRed   = ((c & 0xF800) >> 8) | ((c >> 13) & 0x07);  /* Red value */
+    c = SwapColorBytes(c);
+    RGB565ToBGR888((uint8_t *)&q, &c, 1);       // an RGBQUAD starts as BGR
     q.rgbReserved = 0;
     return q;
 }
@@ -283,12 +368,13 @@ RetCode_t GraphicsDisplay::_RenderBitmap(loc_t x, loc_t y, uint32_t fileOffset,
 {
     BITMAPINFOHEADER BMP_Info;
     RGBQUAD * colorPalette = NULL;
+    uint8_t * palette8 = NULL;
     int colorCount;
     uint8_t * lineBuffer = NULL;
     color_t * pixelBuffer = NULL;
     uint16_t BPP_t;
     dim_t PixelWidth, PixelHeight;
-    unsigned int    i, offset;
+    unsigned int    i;
     int padd,j;
     #ifdef DEBUG
     //uint32_t start_data;
@@ -330,7 +416,7 @@ RetCode_t GraphicsDisplay::_RenderBitmap(loc_t x, loc_t y, uint32_t fileOffset,
 
     int lineBufSize = ((BPP_t * PixelWidth + 7)/8);
     INFO("BPP_t %d, PixelWidth %d, lineBufSize %d", BPP_t, PixelWidth, lineBufSize);
-    lineBuffer = (uint8_t *)swMalloc(lineBufSize);
+    lineBuffer = (uint8_t *)swMalloc(lineBufSize + 3);     // with room for the padding
     if (lineBuffer == NULL) {
         swFree(colorPalette);
         fclose(Image);
@@ -345,6 +431,18 @@ RetCode_t GraphicsDisplay::_RenderBitmap(loc_t x, loc_t y, uint32_t fileOffset,
         return(not_enough_ram);
     }
 
+    // In 8-bit color, pixels are produced in RGB332 and streamed one byte
+    // per pixel. An undithered palette is reduced once, up front, so each
+    // pixel is then only a table lookup.
+    bool native8 = (color_bpp() == 8) && (BPP_t != 16);
+    if (native8 && colorPalette && !dither8) {
+        palette8 = (uint8_t *)swMalloc(colorCount);
+        if (palette8) {
+            for (i = 0; i < (unsigned int)colorCount; i++)
+                palette8[i] = _RGB888To332(colorPalette[i].rgbRed, colorPalette[i].rgbGreen, colorPalette[i].rgbBlue, 0, 0);
+        }
+    }
+
     padd = (lineBufSize % 4);
     if (padd)
         padd = 4 - padd;
@@ -358,12 +456,43 @@ RetCode_t GraphicsDisplay::_RenderBitmap(loc_t x, loc_t y, uint32_t fileOffset,
     //start_data = BMP_Info.bfOffBits;
     //HexDump("Raw Data", (uint8_t *)&start_data, 32);
     INFO("(%d,%d) (%d,%d), [%d,%d]", x,y, PixelWidth,PixelHeight, lineBufSize, padd);
-    for (j = PixelHeight - 1; j >= 0; j--) {                //Lines bottom up
-        offset = fileOffset + j * (lineBufSize + padd);     // start of line
-        fseek(Image, offset, SEEK_SET);
-        fread(lineBuffer, 1, lineBufSize, Image);           // read a line - slow !
-        //INFO("offset: %6X", offset);
+    // The lines are stored bottom up, so they are read in that order, with
+    // no seek, and each is streamed to its own row.
+    fseek(Image, fileOffset, SEEK_SET);
+    RetCode_t ret = noerror;
+    _YieldBegin();
+    for (j = 0; j < PixelHeight; j++) {                     //Lines bottom up
+        loc_t row = y + PixelHeight - 1 - j;
+
+        if (j && _Yield() == external_abort) {
+            ret = external_abort;
+            break;
+        }
+
+        fread(lineBuffer, 1, lineBufSize + padd, Image);    // read a line, and its padding
         //HexDump("Line", lineBuffer, lineBufSize);
+        if (native8) {
+            uint8_t * pixelBuffer8 = (uint8_t *)pixelBuffer;
+            for (i = 0; i < PixelWidth; i++) {
+                if (BPP_t == 24) {
+                    pixelBuffer8[i] = _RGB888To332(lineBuffer[i*3+2], lineBuffer[i*3+1], lineBuffer[i*3+0], x + i, row);
+                } else if (palette8) {
+                    pixelBuffer8[i] = palette8[BitmapIndex(lineBuffer, BPP_t, i)];
+                } else {
+                    RGBQUAD * q = &colorPalette[BitmapIndex(lineBuffer, BPP_t, i)];
+                    pixelBuffer8[i] = _RGB888To332(q->rgbRed, q->rgbGreen, q->rgbBlue, x + i, row);
+                }
+            }
+            pixelStream8(pixelBuffer8, PixelWidth, x, row);
+            continue;
+        }
+        if (BPP_t == 24) {
+            PixelBuffer_T buf = { pixelBuffer, PixelWidth, WireRGB565 };
+
+            BGR888ToWire565((uint8_t *)pixelBuffer, lineBuffer, PixelWidth);
+            pixelStream(buf, x, row);
+            continue;
+        }
         for (i = 0; i < PixelWidth; i++) {                  // copy pixel data to TFT
             if (BPP_t == 1) {
                 uint8_t dPix = lineBuffer[i/8];
@@ -380,21 +509,21 @@ RetCode_t GraphicsDisplay::_RenderBitmap(loc_t x, loc_t y, uint32_t fileOffset,
                 pixelBuffer[i] = RGBQuadToRGB16(colorPalette, lineBuffer[i]);
             } else if (BPP_t == 16) {
                 pixelBuffer[i] = lineBuffer[i];
-            } else if (BPP_t == 24) {
-                color_t color;
-                color = RGB(lineBuffer[i*3+2], lineBuffer[i*3+1], lineBuffer[i*3+0]);
-                pixelBuffer[i] = color;
             }
         }
-        pixelStream(pixelBuffer, PixelWidth, x, y++);
+        pixelStream(pixelBuffer, PixelWidth, x, row);
     }
 //    _EndGraphicsStream();
     window(restore);
     swFree(pixelBuffer);      // don't leak memory
     swFree(lineBuffer);
+    if (palette8)
+        swFree(palette8);
     if (colorPalette)
         swFree(colorPalette);
-    return (noerror);
+    if (ret != noerror)
+        fclose(Image);        // as on every other failure, the caller does not close it
+    return (ret);
 }
 
 
@@ -434,7 +563,8 @@ RetCode_t GraphicsDisplay::RenderJpegFile(loc_t x, loc_t y, const char *Name_JPG
             if (r == noerror) {
                 img_x = x;  // save the origin for the privOutput function
                 img_y = y;
-                r = (RetCode_t)jd_decomp(jdec, NULL, 0);
+                _YieldBegin();
+                r = (RetCode_t)jd_decomp(jdec, NULL, 0);   // JDR_INTR is external_abort, from a yield point
             } else {
                 r = not_supported_format;   // error("jd_prepare error:%d", r);
             }
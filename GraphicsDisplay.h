@@ -14,6 +14,7 @@
 #ifndef MBED_GRAPHICSDISPLAY_H
 #define MBED_GRAPHICSDISPLAY_H
 #include "Bitmap.h"
+#include "ColorConvert.h"
 #include "TextDisplay.h"
 #include "GraphicsDisplayJPEG.h"
 
@@ -78,6 +79,46 @@ public:
     ///
     virtual RetCode_t getPixelStream(color_t * p, uint32_t count, loc_t x, loc_t y) = 0;
     
+    /// Write a stream of RGB332 pixels to the display.
+    ///
+    /// This is the 8-bit counterpart to @ref pixelStream. Each byte in
+    /// the stream is one pixel in RRRG GGBB format. A derived class 
+    /// that runs in 8 bits per pixel can send this directly to the
+    /// display; this default implementation expands each pixel to 
+    /// RGB565 and writes it with _putp, one pixel at a time.
+    ///
+    /// @param[in] p is a pointer to a uint8_t array to write.
+    /// @param[in] count is the number of pixels to write.
+    /// @param[in] x is the horizontal position on the display.
+    /// @param[in] y is the vertical position on the display.
+    /// @returns success/failure code. @see RetCode_t.
+    ///
+    virtual RetCode_t pixelStream8(uint8_t * p, uint32_t count, loc_t x, loc_t y);
+
+    /// Write a buffer of pixels to the display, in whatever format it has.
+    ///
+    /// The buffer carries its format, see @ref PixelFormat_T, so a derived
+    /// class can send a buffer that is already in the order of the wire
+    /// as it is. This default implementation converts each pixel to
+    /// color_t, and sends it with _putp.
+    ///
+    /// @param[in] buf is the pixels, their count and their format.
+    /// @param[in] x is the horizontal position on the display.
+    /// @param[in] y is the vertical position on the display.
+    /// @returns success/failure code. @see RetCode_t.
+    ///
+    virtual RetCode_t pixelStream(const PixelBuffer_T & buf, loc_t x, loc_t y);
+
+    /// get the color depth in bits per pixel.
+    ///
+    /// A derived class that supports a reduced color depth should
+    /// override this, so the image decoders can produce pixels in
+    /// the native format.
+    ///
+    /// @returns the number of bits per pixel; 16 unless overridden.
+    ///
+    virtual dim_t color_bpp(void) { return 16; }
+    
     /// get the screen width in pixels
     ///
     /// @note this method must be supported in the derived class.
@@ -364,6 +405,27 @@ public:
     ///
     RGBQUAD RGB16ToRGBQuad(color_t c);
 
+    /// Enable or disable ordered dithering for 8-bit color output.
+    ///
+    /// When the display is running in 8 bits per pixel, the image
+    /// decoders reduce each 24-bit source pixel to RGB332. With
+    /// dithering enabled, a 4x4 ordered (Bayer) dither is applied 
+    /// during that reduction, which hides most of the banding in 
+    /// photographs and gradients at no extra bus cost.
+    ///
+    /// @note This has no effect when the display is in 16-bit mode.
+    ///
+    /// @param[in] enable when true enables the ordered dither.
+    /// @returns success/failure code. @see RetCode_t.
+    ///
+    RetCode_t SetColorDither(bool enable);
+
+    /// Get the state of the ordered dithering for 8-bit color output.
+    ///
+    /// @returns true if dithering is enabled.
+    ///
+    bool GetColorDither(void) { return dither8; }
+
     /// This method attempts to render a specified graphics image file at
     /// the specified screen location.
     ///
@@ -493,6 +555,14 @@ public:
 
 protected:
 
+    /// Clear the whole display to the background color, for the
+    /// TextDisplay::cls fallback, as one fill rather than a space
+    /// written to every character cell.
+    ///
+    /// @returns error code.
+    ///
+    virtual RetCode_t _ClearCells(void);
+
     /// Pure virtual method indicating the start of a graphics stream.
     ///
     /// This is called prior to a stream of pixel data being sent.
@@ -519,6 +589,24 @@ protected:
     ///
     virtual RetCode_t _EndGraphicsStream(void) = 0;
 
+    /// Start timing a long operation for its yield points.
+    ///
+    /// @note this method may be overridden in a derived class, which
+    ///     has a way to let the application run. The default does
+    ///     nothing.
+    ///
+    virtual void _YieldBegin(void) {}
+
+    /// A yield point in a long image rendering, once per row or MCU.
+    ///
+    /// @note this method may be overridden in a derived class, which
+    ///     has a way to let the application run. The default does
+    ///     nothing.
+    ///
+    /// @returns external_abort if the rendering should stop.
+    ///
+    virtual RetCode_t _Yield(void) { return noerror; }
+
     /// Protected method to render an image given a file handle and 
     /// coordinates.
     ///
@@ -530,6 +618,20 @@ protected:
     ///
     RetCode_t _RenderBitmap(loc_t x, loc_t y, uint32_t fileOffset, FILE * Image);
 
+    /// Protected method to reduce a 24-bit color to RGB332.
+    ///
+    /// If dithering is enabled (@ref SetColorDither), the pixel position
+    /// selects the ordered dither threshold.
+    ///
+    /// @param[in] r is the red component.
+    /// @param[in] g is the green component.
+    /// @param[in] b is the blue component.
+    /// @param[in] x is the horizontal pixel position, for dithering.
+    /// @param[in] y is the vertical pixel position, for dithering.
+    /// @returns the color in RRRG GGBB format.
+    ///
+    uint8_t _RGB888To332(uint8_t r, uint8_t g, uint8_t b, loc_t x, loc_t y);
+
 private:
 
     loc_t img_x;    /// x position of a rendered jpg
@@ -613,6 +715,8 @@ protected:
     short _y;                       ///< keeps track of current Y location
     
     rect_t windowrect;              ///< window commands are held here for speed of access 
+    
+    bool dither8;                   ///< ordered dither when reducing to 8-bit color
 };
 
 #endif
@@ -740,18 +740,22 @@ JRESULT GraphicsDisplay::mcu_output (
         }
     }
 
-    /* Convert RGB888 to RGB565 if needed */
-    if (JD_FORMAT == 1) {
+    /* Convert RGB888 to RGB332 for a display in 8-bit color, else to RGB565 if needed,
+       which is in wire order when it goes to privOutFunc */
+    if (JD_FORMAT == 1 && !outfunc && color_bpp() == 8) {
         uint8_t *s = (uint8_t *)jd->workbuf;
-        uint16_t w, *d = (uint16_t *)s;
-        uint16_t n = rx * ry;
+        uint8_t *d = s;
 
-        do {
-            w = (*s++ & 0xF8) << 8;     /* RRRRR----------- */
-            w |= (*s++ & 0xFC) << 3;    /* -----GGGGGG----- */
-            w |= *s++ >> 3;             /* -----------BBBBB */
-            *d++ = w;
-        } while (--n);
+        for (iy = 0; iy < ry; iy++) {
+            for (ix = 0; ix < rx; ix++) {
+                *d++ = _RGB888To332(s[0], s[1], s[2], img_x + rect.left + ix, img_y + rect.top + iy);
+                s += 3;
+            }
+        }
+    } else if (JD_FORMAT == 1 && !outfunc) {
+        RGB888ToWire565((uint8_t *)jd->workbuf, (uint8_t *)jd->workbuf, rx * ry);    /* in place */
+    } else if (JD_FORMAT == 1) {
+        RGB888ToRGB565((color_t *)jd->workbuf, (uint8_t *)jd->workbuf, rx * ry);    /* in place */
     }
 
     /* Output the RGB rectangular */
@@ -839,7 +843,7 @@ uint16_t GraphicsDisplay::getJpegData(JDEC * jd, uint8_t * buff, uint16_t ndata)
         return privInFunc(jd, buff, ndata);
 }
 
-// RGB565 if JD_FORMAT == 1
+// RGB565 in wire order, or RGB332 in 8-bit color, if JD_FORMAT == 1
 // RGB888 if JD_FORMAT == 0
 uint16_t GraphicsDisplay::privOutFunc(JDEC * jd, void * bitmap, JRECT * rect)
 {
@@ -859,21 +863,15 @@ uint16_t GraphicsDisplay::privOutFunc(JDEC * jd, void * bitmap, JRECT * rect)
 #if 1
     uint32_t pixelCount = (1 + (y1-y0)) * (1+x1-x0);
     #if JD_FORMAT == 0
-    uint8_t *s = (uint8_t *)bitmap;
-    uint16_t rgb565, *d = (uint16_t *)s;
-    uint32_t pCount = pixelCount;
-    
-    do {
-        rgb565 = (*s++ & 0xF8) << 8;     /* RRRRR----------- */
-        rgb565 |= (*s++ & 0xFC) << 3;    /* -----GGGGGG----- */
-        rgb565 |= *s++ >> 3;             /* -----------BBBBB */
-        *d++ = rgb565;
-    } while (--pCount);
+    RGB888ToWire565((uint8_t *)bitmap, (uint8_t *)bitmap, pixelCount);     // in place
     #endif
     //
+    // mcu_output left the pixels in the order of the wire, so they go as they are.
+    PixelBuffer_T buf = { bitmap, pixelCount, WireRGB565 };
+    if (JD_FORMAT == 1 && color_bpp() == 8)
+        buf.format = WireRGB332;
     window(x0+img_x, y0+img_y, w, y1 - y0 + 2);
-    uint16_t *src = (uint16_t *)bitmap;     // pointer to RGB565 format
-    pixelStream(src, pixelCount, x0+img_x, y0+img_y);
+    pixelStream(buf, x0+img_x, y0+img_y);
     window();
 #else
     for (int y= y0; y <= y1; y++) {
@@ -1202,6 +1200,7 @@ JRESULT GraphicsDisplay::jd_decomp (
             if (rc != JDR_OK) return rc;
             rc = mcu_output(jd, outfunc, x, y); /* Output the MCU (color space conversion, scaling and output) */
             if (rc != JDR_OK) return rc;
+            if (_Yield() == external_abort) return JDR_INTR;    /* Let the application run, or stop */
         }
     }
     return rc;
@@ -0,0 +1,372 @@
+/// This file contains the Keyboard methods.
+///
+#include "Keyboard.h"
+
+//#define DEBUG "KEYB"
+// ...
+// INFO("Stuff to show %d", var); // new-line is automatically appended
+//
+#if (defined(DEBUG) && !defined(TARGET_LPC11U24))
+#define INFO(x, ...) std::printf("[INF %s %4d] "x"\r\n", DEBUG, __LINE__, ##__VA_ARGS__);
+#define WARN(x, ...) std::printf("[WRN %s %4d] "x"\r\n", DEBUG, __LINE__, ##__VA_ARGS__);
+#define ERR(x, ...)  std::printf("[ERR %s %4d] "x"\r\n", DEBUG, __LINE__, ##__VA_ARGS__);
+#else
+#define INFO(x, ...)
+#define WARN(x, ...)
+#define ERR(x, ...)
+#endif
+
+#define KEY_GAP 2       // pixels between the keys
+
+// Each row is one cell per column. A wide key repeats its code.
+static const char layouts[Keyboard::LayoutCount][KEYBOARD_ROWS][KEYBOARD_COLS + 1] = {
+    {   // Alpha
+        "qwertyuiop",
+        "asdfghjkl\r",
+        "\x0Ezxcvbnm\b\b",
+        "\x02\x02      .,"
+    },
+    {   // Shifted
+        "QWERTYUIOP",
+        "ASDFGHJKL\r",
+        "\x0EZXCVBNM\b\b",
+        "\x02\x02      .,"
+    },
+    {   // Numeric
+        "1234567890",
+        "-/:;()$&@\r",
+        "\x03\x03.,?!'\"\b\b",
+        "\x01\x01      .,"
+    },
+    {   // Symbols
+        "[]{}#%^*+=",
+        "_\\|~<>`'\"\r",
+        "\x02\x02.,?!'\"\b\b",
+        "\x01\x01      .,"
+    }
+};
+
+
+static const char * Caption(char code, char * buf)
+{
+    switch (code) {
+        case KEY_BACKSPACE: return "<-";
+        case KEY_ENTER:     return "Enter";
+        case KEY_ALPHA:     return "ABC";
+        case KEY_NUMERIC:   return "123";
+        case KEY_SYMBOLS:   return "#+=";
+        case KEY_SHIFT:     return "Shift";
+        default:
+            buf[0] = code;
+            buf[1] = '\0';
+            return buf;
+    }
+}
+
+
+Keyboard::Keyboard(RA8875 & _lcd, loc_t x, loc_t y, dim_t w, dim_t h)
+    : Widget(x, y, w, h), lcd(_lcd)
+{
+    layout = Alpha;
+    cacheSet = false;
+    cacheLayer = 1;
+    cacheNormal = cachePressed = bounds.p1;     // see _Render
+    rendered = false;
+    cached = false;
+    pressedCell = -1;
+    key = 0;
+    repeatDelay = 500;
+    repeatRate = 100;
+    repeatNext = 0;
+    appFont = NULL;
+    appFg = appBg = 0;
+}
+
+
+void Keyboard::SetCache(uint16_t layer, point_t normal, point_t pressed)
+{
+    cacheSet = true;
+    cacheLayer = layer;
+    cacheNormal = normal;
+    cachePressed = pressed;
+    rendered = false;
+}
+
+
+void Keyboard::SetLayout(Layout_T _layout)
+{
+    if (_layout >= LayoutCount || _layout == layout)
+        return;
+    layout = _layout;
+    pressedCell = -1;
+    rendered = false;
+    Invalidate();
+    if (screen == NULL && visible) {        // nobody else will update it
+        lcd.window(bounds);
+        Draw(lcd, bounds);
+        lcd.window();
+    }
+}
+
+
+// The first cell of the key under p, or -1.
+int Keyboard::_Hit(point_t p)
+{
+    dim_t cw = (bounds.p2.x - bounds.p1.x + 1) / KEYBOARD_COLS;
+    dim_t ch = (bounds.p2.y - bounds.p1.y + 1) / KEYBOARD_ROWS;
+    int row, col;
+
+    if (p.x < bounds.p1.x || p.y < bounds.p1.y || cw == 0 || ch == 0)
+        return -1;
+    col = (p.x - bounds.p1.x) / cw;
+    row = (p.y - bounds.p1.y) / ch;
+    if (col >= KEYBOARD_COLS || row >= KEYBOARD_ROWS)
+        return -1;
+    while (col > 0 && layouts[layout][row][col - 1] == layouts[layout][row][col])
+        col--;
+    return row * KEYBOARD_COLS + col;
+}
+
+
+// The rectangle of the key at cell, which is the first cell of the key,
+// offset by dx, dy.
+rect_t Keyboard::_Key(int cell, loc_t dx, loc_t dy)
+{
+    dim_t cw = (bounds.p2.x - bounds.p1.x + 1) / KEYBOARD_COLS;
+    dim_t ch = (bounds.p2.y - bounds.p1.y + 1) / KEYBOARD_ROWS;
+    int row = cell / KEYBOARD_COLS;
+    int first = cell % KEYBOARD_COLS;
+    int last = first;
+    rect_t r;
+
+    while (last + 1 < KEYBOARD_COLS && layouts[layout][row][last + 1] == layouts[layout][row][first])
+        last++;
+    r.p1.x = bounds.p1.x + dx + first * cw + KEY_GAP / 2;
+    r.p1.y = bounds.p1.y + dy + row * ch + KEY_GAP / 2;
+    r.p2.x = bounds.p1.x + dx + (last + 1) * cw - 1 - KEY_GAP / 2;
+    r.p2.y = bounds.p1.y + dy + (row + 1) * ch - 1 - KEY_GAP / 2;
+    return r;
+}
+
+
+void Keyboard::_DrawKey(int cell, bool down, loc_t dx, loc_t dy)
+{
+    rect_t r = _Key(cell, dx, dy);
+    color_t face = (down) ? fg : bg;
+    color_t ink = (down) ? bg : fg;
+    char buf[2];
+    const char * cap = Caption(layouts[layout][cell / KEYBOARD_COLS][cell % KEYBOARD_COLS], buf);
+    dim_t tw = strlen(cap) * 8;         // the internal font
+
+    lcd.fillroundrect(r, 3, 3, face);
+    lcd.roundrect(r, 3, 3, fg);
+    if (tw + 2 <= r.p2.x - r.p1.x && 16 + 2 <= r.p2.y - r.p1.y) {
+        lcd.foreground(ink);
+        lcd.background(face);
+        lcd.puts(r.p1.x + (r.p2.x - r.p1.x + 1 - tw) / 2, r.p1.y + (r.p2.y - r.p1.y + 1 - 16) / 2, cap);
+    }
+}
+
+
+// Draw the whole keyboard, with all the keys up or all down, with its
+// top left at origin.
+void Keyboard::_DrawKeys(bool down, point_t origin)
+{
+    loc_t dx = origin.x - bounds.p1.x;
+    loc_t dy = origin.y - bounds.p1.y;
+
+    lcd.window(origin.x, origin.y, bounds.p2.x - bounds.p1.x + 1, bounds.p2.y - bounds.p1.y + 1);
+    lcd.fillrect(origin.x, origin.y, bounds.p2.x + dx, bounds.p2.y + dy,
+        (screen) ? screen->GetBackground() : Black);
+    _BeginCaptions();
+    for (int cell=0; cell<KEYBOARD_ROWS * KEYBOARD_COLS; cell++) {
+        if (cell % KEYBOARD_COLS == 0
+        || layouts[layout][cell / KEYBOARD_COLS][cell % KEYBOARD_COLS - 1]
+            != layouts[layout][cell / KEYBOARD_COLS][cell % KEYBOARD_COLS])
+            _DrawKey(cell, down, dx, dy);
+    }
+    _EndCaptions();
+}
+
+
+// The captions are in the internal font, and in colors of their own.
+// The application's font and colors are kept, to be put back after.
+void Keyboard::_BeginCaptions(void)
+{
+    appFont = lcd.GetUserFont();
+    appFg = lcd.GetForeColor();
+    appBg = lcd.GetBackColor();
+    if (appFont)
+        lcd.SelectUserFont();
+}
+
+
+void Keyboard::_EndCaptions(void)
+{
+    lcd.foreground(appFg);
+    lcd.background(appBg);
+    if (appFont)
+        lcd.SelectUserFont(appFont);
+}
+
+
+// Render both images of the layout into the cache, and report if the
+// cache is usable.
+bool Keyboard::_Render(void)
+{
+    dim_t h = bounds.p2.y - bounds.p1.y + 1;
+    uint16_t prev = lcd.GetDrawingLayer();
+
+    if (!cacheSet) {            // the other layer, at the same place and next to it
+        cacheLayer = prev ^ 1;
+        cacheNormal = bounds.p1;
+        cachePressed = bounds.p1;
+        if (bounds.p1.y >= h)
+            cachePressed.y = bounds.p1.y - h;
+        else
+            cachePressed.y = bounds.p2.y + 1;
+    }
+    lcd.SelectDrawingLayer(cacheLayer);
+    cached = (lcd.GetDrawingLayer() == cacheLayer)           // there is a second layer
+        && !lcd.IsLayerClaimed(cacheLayer)                  // that is not an overlay's
+        && cachePressed.y + h <= lcd.height();              // with room for both
+    if (cached) {
+        _DrawKeys(false, cacheNormal);
+        _DrawKeys(true, cachePressed);
+    }
+    lcd.SelectDrawingLayer(prev);
+    rendered = true;
+    return cached;
+}
+
+
+// Stop using the cache when its layer was claimed after the keys were
+// cached there, as by OverlayLayer::Begin, which fills it with its key color.
+void Keyboard::_CheckCache(void)
+{
+    if (cached && lcd.IsLayerClaimed(cacheLayer))
+        cached = false;
+}
+
+
+// Show the key at cell up or down.
+void Keyboard::_Show(int cell, bool down)
+{
+    if (!visible || !rendered)
+        return;
+    _CheckCache();
+    if (cached) {
+        rect_t r = _Key(cell);
+        point_t from = (down) ? cachePressed : cacheNormal;
+
+        from.x += r.p1.x - bounds.p1.x;
+        from.y += r.p1.y - bounds.p1.y;
+        lcd.BlockMove(lcd.GetDrawingLayer(), 0, r.p1, cacheLayer, 0, from,
+            r.p2.x - r.p1.x + 1, r.p2.y - r.p1.y + 1, 0x2, 0xC);
+    } else {
+        lcd.window(bounds);
+        _BeginCaptions();
+        _DrawKey(cell, down, 0, 0);
+        _EndCaptions();
+        lcd.window();
+    }
+}
+
+
+// Move the press to the key at cell, or to none.
+void Keyboard::_Press(int cell)
+{
+    if (cell == pressedCell)
+        return;
+    if (pressedCell >= 0)
+        _Show(pressedCell, false);
+    pressedCell = cell;
+    if (pressedCell >= 0)
+        _Show(pressedCell, true);
+}
+
+
+void Keyboard::_Report(int cell)
+{
+    char code = layouts[layout][cell / KEYBOARD_COLS][cell % KEYBOARD_COLS];
+
+    switch (code) {
+        case KEY_ALPHA:
+            SetLayout(Alpha);
+            break;
+        case KEY_NUMERIC:
+            SetLayout(Numeric);
+            break;
+        case KEY_SYMBOLS:
+            SetLayout(Symbols);
+            break;
+        case KEY_SHIFT:
+            SetLayout((layout == Alpha) ? Shifted : Alpha);
+            break;
+        default:
+            key = code;
+            Changed();
+            break;
+    }
+}
+
+
+bool Keyboard::Touch(TouchCode_t code, point_t p)
+{
+    int cell = _Hit(p);
+
+    switch (code) {
+        case touch:
+            _Press(cell);
+            if (cell >= 0) {
+                repeatTimer.reset();
+                repeatTimer.start();
+                repeatNext = repeatDelay;
+                _Report(cell);          // which may change the layout, and release the key
+            }
+            break;
+        case held:
+            if (cell != pressedCell) {  // slid to another key, which waits its own delay
+                _Press(cell);
+                repeatTimer.reset();
+                repeatNext = repeatDelay;
+            } else if (cell >= 0 && repeatRate > 0 && repeatTimer.read_ms() >= repeatNext) {
+                char c = layouts[layout][cell / KEYBOARD_COLS][cell % KEYBOARD_COLS];
+
+                if (c != KEY_ALPHA && c != KEY_NUMERIC && c != KEY_SYMBOLS && c != KEY_SHIFT) {
+                    _Report(cell);
+                    repeatNext += repeatRate;
+                }
+            }
+            break;
+        case release:
+            _Press(-1);
+            repeatTimer.stop();
+            break;
+        default:
+            break;
+    }
+    return true;
+}
+
+
+void Keyboard::Draw(RA8875 & display, rect_t clip)
+{
+    dim_t w = bounds.p2.x - bounds.p1.x + 1;
+    dim_t h = bounds.p2.y - bounds.p1.y + 1;
+
+    if (!rendered)
+        _Render();
+    _CheckCache();
+    if (cached) {
+        display.BlockMove(display.GetDrawingLayer(), 0, bounds.p1, cacheLayer, 0, cacheNormal,
+            w, h, 0x2, 0xC);
+        if (pressedCell >= 0)
+            _Show(pressedCell, true);
+    } else {
+        _DrawKeys(false, bounds.p1);
+        if (pressedCell >= 0)
+            _Show(pressedCell, true);
+    }
+    display.window(clip);
+}
@@ -0,0 +1,143 @@
+/// Keyboard - an on-screen keyboard, with key caps cached off-screen.
+///
+/// The keyboard is rendered twice into display memory that is not
+/// shown, once with every key up and once with every key down. A key
+/// press is then one BTE block move of that key from the pressed image,
+/// and its release one from the normal image, rather than a redraw.
+///
+#ifndef KEYBOARD_H
+#define KEYBOARD_H
+#include "Widgets.h"
+
+/// The grid of every layout, in cells. A wide key takes several
+/// neighboring cells of a row.
+#define KEYBOARD_ROWS 4
+#define KEYBOARD_COLS 10
+
+/// The key codes for the keys that are not characters.
+#define KEY_BACKSPACE   '\b'    ///< reported
+#define KEY_ENTER       '\r'    ///< reported
+#define KEY_ALPHA       0x01    ///< switches to the Alpha layout
+#define KEY_NUMERIC     0x02    ///< switches to the Numeric layout
+#define KEY_SYMBOLS     0x03    ///< switches to the Symbols layout
+#define KEY_SHIFT       0x0E    ///< toggles between Alpha and Shifted
+
+/// A virtual keyboard for a touch panel.
+///
+/// Keys are found from the touch point by arithmetic on the grid. A key
+/// is reported when it is pressed, and again while it is held, first
+/// after the repeat delay and then at the repeat rate, timed from the
+/// held events of the touch panel. The keys that switch the layout are
+/// not reported, and do not repeat.
+///
+/// By default the two images are cached in the other layer, one at the
+/// place of the keyboard and the other just above or below it. That
+/// layer must not be shown there. @ref SetCache can put them elsewhere.
+/// Without a cache, or when the cache layer is claimed, as by an
+/// OverlayLayer, the keys are drawn as they change. See
+/// @ref RA8875::ClaimLayer.
+///
+/// @code
+/// Keyboard kb(lcd, 0, 136, 480, 136);
+///
+/// void OnKey(Widget * w) {
+///     char c = kb.GetKey();
+///     ...
+/// }
+///
+/// kb.SetCallback(OnKey);
+/// ui.Add(&kb);
+/// @endcode
+///
+class Keyboard : public Widget
+{
+public:
+    /// The layouts of the keys.
+    typedef enum {
+        Alpha,              ///< lower case letters
+        Shifted,            ///< upper case letters
+        Numeric,            ///< digits and common punctuation
+        Symbols,            ///< the remaining punctuation
+        LayoutCount
+    } Layout_T;
+
+    /// Constructor for a keyboard.
+    ///
+    /// @param[in] lcd is the display, which the keyboard draws on as keys change.
+    /// @param[in] x is the left edge.
+    /// @param[in] y is the top edge.
+    /// @param[in] w is the width.
+    /// @param[in] h is the height.
+    ///
+    Keyboard(RA8875 & lcd, loc_t x, loc_t y, dim_t w, dim_t h);
+
+    /// Set where the two images of the keyboard are cached.
+    ///
+    /// @param[in] layer is the layer, 0 or 1.
+    /// @param[in] normal is the top left of the image with the keys up.
+    /// @param[in] pressed is the top left of the image with the keys down.
+    ///
+    void SetCache(uint16_t layer, point_t normal, point_t pressed);
+
+    /// Select the layout, which renders it into the cache.
+    ///
+    /// @param[in] layout is the layout.
+    ///
+    void SetLayout(Layout_T layout);
+
+    /// Get the layout.
+    ///
+    /// @returns the layout.
+    ///
+    Layout_T GetLayout(void) { return layout; }
+
+    /// Set the key repeat timing.
+    ///
+    /// @param[in] delay_ms is the time a key is held before it repeats.
+    /// @param[in] rate_ms is the time between repeats, or 0 for no repeat.
+    ///
+    void SetRepeat(int delay_ms, int rate_ms) { repeatDelay = delay_ms; repeatRate = rate_ms; }
+
+    /// Get the last key that was reported.
+    ///
+    /// @returns the key code.
+    ///
+    char GetKey(void) { return key; }
+
+    virtual void Draw(RA8875 & lcd, rect_t clip);
+    virtual rect_t RedrawArea(rect_t /*damage*/) { return bounds; }
+    virtual bool Touch(TouchCode_t code, point_t p);
+
+private:
+    int _Hit(point_t p);
+    rect_t _Key(int cell, loc_t dx = 0, loc_t dy = 0);
+    void _DrawKey(int cell, bool down, loc_t dx, loc_t dy);
+    void _DrawKeys(bool down, point_t origin);
+    void _BeginCaptions(void);
+    void _EndCaptions(void);
+    bool _Render(void);
+    void _CheckCache(void);
+    void _Show(int cell, bool down);
+    void _Press(int cell);
+    void _Report(int cell);
+
+    RA8875 & lcd;
+    Layout_T layout;
+    bool cacheSet;              ///< SetCache was used
+    uint16_t cacheLayer;
+    point_t cacheNormal;
+    point_t cachePressed;
+    bool rendered;              ///< the layout is in the cache
+    bool cached;                ///< the cache is usable
+    int pressedCell;            ///< the first cell of the key that is down, or -1
+    char key;
+    Timer repeatTimer;
+    int repeatDelay;
+    int repeatRate;
+    int repeatNext;             ///< msec since the press of the next repeat
+    const uint8_t * appFont;    ///< the application's font, while the captions are drawn
+    color_t appFg;              ///< the application's foreground, while the captions are drawn
+    color_t appBg;              ///< the application's background, while the captions are drawn
+};
+
+#endif // KEYBOARD_H
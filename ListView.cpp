@@ -0,0 +1,475 @@
+/// This file contains the ListView methods.
+///
+#include "ListView.h"
+
+#ifndef UTILITY_H
+#define swMalloc malloc         // use the standard
+#define swFree free
+#endif
+
+//#define DEBUG "LSTV"
+// ...
+// INFO("Stuff to show %d", var); // new-line is automatically appended
+//
+#if (defined(DEBUG) && !defined(TARGET_LPC11U24))
+#define INFO(x, ...) std::printf("[INF %s %4d] "x"\r\n", DEBUG, __LINE__, ##__VA_ARGS__);
+#define WARN(x, ...) std::printf("[WRN %s %4d] "x"\r\n", DEBUG, __LINE__, ##__VA_ARGS__);
+#define ERR(x, ...)  std::printf("[ERR %s %4d] "x"\r\n", DEBUG, __LINE__, ##__VA_ARGS__);
+#else
+#define INFO(x, ...)
+#define WARN(x, ...)
+#define ERR(x, ...)
+#endif
+
+#define TAP_SLOP        4       // pixels a tap may wander before it is a drag
+#define FLICK_MIN       0.1f    // pixels per msec to start a flick
+#define FLICK_STOP      0.02f   // pixels per msec where a flick ends
+#define FLICK_TAU       325.0f  // msec for a flick to slow to 1/e of its speed
+#define FLICK_HOLD      100     // msec without movement before release that cancels a flick
+
+
+ListView::ListView(RA8875 & _lcd, loc_t x, loc_t y, dim_t w, dim_t h, int _count,
+    ListViewText_T text, dim_t _rowHeight)
+    : Widget(x, y, w, h), lcd(_lcd)
+{
+    count = (_count > 0) ? _count : 0;
+    textOf = text;
+    heightOf = NULL;
+    rowHeight = (_rowHeight) ? _rowHeight : 1;
+    heights = NULL;
+    marks = NULL;
+    measured = 0;
+    measuredY = 0;
+    capacity = 0;
+    scroll = 0;
+    selected = -1;
+    drawn = false;
+    dragY = dragStart = 0;
+    dragMoved = false;
+    lastMove = 0;
+    velocity = 0.0f;
+    carry = 0.0f;
+    fling = false;
+}
+
+
+ListView::~ListView()
+{
+    swFree(heights);
+    swFree(marks);
+}
+
+
+RetCode_t ListView::SetHeights(ListViewHeight_T height)
+{
+    swFree(heights);
+    swFree(marks);
+    heights = NULL;
+    marks = NULL;
+    capacity = 0;
+    measured = 0;
+    measuredY = 0;
+    heightOf = height;
+    if (height && count) {
+        heights = (uint8_t *)swMalloc(count);
+        marks = (int32_t *)swMalloc((count / LISTVIEW_MARK_EVERY + 1) * sizeof(int32_t));
+        if (heights == NULL || marks == NULL) {
+            swFree(heights);
+            swFree(marks);
+            heights = NULL;
+            marks = NULL;
+            heightOf = NULL;
+            return not_enough_ram;
+        }
+        capacity = count;
+    }
+    scroll = 0;
+    Invalidate();
+    return noerror;
+}
+
+
+RetCode_t ListView::SetCount(int _count)
+{
+    int32_t limit;
+
+    _count = (_count > 0) ? _count : 0;
+    if (heightOf && _count > capacity) {
+        int grow = _count + _count / 4;     // room to append without a copy each time
+        uint8_t * h = (uint8_t *)swMalloc(grow);
+        int32_t * m = (int32_t *)swMalloc((grow / LISTVIEW_MARK_EVERY + 1) * sizeof(int32_t));
+
+        if (h == NULL || m == NULL) {
+            swFree(h);
+            swFree(m);
+            return not_enough_ram;
+        }
+        if (heights) {
+            memcpy(h, heights, measured);
+            memcpy(m, marks, ((measured + LISTVIEW_MARK_EVERY - 1) / LISTVIEW_MARK_EVERY) * sizeof(int32_t));
+        }
+        swFree(heights);
+        swFree(marks);
+        heights = h;
+        marks = m;
+        capacity = grow;
+    }
+    if (_count < measured)
+        InvalidateHeights(_count);
+    count = _count;
+    if (selected >= count)
+        selected = -1;
+    limit = _Total() - (bounds.p2.y - bounds.p1.y + 1);
+    if (scroll > limit)
+        scroll = (limit > 0) ? limit : 0;
+    Invalidate();
+    return noerror;
+}
+
+
+void ListView::InvalidateHeights(int from)
+{
+    if (heights == NULL || from >= measured)
+        return;
+    if (from < 0)
+        from = 0;
+    measuredY = _ItemY(from);
+    measured = from;
+    Invalidate();
+}
+
+
+// Ask for, and cache, the heights of the items up to upto.
+void ListView::_Measure(int upto)
+{
+    if (upto >= count)
+        upto = count - 1;
+    while (measured <= upto) {
+        dim_t h = (*heightOf)(measured);
+
+        if (h < 1)
+            h = 1;
+        else if (h > 255)
+            h = 255;
+        if (measured % LISTVIEW_MARK_EVERY == 0)
+            marks[measured / LISTVIEW_MARK_EVERY] = measuredY;
+        heights[measured++] = (uint8_t)h;
+        measuredY += h;
+    }
+}
+
+
+// The y of the top of an item in the list, or of the end, for count.
+int32_t ListView::_ItemY(int index)
+{
+    int32_t y;
+    int m;
+
+    if (heights == NULL)
+        return (int32_t)index * rowHeight;
+    if (index <= 0)
+        return 0;
+    if (index >= count) {
+        _Measure(count - 1);
+        return measuredY;
+    }
+    _Measure(index);
+    m = index / LISTVIEW_MARK_EVERY;
+    y = marks[m];
+    for (int i=m * LISTVIEW_MARK_EVERY; i<index; i++)
+        y += heights[i];
+    return y;
+}
+
+
+// The item at y in the list, or count when it is past the end.
+int ListView::_ItemAt(int32_t y)
+{
+    int lo, hi, i;
+    int32_t iy;
+
+    if (y < 0)
+        y = 0;
+    if (heights == NULL) {
+        i = y / rowHeight;
+        return (i < count) ? i : count;
+    }
+    while (measured < count && measuredY <= y)
+        _Measure(measured + LISTVIEW_MARK_EVERY - 1);
+    if (measuredY <= y)
+        return count;
+    lo = 0;                                 // the last mark at or above y
+    hi = (measured - 1) / LISTVIEW_MARK_EVERY;
+    while (lo < hi) {
+        int mid = (lo + hi + 1) / 2;
+
+        if (marks[mid] <= y)
+            lo = mid;
+        else
+            hi = mid - 1;
+    }
+    i = lo * LISTVIEW_MARK_EVERY;
+    iy = marks[lo];
+    while (iy + heights[i] <= y)
+        iy += heights[i++];
+    return i;
+}
+
+
+int32_t ListView::_Total(void)
+{
+    return _ItemY(count);
+}
+
+
+void ListView::_Repaint(rect_t r)
+{
+    if (!visible || !drawn)
+        return;
+    lcd.window(r);
+    Draw(lcd, r);
+    lcd.window();
+}
+
+
+void ListView::ScrollTo(int32_t y)
+{
+    ScrollBy(y - scroll);
+}
+
+
+void ListView::ScrollBy(int32_t dy)
+{
+    int32_t viewH = bounds.p2.y - bounds.p1.y + 1;
+    int32_t limit = _Total() - viewH;
+    int32_t target = scroll + dy;
+    dim_t w = bounds.p2.x - bounds.p1.x + 1;
+    dim_t keep;
+    rect_t band = bounds;
+
+    if (target > limit)
+        target = limit;
+    if (target < 0)
+        target = 0;
+    dy = target - scroll;
+    if (dy == 0)
+        return;
+    scroll = target;
+    if (!visible || !drawn)
+        return;
+    if (dy >= viewH || -dy >= viewH) {
+        _Repaint(bounds);
+        return;
+    }
+    uint16_t layer = lcd.GetDrawingLayer();
+
+    if (dy > 0) {               // the rows move up
+        point_t src = { bounds.p1.x, (loc_t)(bounds.p1.y + dy) };
+
+        keep = viewH - dy;
+        lcd.BlockMove(layer, 0, bounds.p1, layer, 0, src, w, keep, 0x2, 0xC);
+        band.p1.y = bounds.p1.y + keep;
+    } else {                    // the rows move down, so copy backward from the bottom right
+        point_t src;
+
+        keep = viewH + dy;
+        src.x = bounds.p2.x;
+        src.y = bounds.p1.y + keep - 1;
+        lcd.BlockMove(layer, 0, bounds.p2, layer, 0, src, w, keep, 0x3, 0xC);
+        band.p2.y = bounds.p1.y - dy - 1;
+    }
+    _Repaint(RedrawArea(band));
+}
+
+
+void ListView::ShowItem(int index)
+{
+    int32_t viewH = bounds.p2.y - bounds.p1.y + 1;
+    int32_t top, bottom;
+
+    if (index < 0 || index >= count)
+        return;
+    top = _ItemY(index);
+    bottom = _ItemY(index + 1);
+    if (top < scroll)
+        ScrollTo(top);
+    else if (bottom > scroll + viewH)
+        ScrollTo(bottom - viewH);
+}
+
+
+void ListView::Select(int index)
+{
+    int old = selected;
+
+    if (index < -1 || index >= count || index == selected)
+        return;
+    selected = index;
+    for (int k=0; k<2; k++) {
+        int i = (k == 0) ? old : selected;
+
+        if (i >= 0) {
+            rect_t r = bounds;
+            int32_t top = _ItemY(i) - scroll + bounds.p1.y;
+            int32_t bottom = _ItemY(i + 1) - scroll + bounds.p1.y - 1;
+
+            if (bottom < bounds.p1.y || top > bounds.p2.y)
+                continue;               // not in view
+            r.p1.y = (top > bounds.p1.y) ? top : bounds.p1.y;
+            r.p2.y = (bottom < bounds.p2.y) ? bottom : bounds.p2.y;
+            _Repaint(r);
+        }
+    }
+}
+
+
+bool ListView::Animate(void)
+{
+    int now, dt;
+    float d;
+    int px;
+    int32_t before;
+
+    if (!fling)
+        return false;
+    now = kinetic.read_ms();
+    dt = now - lastMove;
+    if (dt <= 0)
+        return true;
+    lastMove = now;
+    d = velocity * dt + carry;
+    px = (int)d;
+    carry = d - px;
+    before = scroll;
+    ScrollBy(px);
+    velocity *= (float)exp(-dt / FLICK_TAU);
+    if ((px && scroll == before) || (velocity < FLICK_STOP && velocity > -FLICK_STOP)) {
+        fling = false;              // stopped, or ran into an end
+        kinetic.stop();
+    }
+    return fling;
+}
+
+
+bool ListView::Touch(TouchCode_t code, point_t p)
+{
+    int now;
+
+    switch (code) {
+        case touch:
+            fling = false;
+            dragY = dragStart = p.y;
+            dragMoved = false;
+            velocity = 0.0f;
+            carry = 0.0f;
+            kinetic.reset();
+            kinetic.start();
+            lastMove = 0;
+            break;
+        case held:
+            now = kinetic.read_ms();
+            if (!dragMoved && (p.y - dragStart > TAP_SLOP || dragStart - p.y > TAP_SLOP))
+                dragMoved = true;
+            if (dragMoved && p.y != dragY) {
+                int dy = dragY - p.y;
+                int dt = now - lastMove;
+
+                ScrollBy(dy);
+                if (dt > 0)                 // smoothed, since touch samples are noisy
+                    velocity = 0.6f * ((float)dy / dt) + 0.4f * velocity;
+                dragY = p.y;
+                lastMove = now;
+            }
+            break;
+        case release:
+            now = kinetic.read_ms();
+            if (!dragMoved) {
+                if (p.x >= bounds.p1.x && p.x <= bounds.p2.x && p.y >= bounds.p1.y && p.y <= bounds.p2.y) {
+                    int i = _ItemAt(scroll + p.y - bounds.p1.y);
+
+                    if (i < count) {
+                        Select(i);
+                        Changed();
+                    }
+                }
+                kinetic.stop();
+            } else if (now - lastMove < FLICK_HOLD
+            && (velocity > FLICK_MIN || velocity < -FLICK_MIN)) {
+                fling = true;
+                lastMove = now;
+            } else {
+                kinetic.stop();
+            }
+            break;
+        default:
+            break;
+    }
+    return true;
+}
+
+
+rect_t ListView::RedrawArea(rect_t damage)
+{
+    int first = _ItemAt(scroll + damage.p1.y - bounds.p1.y);
+    int last = _ItemAt(scroll + damage.p2.y - bounds.p1.y);
+    int32_t top = _ItemY(first) - scroll + bounds.p1.y;
+    int32_t bottom = (last < count) ? _ItemY(last + 1) - scroll + bounds.p1.y - 1 : bounds.p2.y;
+    rect_t r = bounds;
+
+    if (top > r.p1.y)
+        r.p1.y = top;
+    if (bottom < r.p2.y)
+        r.p2.y = bottom;
+    return r;                   // whole rows, across the full width
+}
+
+
+void ListView::Draw(RA8875 & display, rect_t clip)
+{
+    int i = _ItemAt(scroll + clip.p1.y - bounds.p1.y);
+    int32_t y = _ItemY(i) - scroll + bounds.p1.y;
+
+    while (i < count && y <= clip.p2.y) {
+        int32_t h = rowHeight;
+        rect_t row = bounds;
+        rect_t part;
+
+        if (heights) {
+            _Measure(i);
+            h = heights[i];
+        }
+
+        row.p1.y = y;
+        row.p2.y = y + h - 1;
+        part = row;
+        if (part.p1.y < clip.p1.y)
+            part.p1.y = clip.p1.y;
+        if (part.p2.y > clip.p2.y)
+            part.p2.y = clip.p2.y;
+        part.p1.x = clip.p1.x;
+        part.p2.x = clip.p2.x;
+        DrawItem(display, i, row, part, i == selected);
+        y += h;
+        i++;
+    }
+    if (y <= clip.p2.y)
+        display.fillrect(clip.p1.x, (y > clip.p1.y) ? y : clip.p1.y, clip.p2.x, clip.p2.y, bg);
+    drawn = true;
+}
+
+
+void ListView::DrawItem(RA8875 & display, int index, rect_t row, rect_t clip, bool sel)
+{
+    color_t face = (sel) ? fg : bg;
+    color_t ink = (sel) ? bg : fg;
+    const char * text = (textOf) ? (*textOf)(index) : NULL;
+
+    display.fillrect(clip, face);
+    if (text) {
+        dim_t th = TextHeight(display);
+        loc_t ty = row.p1.y + (row.p2.y - row.p1.y + 1 - th) / 2;
+
+        if (ty >= clip.p1.y && ty + th - 1 <= clip.p2.y)    // text is not clipped by the window
+            DrawText(display, row.p1.x + 4, ty, row.p2.x - 4, text, ink, face);
+    }
+}
@@ -0,0 +1,188 @@
+/// ListView - a scrolling list of any length, that draws only what shows.
+///
+/// The items are not held by the list. It asks for the text, and the
+/// height, of only the items that come into view. To scroll, the rows
+/// that stay in view are moved with a BTE block move, and only the
+/// newly exposed rows are drawn. A flick of the touch panel keeps it
+/// scrolling, slowing down as it goes.
+///
+#ifndef LISTVIEW_H
+#define LISTVIEW_H
+#include "Widgets.h"
+
+/// The items between the checkpoints of the height cache.
+#define LISTVIEW_MARK_EVERY 32
+
+/// Get the text of an item.
+///
+/// @param[in] index is the item.
+/// @returns the text, which must remain until the next call.
+///
+typedef const char * (* ListViewText_T)(int index);
+
+/// Get the height of an item.
+///
+/// @param[in] index is the item.
+/// @returns the height in pixels, from 1 to 255.
+///
+typedef dim_t (* ListViewHeight_T)(int index);
+
+/// A list view for long lists, with rows of fixed or variable height.
+///
+/// When the rows have variable heights, each height is asked for once,
+/// and kept in a cache of one byte per item, with the offset of every
+/// LISTVIEW_MARK_EVERY'th item, so any item is found with a binary
+/// search and a short walk.
+///
+/// Text is not clipped by the window, so a row that is partly in view
+/// is drawn without its text until the text fits. Rows are scrolled in
+/// display memory, so no other widget may overlap the list.
+///
+/// @code
+/// const char * LogLine(int i) { return log[i]; }
+///
+/// ListView logView(lcd, 0, 0, 480, 272, 5000, LogLine);
+///
+/// ui.Add(&logView);
+/// while (1) {
+///     ... deliver the touch to ui ...
+///     logView.Animate();      // continues a flick
+///     ui.Update();
+/// }
+/// @endcode
+///
+class ListView : public Widget
+{
+public:
+    /// Constructor for a list view.
+    ///
+    /// @param[in] lcd is the display, which the list draws on as it scrolls.
+    /// @param[in] x is the left edge.
+    /// @param[in] y is the top edge.
+    /// @param[in] w is the width.
+    /// @param[in] h is the height.
+    /// @param[in] count is the number of items.
+    /// @param[in] text is the callback for the text of an item.
+    /// @param[in] rowHeight is the height of every row, until @ref SetHeights is used.
+    ///
+    ListView(RA8875 & lcd, loc_t x, loc_t y, dim_t w, dim_t h, int count,
+        ListViewText_T text, dim_t rowHeight = 20);
+
+    /// Destructor, which frees the height cache.
+    ///
+    virtual ~ListView();
+
+    /// Give the rows variable heights.
+    ///
+    /// @param[in] height is the callback for the height of an item, or
+    ///         NULL for rows of the fixed height.
+    /// @returns success/failure code. @see RetCode_t.
+    ///
+    RetCode_t SetHeights(ListViewHeight_T height);
+
+    /// Change the number of items, as when a log grows.
+    ///
+    /// The heights already cached are kept, for the items that remain.
+    ///
+    /// @param[in] count is the number of items.
+    /// @returns success/failure code. @see RetCode_t.
+    ///
+    RetCode_t SetCount(int count);
+
+    /// Forget the cached heights of some items, after they have changed.
+    ///
+    /// @param[in] from is the first item that changed. All that follow
+    ///         are measured again.
+    ///
+    void InvalidateHeights(int from = 0);
+
+    /// Scroll to a position.
+    ///
+    /// @param[in] y is the offset, in pixels, of the top of the view in the list.
+    ///
+    void ScrollTo(int32_t y);
+
+    /// Scroll by some pixels.
+    ///
+    /// @param[in] dy is the pixels to scroll, positive toward the end of the list.
+    ///
+    void ScrollBy(int32_t dy);
+
+    /// Get the scroll position.
+    ///
+    /// @returns the offset, in pixels, of the top of the view in the list.
+    ///
+    int32_t GetScroll(void) { return scroll; }
+
+    /// Scroll, if needed, so an item is in view.
+    ///
+    /// @param[in] index is the item.
+    ///
+    void ShowItem(int index);
+
+    /// Select an item.
+    ///
+    /// @param[in] index is the item, or -1 for none.
+    ///
+    void Select(int index);
+
+    /// Get the selected item.
+    ///
+    /// @returns the index, or -1 for none.
+    ///
+    int GetSelected(void) { return selected; }
+
+    /// Continue a flick, which should be called often from the main loop.
+    ///
+    /// @returns true while it is still scrolling.
+    ///
+    bool Animate(void);
+
+    virtual void Draw(RA8875 & lcd, rect_t clip);
+    virtual rect_t RedrawArea(rect_t damage);
+    virtual bool Touch(TouchCode_t code, point_t p);
+
+protected:
+    /// Draw one item. Override this for rows of more than a line of text.
+    ///
+    /// @param[in] lcd is the display, with the active window set to the clip.
+    /// @param[in] index is the item.
+    /// @param[in] row is the whole row, which may extend beyond the clip.
+    /// @param[in] clip is the part of the row to draw.
+    /// @param[in] selected is true when the item is selected.
+    ///
+    virtual void DrawItem(RA8875 & lcd, int index, rect_t row, rect_t clip, bool selected);
+
+private:
+    void _Measure(int upto);
+    int32_t _ItemY(int index);
+    int _ItemAt(int32_t y);
+    int32_t _Total(void);
+    void _Repaint(rect_t r);
+
+    RA8875 & lcd;
+    int count;
+    ListViewText_T textOf;
+    ListViewHeight_T heightOf;
+    dim_t rowHeight;
+    uint8_t * heights;          ///< per item, when they vary
+    int32_t * marks;            ///< y of every LISTVIEW_MARK_EVERY'th item
+    int measured;               ///< the items whose height is cached
+    int32_t measuredY;          ///< y of the first item not measured
+    int capacity;               ///< items the cache can hold
+    int32_t scroll;
+    int selected;
+    bool drawn;                 ///< the view shows the list, so it may be scrolled
+
+    // the touch and the flick
+    Timer kinetic;
+    loc_t dragY;
+    loc_t dragStart;
+    bool dragMoved;
+    int lastMove;               ///< msec of the last drag movement
+    float velocity;             ///< pixels per msec
+    float carry;                ///< the part of a pixel not yet scrolled
+    bool fling;
+};
+
+#endif // LISTVIEW_H
@@ -0,0 +1,182 @@
+/// This file contains the OverlayLayer methods.
+///
+#include "Overlay.h"
+
+//#define DEBUG "OVLY"
+// ...
+// INFO("Stuff to show %d", var); // new-line is automatically appended
+//
+#if (defined(DEBUG) && !defined(TARGET_LPC11U24))
+#define INFO(x, ...) std::printf("[INF %s %4d] "x"\r\n", DEBUG, __LINE__, ##__VA_ARGS__);
+#define WARN(x, ...) std::printf("[WRN %s %4d] "x"\r\n", DEBUG, __LINE__, ##__VA_ARGS__);
+#define ERR(x, ...)  std::printf("[ERR %s %4d] "x"\r\n", DEBUG, __LINE__, ##__VA_ARGS__);
+#else
+#define INFO(x, ...)
+#define WARN(x, ...)
+#define ERR(x, ...)
+#endif
+
+
+OverlayLayer::OverlayLayer(RA8875 & _lcd, color_t _key, uint16_t _layer)
+    : lcd(_lcd)
+{
+    key = _key;
+    layer = _layer & 1;
+    overlays = 0;
+    modeOn = false;
+    paintPrevLayer = 0;
+}
+
+
+RetCode_t OverlayLayer::Begin(void)
+{
+    uint16_t prev = lcd.GetDrawingLayer();
+    bool ok;
+
+    lcd.SelectDrawingLayer(layer);
+    ok = (lcd.GetDrawingLayer() == layer);      // not when there is only one layer
+    if (ok) {
+        lcd.window();
+        lcd.fillrect(0, 0, lcd.width() - 1, lcd.height() - 1, key);
+    }
+    lcd.SelectDrawingLayer(prev);
+    if (!ok)
+        return bad_parameter;
+    lcd.ClaimLayer(layer);                      // so no widget caches its images there
+    lcd.SetBackgroundTransparencyColor(key);
+    lcd.SetLayerMode((layer) ? RA8875::ShowLayer0 : RA8875::ShowLayer1);
+    modeOn = false;
+    for (int i=0; i<overlays; i++) {
+        overlay[i].shown = false;
+        overlay[i].resident = false;
+    }
+    clock.start();
+    return noerror;
+}
+
+
+int OverlayLayer::Create(loc_t x, loc_t y, dim_t w, dim_t h)
+{
+    Overlay_T * o;
+
+    if (overlays >= OVERLAY_MAX)
+        return -1;
+    o = &overlay[overlays];
+    o->r.p1.x = x;
+    o->r.p1.y = y;
+    o->r.p2.x = x + w - 1;
+    o->r.p2.y = y + h - 1;
+    o->shown = false;
+    o->resident = false;
+    o->until = 0;
+    return overlays++;
+}
+
+
+RetCode_t OverlayLayer::BeginPaint(int id)
+{
+    if (id < 0 || id >= overlays)
+        return bad_parameter;
+    paintPrevLayer = lcd.GetDrawingLayer();
+    lcd.SelectDrawingLayer(layer);
+    overlay[id].resident = true;
+    return lcd.window(overlay[id].r);
+}
+
+
+RetCode_t OverlayLayer::EndPaint(void)
+{
+    lcd.window();
+    return lcd.SelectDrawingLayer(paintPrevLayer);
+}
+
+
+// Clear an overlay back to the key color.
+void OverlayLayer::_Clear(int id)
+{
+    uint16_t prev = lcd.GetDrawingLayer();
+
+    lcd.SelectDrawingLayer(layer);
+    lcd.fillrect(overlay[id].r, key);
+    lcd.SelectDrawingLayer(prev);
+    overlay[id].resident = false;
+}
+
+
+int OverlayLayer::_ShownCount(void)
+{
+    int n = 0;
+
+    for (int i=0; i<overlays; i++) {
+        if (overlay[i].shown)
+            n++;
+    }
+    return n;
+}
+
+
+RetCode_t OverlayLayer::Show(int id)
+{
+    if (id < 0 || id >= overlays)
+        return bad_parameter;
+    overlay[id].until = 0;
+    if (overlay[id].shown)
+        return noerror;
+    if (!modeOn) {
+        // Overlays left in place when the mode went off must not show with this one.
+        for (int i=0; i<overlays; i++) {
+            if (i != id && overlay[i].resident && !overlay[i].shown)
+                _Clear(i);
+        }
+        lcd.SetLayerMode(RA8875::TransparentMode);
+        modeOn = true;
+    }
+    overlay[id].shown = true;
+    return noerror;
+}
+
+
+RetCode_t OverlayLayer::ShowFor(int id, uint32_t ms)
+{
+    RetCode_t r = Show(id);
+
+    if (r == noerror)
+        overlay[id].until = clock.read_ms() + ((ms) ? ms : 1);
+    return r;
+}
+
+
+RetCode_t OverlayLayer::Hide(int id)
+{
+    if (id < 0 || id >= overlays)
+        return bad_parameter;
+    overlay[id].until = 0;
+    if (!overlay[id].shown)
+        return noerror;
+    overlay[id].shown = false;
+    if (_ShownCount() == 0) {
+        // The last one, so the mode switch hides it, and it stays painted.
+        lcd.SetLayerMode((layer) ? RA8875::ShowLayer0 : RA8875::ShowLayer1);
+        modeOn = false;
+    } else {
+        _Clear(id);
+    }
+    return noerror;
+}
+
+
+bool OverlayLayer::IsShown(int id)
+{
+    return (id >= 0 && id < overlays && overlay[id].shown);
+}
+
+
+void OverlayLayer::Poll(void)
+{
+    uint32_t now = clock.read_ms();
+
+    for (int i=0; i<overlays; i++) {
+        if (overlay[i].shown && overlay[i].until && (int32_t)(now - overlay[i].until) >= 0)
+            Hide(i);
+    }
+}
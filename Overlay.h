@@ -0,0 +1,153 @@
+/// Overlay - popups, toasts and HUDs on the second layer.
+///
+/// The content lives on one layer, and the overlays on the other, where
+/// every pixel that is not part of an overlay holds a key color. In the
+/// transparent layer mode, the key color shows the content through. So
+/// an overlay is shown or hidden by a change of the layer mode, or by
+/// clearing just its own rectangle back to the key color, and nothing
+/// of the content beneath is redrawn.
+///
+#ifndef OVERLAY_H
+#define OVERLAY_H
+#include "RA8875.h"
+
+/// The maximum number of overlays.
+#ifndef OVERLAY_MAX
+#define OVERLAY_MAX 8
+#endif
+
+/// The default key color, which an overlay must not otherwise use.
+#define OVERLAY_KEY RGB(255,0,255)
+
+/// A layer of overlays, over a layer of content.
+///
+/// The application paints each overlay once, between @ref BeginPaint
+/// and @ref EndPaint, and then shows and hides it as often as it likes.
+/// When the last overlay is hidden, the layer mode is switched off and
+/// the overlay is left in place, so showing it again costs only the mode
+/// switch. It is cleared only when a different overlay is shown.
+///
+/// @code
+/// OverlayLayer ui(lcd);
+/// ui.Begin();
+/// int popup = ui.Create(140, 80, 200, 100);
+///
+/// ui.BeginPaint(popup);
+/// lcd.fillroundrect(140,80, 339,179, 8,8, Blue);
+/// lcd.puts(160, 120, "Saved");
+/// ui.EndPaint();
+///
+/// ui.ShowFor(popup, 2000);    // a toast
+/// while (1) {
+///     ui.Poll();              // hides it when its time is up
+///     ...
+/// }
+/// @endcode
+///
+class OverlayLayer
+{
+public:
+    /// Constructor for the overlay layer.
+    ///
+    /// @param[in] lcd is the display.
+    /// @param[in] key is the key color, which shows the content through.
+    /// @param[in] layer is the layer of the overlays, 0 or 1. The content
+    ///         is on the other layer.
+    ///
+    OverlayLayer(RA8875 & lcd, color_t key = OVERLAY_KEY, uint16_t layer = 1);
+
+    /// Prepare the layers, by filling the overlay layer with the key
+    /// color, and showing only the content.
+    ///
+    /// All of the overlay layer is needed, so it is claimed, see
+    /// @ref RA8875::ClaimLayer. This is where a Gauge or a Keyboard
+    /// caches its images by default, and they cannot share it, since
+    /// what they cache would show over the content. Those that cached
+    /// there already stop using the cache and draw directly, and those
+    /// rendered later do not cache there.
+    ///
+    /// @returns success/failure code. @see RetCode_t. It fails when the
+    ///         display has only one layer.
+    ///
+    RetCode_t Begin(void);
+
+    /// Create an overlay.
+    ///
+    /// @param[in] x is the left edge.
+    /// @param[in] y is the top edge.
+    /// @param[in] w is the width.
+    /// @param[in] h is the height.
+    /// @returns the overlay id, or -1 if there is no room.
+    ///
+    int Create(loc_t x, loc_t y, dim_t w, dim_t h);
+
+    /// Select the overlay layer, with the window on the overlay, so it
+    /// can be painted with the usual methods.
+    ///
+    /// @param[in] id is the overlay.
+    /// @returns success/failure code. @see RetCode_t.
+    ///
+    RetCode_t BeginPaint(int id);
+
+    /// Restore the drawing layer and window after painting an overlay.
+    ///
+    /// @returns success/failure code. @see RetCode_t.
+    ///
+    RetCode_t EndPaint(void);
+
+    /// Show an overlay.
+    ///
+    /// @param[in] id is the overlay.
+    /// @returns success/failure code. @see RetCode_t.
+    ///
+    RetCode_t Show(int id);
+
+    /// Show an overlay for a time, as for a toast. @ref Poll hides it.
+    ///
+    /// @param[in] id is the overlay.
+    /// @param[in] ms is the time to show it.
+    /// @returns success/failure code. @see RetCode_t.
+    ///
+    RetCode_t ShowFor(int id, uint32_t ms);
+
+    /// Hide an overlay.
+    ///
+    /// @param[in] id is the overlay.
+    /// @returns success/failure code. @see RetCode_t.
+    ///
+    RetCode_t Hide(int id);
+
+    /// Is the overlay shown.
+    ///
+    /// @param[in] id is the overlay.
+    /// @returns true when it is shown.
+    ///
+    bool IsShown(int id);
+
+    /// Hide the overlays whose time is up, which should be called often
+    /// from the main loop when @ref ShowFor is used.
+    ///
+    void Poll(void);
+
+private:
+    typedef struct {
+        rect_t r;
+        bool shown;
+        bool resident;              ///< painted, and not cleared since
+        uint32_t until;             ///< msec when a timed overlay hides, or 0
+    } Overlay_T;
+
+    void _Clear(int id);
+    int _ShownCount(void);
+
+    RA8875 & lcd;
+    color_t key;
+    uint16_t layer;
+    Overlay_T overlay[OVERLAY_MAX];
+    int overlays;
+    bool modeOn;                    ///< the transparent layer mode is on
+    uint16_t paintPrevLayer;        ///< the drawing layer before BeginPaint
+    Timer clock;
+};
+
+#endif // OVERLAY_H
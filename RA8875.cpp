@@ -63,6 +63,8 @@ static void HexDump(const char * title, const uint8_t * p, int count)
 #define PERFORMANCE_RESET performance.reset()
 #define REGISTERPERFORMANCE(a) RegisterPerformance(a)
 #define COUNTIDLETIME(a) CountIdleTime(a)
+#define COUNTBUSBYTE busBytes++
+#define COUNTBUSBYTES(n) busBytes += (n)
 static const char *metricsName[] = {
     "Cls", "Pixel", "Pixel Stream", "Boolean Stream",
     "Read Pixel", "Read Pixel Stream",
@@ -75,6 +77,14 @@ uint16_t commandsUsed[256];  // track which commands are used with simple counte
 #define PERFORMANCE_RESET
 #define REGISTERPERFORMANCE(a)
 #define COUNTIDLETIME(a)
+#define COUNTBUSBYTE
+#define COUNTBUSBYTES(n)
+#endif
+
+// mbed OS 5 and later can write a block in one call, which the target
+// may do by DMA, straight from the buffer. Earlier, it is a byte at a time.
+#if !defined(RA8875_SPI_BLOCK) && defined(MBED_MAJOR_VERSION) && (MBED_MAJOR_VERSION >= 5)
+#define RA8875_SPI_BLOCK
 #endif
 
 // When it is going to poll a register for completion, how many
@@ -105,10 +115,14 @@ static const char * ErrMessages[] = {
 RA8875::RA8875(PinName mosi, PinName miso, PinName sclk, PinName csel, PinName reset,
     const char *name)
     : GraphicsDisplay(name)
-    , spi(mosi, miso, sclk, csel)
     , cs(csel)
     , res(reset)
 {
+    spi = new SPI(mosi, miso, sclk, csel);
+    bus = NULL;
+    busId = -1;
+    mirrorMask = 0;
+    mirrorSelected = false;
     useTouchPanel = TP_NONE;
     m_irq = NULL;
     m_i2c = NULL;
@@ -116,16 +130,40 @@ RA8875::RA8875(PinName mosi, PinName miso, PinName sclk, PinName csel, PinName r
     obj_callback = NULL;
     method_callback = NULL;
     idle_callback = NULL;
+    yieldBudget = 0;
+    memset(&yieldStats, 0, sizeof(yieldStats));
+    pwmEnabled = false;
+    bootStep = 0;
+    gcPosition.x = gcPosition.y = 0;
+    spiInUse = false;
+    lastCommand = 0;
+    shadowValid = 0;
+    writeDirection = readDirection = LeftRightTopBottom;
+    fadeActive = fadePending = false;
+    fadeLevel = 0;
+    fadeSchedule = NULL;
+    claimedLayers = 0;
+    sleeping = resumeShowPending = false;
+    sleepCount = sleepShow = 0;
+    resumeTime = 0;
+    fontScaleX = fontScaleY = 256;
+    fontScaleMode = FontNearest;
+    memset(glyphCache, 0, sizeof(glyphCache));
+    glyphCacheBytes = glyphClock = glyphHits = glyphMisses = 0;
 }
 
 
 RA8875::RA8875(PinName mosi, PinName miso, PinName sclk, PinName csel, PinName reset,
     PinName sda, PinName scl, PinName irq, const char * name)
     : GraphicsDisplay(name)
-    , spi(mosi, miso, sclk, csel)
     , cs(csel)
     , res(reset)
 {
+    spi = new SPI(mosi, miso, sclk, csel);
+    bus = NULL;
+    busId = -1;
+    mirrorMask = 0;
+    mirrorSelected = false;
     useTouchPanel = TP_CAP;
     m_irq = new InterruptIn(irq);
     m_i2c = new I2C(sda, scl);
@@ -133,6 +171,26 @@ RA8875::RA8875(PinName mosi, PinName miso, PinName sclk, PinName csel, PinName r
     obj_callback = NULL;
     method_callback = NULL;
     idle_callback = NULL;
+    yieldBudget = 0;
+    memset(&yieldStats, 0, sizeof(yieldStats));
+    pwmEnabled = false;
+    bootStep = 0;
+    gcPosition.x = gcPosition.y = 0;
+    spiInUse = false;
+    lastCommand = 0;
+    shadowValid = 0;
+    writeDirection = readDirection = LeftRightTopBottom;
+    fadeActive = fadePending = false;
+    fadeLevel = 0;
+    fadeSchedule = NULL;
+    claimedLayers = 0;
+    sleeping = resumeShowPending = false;
+    sleepCount = sleepShow = 0;
+    resumeTime = 0;
+    fontScaleX = fontScaleY = 256;
+    fontScaleMode = FontNearest;
+    memset(glyphCache, 0, sizeof(glyphCache));
+    glyphCacheBytes = glyphClock = glyphHits = glyphMisses = 0;
 
     // Cap touch panel config
     m_addr = (FT5206_I2C_ADDRESS << 1);
@@ -146,94 +204,131 @@ RA8875::RA8875(PinName mosi, PinName miso, PinName sclk, PinName csel, PinName r
 }
 
 
+RA8875::RA8875(SPIBus & _bus, PinName csel, PinName reset, const char * name)
+    : GraphicsDisplay(name)
+    , cs(csel)
+    , res(reset)
+{
+    bus = &_bus;
+    spi = &bus->Port();
+    busId = bus->AddDevice(cs, RA8875_DEFAULT_SPI_FREQ, 3);
+    mirrorMask = 0;
+    mirrorSelected = false;
+    useTouchPanel = TP_NONE;
+    m_irq = NULL;
+    m_i2c = NULL;
+    c_callback = NULL;
+    obj_callback = NULL;
+    method_callback = NULL;
+    idle_callback = NULL;
+    yieldBudget = 0;
+    memset(&yieldStats, 0, sizeof(yieldStats));
+    pwmEnabled = false;
+    bootStep = 0;
+    gcPosition.x = gcPosition.y = 0;
+    spiInUse = false;
+    lastCommand = 0;
+    shadowValid = 0;
+    writeDirection = readDirection = LeftRightTopBottom;
+    fadeActive = fadePending = false;
+    fadeLevel = 0;
+    fadeSchedule = NULL;
+    claimedLayers = 0;
+    sleeping = resumeShowPending = false;
+    sleepCount = sleepShow = 0;
+    resumeTime = 0;
+    fontScaleX = fontScaleY = 256;
+    fontScaleMode = FontNearest;
+    memset(glyphCache, 0, sizeof(glyphCache));
+    glyphCacheBytes = glyphClock = glyphHits = glyphMisses = 0;
+}
+
+
 //RA8875::~RA8875()
 //{
 //}
 
+static const uint8_t ResetRegs[] = {
+    0x01, 0x01,                 // Apply Display Off, Reset
+    RA8875_REG_DELAY, 2,        // no idea if I need to wait, or how long
+    0x01, 0x00,                 // Display off, Remove reset
+    RA8875_REG_DELAY, 2         // no idea if I need to wait, or how long
+};
+
+// Panel timing from buy-display.com sample code
+static const uint8_t Regs480x272_16[] = RA8875_PANEL_REGS(480, 272, 16, 2,
+    0x0B, 0x02, 0x82, 0x02, 0x03, 0x01, 0x03, 0x000F, 0x060E, 0x01);
+static const uint8_t Regs480x272_8[]  = RA8875_PANEL_REGS(480, 272, 8, 2,
+    0x0B, 0x02, 0x82, 0x02, 0x03, 0x01, 0x03, 0x000F, 0x060E, 0x01);
+static const uint8_t Regs800x480_16[] = RA8875_PANEL_REGS(800, 480, 16, 1,
+    0x0C, 0x02, 0x81, 0x00, 0x03, 0x03, 0x0B, 0x0020, 0x0016, 0x01);
+static const uint8_t Regs800x480_8[]  = RA8875_PANEL_REGS(800, 480, 8, 2,
+    0x0C, 0x02, 0x81, 0x00, 0x03, 0x03, 0x0B, 0x0020, 0x0016, 0x01);
+
+const RA8875::PanelProfile_T RA8875::Panel480x272_16 = RA8875_PANEL_PROFILE(480, 272, 16, 2, Regs480x272_16);
+const RA8875::PanelProfile_T RA8875::Panel480x272_8  = RA8875_PANEL_PROFILE(480, 272, 8, 2, Regs480x272_8);
+const RA8875::PanelProfile_T RA8875::Panel800x480_16 = RA8875_PANEL_PROFILE(800, 480, 16, 1, Regs800x480_16);
+const RA8875::PanelProfile_T RA8875::Panel800x480_8  = RA8875_PANEL_PROFILE(800, 480, 8, 2, Regs800x480_8);
+
+
 RetCode_t RA8875::init(int width, int height, int color_bpp, uint8_t poweron, bool keypadon, bool touchscreenon)
 {
-    font = NULL;                                // no external font, use internal.
-    pKeyMap = DefaultKeyMap;                    // set default key map
-    _select(false);                             // deselect the display
-    frequency(RA8875_DEFAULT_SPI_FREQ);         // data rate
-    Reset();
-    // Set PLL based on display size from buy-display.com sample code
-    if (width == 800) {
-        WriteCommand(0x88, 0x0C);               // PLLC1 - Phase Lock Loop registers
-    } else {
-        WriteCommand(0x88, 0x0B);               // PLLC1 - Phase Lock Loop registers
-    }
-    wait_ms(1);
-    WriteCommand(0x89, 0x02);
-    wait_ms(1);
-
-    // System Config Register (SYSR)
-    screenbpp = color_bpp;
-    if (color_bpp == 16) {
-        WriteCommand(0x10, 0x0C);               // 16-bpp (65K colors) color depth, 8-bit interface
-    } else { // color_bpp == 8
-        WriteCommand(0x10, 0x00);               // 8-bpp (256 colors)
-    }
+    // 1-layer mode when the resolution is too high for 2 layers at this color depth
+    uint8_t layers = (width >= 800 && height >= 480 && color_bpp > 8) ? 1 : 2;
 
-    // Set Pixel Clock Setting Register (PCSR) based on display size from buy-display.com sample code
+    // Set timing based on display size from buy-display.com sample code
     if (width == 800) {
-        WriteCommand(0x04, 0x81);               // PDAT on PCLK falling edge, PCLK = 4 x System Clock
-        wait_ms(1);
-
-        // Horizontal Settings
-        screenwidth = width;
-        WriteCommand(0x14, width/8 - 1);            //HDWR//Horizontal Display Width Setting Bit[6:0]
-        WriteCommand(0x15, 0x00);                   //HNDFCR//Horizontal Non-Display Period fine tune Bit[3:0]
-        WriteCommand(0x16, 0x03);                   //HNDR//Horizontal Non-Display Period Bit[4:0]
-        WriteCommand(0x17, 0x03);                   //HSTR//HSYNC Start Position[4:0]
-        WriteCommand(0x18, 0x0B);                   //HPWR//HSYNC Polarity ,The period width of HSYNC.
-
-        // Vertical Settings
-        screenheight = height;
-        WriteCommand(0x19, (height-1)&0xFF);        //VDHR0 //Vertical Display Height Bit [7:0]
-        WriteCommand(0x1a, (height-1)>>8);          //VDHR1 //Vertical Display Height Bit [8]
-        WriteCommand(0x1b, 0x20);                   //VNDR0 //Vertical Non-Display Period Bit [7:0]
-        WriteCommand(0x1c, 0x00);                   //VNDR1 //Vertical Non-Display Period Bit [8]
-        WriteCommand(0x1d, 0x16);                   //VSTR0 //VSYNC Start Position[7:0]
-        WriteCommand(0x1e, 0x00);                   //VSTR1 //VSYNC Start Position[8]
-        WriteCommand(0x1f, 0x01);                   //VPWR  //VSYNC Polarity ,VSYNC Pulse Width[6:0]
+        const uint8_t regs[] = RA8875_PANEL_REGS(width, height, color_bpp, layers,
+            0x0C, 0x02, 0x81, 0x00, 0x03, 0x03, 0x0B, 0x0020, 0x0016, 0x01);
+        PanelProfile_T profile = RA8875_PANEL_PROFILE(width, height, color_bpp, layers, regs);
+        return init(profile, poweron, keypadon, touchscreenon);
     } else {
-        WriteCommand(0x04, 0x82);               // PDAT on PCLK falling edge, PCLK = 4 x System Clock
-        wait_ms(1);
-
-        // Horizontal Settings
-        screenwidth = width;
-        WriteCommand(0x14, width/8 - 1);            //HDWR//Horizontal Display Width Setting Bit[6:0]
-        WriteCommand(0x15, 0x02);                   //HNDFCR//Horizontal Non-Display Period fine tune Bit[3:0]
-        WriteCommand(0x16, 0x03);                   //HNDR//Horizontal Non-Display Period Bit[4:0]
-        WriteCommand(0x17, 0x01);                   //HSTR//HSYNC Start Position[4:0]
-        WriteCommand(0x18, 0x03);                   //HPWR//HSYNC Polarity ,The period width of HSYNC.
-
-        // Vertical Settings
-        screenheight = height;
-        WriteCommand(0x19, (height-1)&0xFF);        //VDHR0 //Vertical Display Height Bit [7:0]
-        WriteCommand(0x1a, (height-1)>>8);          //VDHR1 //Vertical Display Height Bit [8]
-        WriteCommand(0x1b, 0x0F);                   //VNDR0 //Vertical Non-Display Period Bit [7:0]
-        WriteCommand(0x1c, 0x00);                   //VNDR1 //Vertical Non-Display Period Bit [8]
-        WriteCommand(0x1d, 0x0e);                   //VSTR0 //VSYNC Start Position[7:0]
-        WriteCommand(0x1e, 0x06);                   //VSTR1 //VSYNC Start Position[8]
-        WriteCommand(0x1f, 0x01);                   //VPWR  //VSYNC Polarity ,VSYNC Pulse Width[6:0]
+        const uint8_t regs[] = RA8875_PANEL_REGS(width, height, color_bpp, layers,
+            0x0B, 0x02, 0x82, 0x02, 0x03, 0x01, 0x03, 0x000F, 0x060E, 0x01);
+        PanelProfile_T profile = RA8875_PANEL_PROFILE(width, height, color_bpp, layers, regs);
+        return init(profile, poweron, keypadon, touchscreenon);
     }
+}
 
-    portraitmode = false;
 
-    if (width >= 800 && height >= 480 && color_bpp > 8) {
-        WriteCommand(0x20, 0x00);               // DPCR - 1-layer mode when the resolution is too high
-    } else {
-        WriteCommand(0x20, 0x80);               // DPCR - 2-layer mode
-    }
+RetCode_t RA8875::init(const PanelProfile_T & profile, uint8_t poweron, bool keypadon, bool touchscreenon,
+    const rect_t * firstFrame)
+{
+    if (bus && busId < 0)                       // the bus was full, so this is not on it
+        return not_enough_ram;
+    font = NULL;                                // no external font, use internal.
+    pKeyMap = DefaultKeyMap;                    // set default key map
+    _select(false);                             // deselect the display
+    frequency(RA8875_DEFAULT_SPI_FREQ);         // data rate
+    Reset();
+    screenbpp = profile.color_bpp;
+    screenwidth = profile.width;
+    screenheight = profile.height;
+    portraitmode = false;
+    writeDirection = readDirection = LeftRightTopBottom;
+    gcPosition.x = gcPosition.y = 0;            // graphic cursor registers are reset
+    sleeping = resumeShowPending = false;
+    _WriteRegisterTable(profile.regs, profile.regCount);
 
     // Set display image to Blue on Black as default
-    window(0,0, width, height);             // Initialize to full screen
+    window(0,0, screenwidth, screenheight);     // Initialize to full screen
     SetTextCursorControl();
     foreground(Blue);
     background(Black);
-    cls(3);
+    if (firstFrame == NULL) {
+        cls(3);
+    } else {
+        // Fast boot - clear only around the first frame of layer 0,
+        // since the application is about to paint the rest.
+        if (profile.layers == 2) {
+            SelectDrawingLayer(1);
+            clsw(FULLWINDOW);
+            SelectDrawingLayer(0);
+        }
+        _ClearAround(*firstFrame);
+        SetTextCursor(0,0);
+        locate(0,0);
+    }
 
     Power(poweron);
     Backlight_u8(poweron);
@@ -252,6 +347,57 @@ RetCode_t RA8875::init(int width, int height, int color_bpp, uint8_t poweron, bo
 }
 
 
+RetCode_t RA8875::_ClearAround(rect_t r)
+{
+    loc_t right = (loc_t)(width() - 1);
+    loc_t bottom = (loc_t)(height() - 1);
+    rect_t band[4] = {
+        { { 0, 0 },                             { right, (loc_t)(r.p1.y - 1) } },   // above
+        { { 0, (loc_t)(r.p2.y + 1) },           { right, bottom } },                // below
+        { { 0, r.p1.y },                        { (loc_t)(r.p1.x - 1), r.p2.y } },  // left
+        { { (loc_t)(r.p2.x + 1), r.p1.y },      { right, r.p2.y } }                 // right
+    };
+
+    return clsRects(band, 4);
+}
+
+
+RetCode_t RA8875::_WriteRegisterTable(const uint8_t * regs, uint16_t count)
+{
+    while (count) {
+        if (regs[0] == RA8875_REG_DELAY) {
+            if (bootStep) {
+                // Use the settling time to work on the boot splash asset
+                Timer settle;
+
+                settle.start();
+                _BootPreload();
+                while (settle.read_us() < regs[1] * 1000)
+                    ;
+            } else {
+                wait_ms(regs[1]);
+            }
+            regs += 2;
+            count--;
+            continue;
+        }
+        _select(true);
+        while (count && regs[0] != RA8875_REG_DELAY) {
+            lastCommand = regs[0];
+            _Shadow(regs[0], regs[1]);
+            _spiwrite(0x80);            // Cmd: write command
+            _spiwrite(regs[0]);
+            _spiwrite(0x00);            // Cmd: write data
+            _spiwrite(regs[1]);
+            regs += 2;
+            count--;
+        }
+        _select(false);
+    }
+    return noerror;
+}
+
+
 RetCode_t RA8875::Reset(void)
 {
     RetCode_t ret;
@@ -263,12 +409,9 @@ RetCode_t RA8875::Reset(void)
         res = 1;                            // de-assert reset
     }
     #endif
-    ret = WriteCommand(0x01, 0x01);         // Apply Display Off, Reset
-    wait_ms(2);                             // no idea if I need to wait, or how long
-    if (ret == noerror) {
-        ret = WriteCommand(0x01, 0x00);     // Display off, Remove reset
-        wait_ms(2);                         // no idea if I need to wait, or how long
-    }
+    // The delays are in the table, so they can overlap with a boot splash preload.
+    ret = _WriteRegisterTable(ResetRegs, sizeof(ResetRegs)/2);
+    shadowValid = 0;                        // the registers are back to their defaults
     return ret;
 }
 
@@ -304,6 +447,24 @@ RetCode_t RA8875::SelectDrawingLayer(uint16_t layer, uint16_t * prevLayer)
 }
 
 
+RetCode_t RA8875::ClaimLayer(uint16_t layer, bool claim)
+{
+    if (layer > 1)
+        return bad_parameter;
+    if (claim)
+        claimedLayers |= 1 << layer;
+    else
+        claimedLayers &= ~(1 << layer);
+    return noerror;
+}
+
+
+bool RA8875::IsLayerClaimed(uint16_t layer)
+{
+    return (layer <= 1) && (claimedLayers & (1 << layer));
+}
+
+
 RA8875::LayerMode_T RA8875::GetLayerMode(void)
 {
     return (LayerMode_T)(ReadCommand(0x52) & 0x7);
@@ -476,6 +637,7 @@ void RA8875::ClearPerformance()
     for (i=0; i<METRICCOUNT; i++)
         metrics[i] = 0;
     idletime_usec = 0;
+    busBytes = 0;
     for (i=0; i<256; i++)
         commandsUsed[i] = 0;
 }
@@ -505,6 +667,7 @@ void RA8875::ReportPerformance(Serial & pc)
         pc.printf("%10d uS %s\r\n", metrics[i], metricsName[i]);
     }
     pc.printf("%10d uS Idle time polling display for ready.\r\n", idletime_usec);
+    pc.printf("%10u bytes on the bus.\r\n", busBytes);
     for (i=0; i<256; i++) {
         if (commandsUsed[i])
             pc.printf("Command %02X used %5d times.\r\n", i, commandsUsed[i]);
@@ -582,11 +745,13 @@ RetCode_t RA8875::WriteCommand(unsigned char command, unsigned int data)
         commandsUsed[command]++;
 #endif
     _select(true);
+    lastCommand = command;
     _spiwrite(0x80);            // RS:1 (Cmd/Status), RW:0 (Write)
     _spiwrite(command);
     if (data <= 0xFF) {   // only if in the valid range
         _spiwrite(0x00);
         _spiwrite(data);
+        _Shadow(command, data);
     }
     _select(false);
     return noerror;
@@ -706,35 +871,14 @@ bool RA8875::_WaitWhileReg(uint8_t reg, uint8_t mask)
         return false;
 }
 
-// RRRR RGGG GGGB BBBB
-// 4321 0543 2104 3210
-//           RRRG GGBB
-//           2102 1010
 uint8_t RA8875::_cvt16to8(color_t c16)
 {
-    return ((c16 >> 8) & 0xE0)
-        | ((c16 >> 6) & 0x1C)
-        | ((c16 >> 3) & 0x03);
+    return RGB565To332(c16);
 }
 
-//           RRRG GGBB
-//           2102 1010
-// RRRR RGGG GGGB BBBB
-// 2101 0543 2104 3210
 color_t RA8875::_cvt8to16(uint8_t c8)
 {
-    color_t c16;
-    color_t temp = (color_t)c8;
-
-    c16 = ((temp & 0xE0) << 8)
-        | ((temp & 0xC0) << 5)
-        | ((temp & 0x1C) << 6)
-        | ((temp & 0x1C) << 3)
-        | ((temp & 0x03) << 3)
-        | ((temp & 0x03) << 1)
-        | ((temp & 0x03) >> 1);
-    c16 = (c16 << 8) | (c16 >> 8);
-    return c16;
+    return SwapColorBytes(RGB332To565(c8));     // in the order getPixel returns
 }
 
 RetCode_t RA8875::_writeColorTrio(uint8_t regAddr, color_t color)
@@ -790,7 +934,7 @@ dim_t RA8875::fontwidth(void)
     if (font == NULL)
         return (((ReadCommand(0x22) >> 2) & 0x3) + 1) * 8;
     else
-        return extFontWidth;
+        return (extFontWidth * fontScaleX + 128) >> 8;
 }
 
 
@@ -799,7 +943,7 @@ dim_t RA8875::fontheight(void)
     if (font == NULL)
         return (((ReadCommand(0x22) >> 0) & 0x3) + 1) * 16;
     else
-        return extFontHeight;
+        return (extFontHeight * fontScaleY + 128) >> 8;
 }
 
 
@@ -811,13 +955,13 @@ RetCode_t RA8875::locate(textloc_t column, textloc_t row)
 
 int RA8875::columns(void)
 {
-    return screenwidth / fontwidth();
+    return width() / fontwidth();
 }
 
 
 int RA8875::rows(void)
 {
-    return screenheight / fontheight();
+    return height() / fontheight();
 }
 
 
@@ -854,8 +998,7 @@ RetCode_t RA8875::SetTextCursor(loc_t x, loc_t y)
     INFO("SetTextCursor(%d, %d)", x, y);
     cursor_x = x;     // set these values for non-internal fonts
     cursor_y = y;
-    WriteCommandW(0x2A, x);
-    WriteCommandW(0x2C, y);
+    _WriteCommandXY(0x2A, x, y);
     return noerror;
 }
 
@@ -873,7 +1016,7 @@ loc_t RA8875::GetTextCursor_Y(void)
     loc_t y;
 
     if (font == NULL)
-        y = ReadCommand(0x2C) | (ReadCommand(0x2D) << 8);
+        y = ReadCommandW((portraitmode) ? 0x2A : 0x2C);
     else
         y = cursor_y;
     INFO("GetTextCursor_Y = %d", y);
@@ -886,7 +1029,7 @@ loc_t RA8875::GetTextCursor_X(void)
     loc_t x;
 
     if (font == NULL)
-        x = ReadCommand(0x2A) | (ReadCommand(0x2B) << 8);
+        x = ReadCommandW((portraitmode) ? 0x2C : 0x2A);
     else
         x = cursor_x;
     INFO("GetTextCursor_X = %d", x);
@@ -897,7 +1040,7 @@ loc_t RA8875::GetTextCursor_X(void)
 RetCode_t RA8875::SetTextCursorControl(cursor_t cursor, bool blink)
 {
     unsigned char mwcr0 = ReadCommand(0x40) & 0x0F; // retain direction, auto-increase
-    unsigned char mwcr1 = ReadCommand(0x41) & 0x01; // retain currently selected layer
+    unsigned char mwcr1 = ReadCommand(0x41) & 0xF1; // retain graphic cursor and selected layer
     unsigned char horz = 0;
     unsigned char vert = 0;
 
@@ -907,7 +1050,7 @@ RetCode_t RA8875::SetTextCursorControl(cursor_t cursor, bool blink)
     if (blink)
         mwcr0 |= 0x20;              // blink
     WriteCommand(0x40, mwcr0);      // configure the cursor
-    WriteCommand(0x41, mwcr1);      // close the graphics cursor
+    WriteCommand(0x41, mwcr1);      // write destination is the layer
     WriteCommand(0x44, 0x1f);       // The cursor flashing cycle
     switch (cursor) {
         case IBEAM:
@@ -932,6 +1075,74 @@ RetCode_t RA8875::SetTextCursorControl(cursor_t cursor, bool blink)
 }
 
 
+RetCode_t RA8875::LoadGraphicCursor(uint8_t cursor, const uint8_t * image)
+{
+    if (cursor > 7 || image == NULL)
+        return bad_parameter;
+
+    unsigned char mwcr1 = ReadCommand(0x41);
+
+    WriteCommand(0x40, 0x00);                       // Graphics write mode
+    WriteCommand(0x41, (mwcr1 & 0x81) | (cursor << 4) | 0x08);  // write destination is graphic cursor n
+    WriteCommand(0x02);                             // Prepare for streaming data
+    _select(true);
+    _spiwrite(0x00);                                // Cmd: write data
+    for (int i = 0; i < 256; i++)
+        _spiwrite(image[i]);
+    _select(false);
+    WriteCommand(0x41, mwcr1);                      // restore the selection and write destination
+    return noerror;
+}
+
+
+RetCode_t RA8875::SelectGraphicCursor(uint8_t cursor)
+{
+    if (cursor > 7)
+        return bad_parameter;
+    unsigned char mwcr1 = ReadCommand(0x41) & ~0x70;
+    return WriteCommand(0x41, mwcr1 | (cursor << 4));
+}
+
+
+RetCode_t RA8875::SetGraphicCursorColors(color_t color0, color_t color1)
+{
+    WriteCommand(0x84, _cvt16to8(color0));          // GCC0
+    return WriteCommand(0x85, _cvt16to8(color1));   // GCC1
+}
+
+
+RetCode_t RA8875::SetGraphicCursorPosition(loc_t x, loc_t y)
+{
+    uint8_t regs[8];
+    uint16_t n = 0;
+
+    if (portraitmode) {                 // see _WriteCommandXY
+        loc_t t = x;
+
+        x = y;
+        y = t;
+    }
+    regs[n++] = 0x80;  regs[n++] = x & 0xFF;        // GCHP0
+    if ((x >> 8) != (gcPosition.x >> 8)) {
+        regs[n++] = 0x81;  regs[n++] = x >> 8;      // GCHP1
+    }
+    regs[n++] = 0x82;  regs[n++] = y & 0xFF;        // GCVP0
+    if ((y >> 8) != (gcPosition.y >> 8)) {
+        regs[n++] = 0x83;  regs[n++] = y >> 8;      // GCVP1
+    }
+    gcPosition.x = x;
+    gcPosition.y = y;
+    return _WriteRegisterTable(regs, n/2);
+}
+
+
+RetCode_t RA8875::ShowGraphicCursor(bool show)
+{
+    unsigned char mwcr1 = ReadCommand(0x41) & ~0x80;
+    return WriteCommand(0x41, mwcr1 | ((show) ? 0x80 : 0x00));
+}
+
+
 RetCode_t RA8875::SetTextFont(RA8875::font_t font)
 {
     if (/*font >= RA8875::ISO8859_1 && */ font <= RA8875::ISO8859_4) {
@@ -975,11 +1186,41 @@ RetCode_t RA8875::SetOrientation(RA8875::orientation_t angle)
             return bad_parameter;
     }
     INFO("Orientation: %d, %d", angle, portraitmode);
+    WriteCommand(0x45, _DirectionBits(readDirection));  // the write direction is set with each stream
     WriteCommand(0x22, fncr1Val);
     return WriteCommand(0x20, dpcrVal);
 }
 
 
+uint8_t RA8875::_DirectionBits(direction_t dir)
+{
+    // In portrait, the memory is the transpose of the view, see _WriteCommandXY,
+    // so a row of the view is a column of the memory.
+    static const uint8_t landscape[4] = { 0x0, 0x1, 0x2, 0x3 };
+    static const uint8_t portrait[4]  = { 0x2, 0x3, 0x0, 0x1 };
+
+    return (portraitmode) ? portrait[dir & 3] : landscape[dir & 3];
+}
+
+
+RetCode_t RA8875::SetWriteDirection(direction_t dir)
+{
+    if ((unsigned)dir > BottomTopLeftRight)
+        return bad_parameter;
+    writeDirection = dir;           // written with the graphics mode, at the next stream
+    return noerror;
+}
+
+
+RetCode_t RA8875::SetReadDirection(direction_t dir)
+{
+    if ((unsigned)dir > BottomTopLeftRight)
+        return bad_parameter;
+    readDirection = dir;
+    return WriteCommand(0x45, _DirectionBits(dir));     // MRCD
+}
+
+
 RetCode_t RA8875::SetTextFontControl(fill_t fillit,
                                      RA8875::HorizontalScale hScale,
                                      RA8875::VerticalScale vScale,
@@ -1054,7 +1295,7 @@ int RA8875::_external_putc(int c)
         if (c == '\r') {
             cursor_x = windowrect.p1.x;
         } else if (c == '\n') {
-            cursor_y += extFontHeight;
+            cursor_y += fontheight();
         } else {
             dim_t charWidth, charHeight;
             const uint8_t * charRecord;
@@ -1091,17 +1332,18 @@ int RA8875::_internal_putc(int c)
         if ((mwcr0 & 0x80) == 0x00) {
             WriteCommand(0x40, 0x80 | mwcr0);    // Put in Text mode if not already
         }
+        // In portrait, the x and y registers trade places, see _WriteCommandXY
         if (c == '\r') {
             loc_t x;
-            x = ReadCommand(0x30) | (ReadCommand(0x31) << 8);   // Left edge of active window
-            WriteCommandW(0x2A, x);
+            x = ReadCommandW((portraitmode) ? 0x32 : 0x30);     // Left edge of active window
+            WriteCommandW((portraitmode) ? 0x2C : 0x2A, x);
         } else if (c == '\n') {
             loc_t y;
-            y = ReadCommand(0x2C) | (ReadCommand(0x2D) << 8);   // current y location
+            y = GetTextCursor_Y();              // current y location
             y += fontheight();
             if (y >= height())               // @TODO after bottom of active window, then scroll window?
                 y = 0;
-            WriteCommandW(0x2C, y);
+            WriteCommandW((portraitmode) ? 0x2A : 0x2C, y);
         } else {
             WriteCommand(0x02);                 // RA8875 Internal Fonts
             _select(true);
@@ -1116,7 +1358,14 @@ int RA8875::_internal_putc(int c)
 
 RetCode_t RA8875::_StartGraphicsStream(void)
 {
-    WriteCommand(0x40,0x00);    // Graphics write mode
+    // In portrait, a row of the view is a column of the memory, so the
+    // stream runs top to bottom, then left to right, to stay contiguous.
+    // See _DirectionBits.
+    uint8_t mode = _DirectionBits(writeDirection) << 2;
+    uint8_t regs[2];
+
+    if (_AppendReg(regs, 0, 0x40, mode))
+        WriteCommand(0x40, mode);   // Graphics write mode, when not already
     WriteCommand(0x02);         // Prepare for streaming data
     return noerror;
 }
@@ -1128,9 +1377,54 @@ RetCode_t RA8875::_EndGraphicsStream(void)
 }
 
 
+void RA8875::SetYieldBudget(uint32_t usec)
+{
+    yieldBudget = usec;
+    yieldTimer.reset();
+    if (usec)
+        yieldTimer.start();
+    else
+        yieldTimer.stop();
+}
+
+
+void RA8875::ClearYieldStats(void)
+{
+    memset(&yieldStats, 0, sizeof(yieldStats));
+}
+
+
+void RA8875::_YieldBegin(void)
+{
+    yieldTimer.reset();
+}
+
+
+RetCode_t RA8875::_Yield(void)
+{
+    return _YieldFor(image_yield);
+}
+
+
+RetCode_t RA8875::_YieldFor(IdleReason_T reason)
+{
+    if (yieldBudget == 0 || idle_callback == NULL)
+        return noerror;
+    uint32_t gap = yieldTimer.read_us();
+    if (gap < yieldBudget)
+        return noerror;
+    yieldStats.yields++;
+    if (gap > yieldStats.maxGap)
+        yieldStats.maxGap = gap;
+    RetCode_t ret = (*idle_callback)(reason);
+    yieldTimer.reset();         // the callback's own time is not the driver's
+    return (ret == external_abort) ? external_abort : noerror;
+}
+
+
 RetCode_t RA8875::_putp(color_t pixel)
 {
-    WriteDataW((pixel>>8) | (pixel<<8));
+    WriteDataW(SwapColorBytes(pixel));     // WriteDataW sends the low byte first
     return noerror;
 }
 
@@ -1155,11 +1449,32 @@ void RA8875::puts(const char * string)
 }
 
 
+point_t RA8875::_Transpose(point_t p)
+{
+    point_t t;
+
+    t.x = p.y;
+    t.y = p.x;
+    return t;
+}
+
+
+RetCode_t RA8875::_WriteCommandXY(unsigned char command, loc_t x, loc_t y)
+{
+    if (portraitmode) {                 // the memory is the transpose of the portrait view
+        loc_t t = x;
+
+        x = y;
+        y = t;
+    }
+    WriteCommandW(command, x);
+    return WriteCommandW(command + 2, y);
+}
+
+
 RetCode_t RA8875::SetGraphicsCursor(loc_t x, loc_t y)
 {
-    WriteCommandW(0x46, x);
-    WriteCommandW(0x48, y);
-    return noerror;
+    return _WriteCommandXY(0x46, x, y);
 }
 
 RetCode_t RA8875::SetGraphicsCursor(point_t p)
@@ -1171,16 +1486,14 @@ point_t RA8875::GetGraphicsCursor(void)
 {
     point_t p;
 
-    p.x = ReadCommandW(0x46);
-    p.y = ReadCommandW(0x48);
+    p.x = ReadCommandW((portraitmode) ? 0x48 : 0x46);
+    p.y = ReadCommandW((portraitmode) ? 0x46 : 0x48);
     return p;
 }
 
 RetCode_t RA8875::SetGraphicsCursorRead(loc_t x, loc_t y)
 {
-    WriteCommandW(0x4A, x);
-    WriteCommandW(0x4C, y);
-    return noerror;
+    return _WriteCommandXY(0x4A, x, y);
 }
 
 RetCode_t RA8875::window(rect_t r)
@@ -1191,21 +1504,115 @@ RetCode_t RA8875::window(rect_t r)
 RetCode_t RA8875::window(loc_t x, loc_t y, dim_t width, dim_t height)
 {
     INFO("window(%d,%d,%d,%d)", x, y, width, height);
+    uint8_t regs[2 * 8];
+    uint16_t n;
+
+    _WindowRect(x, y, width, height);
+    n = _AppendWindow(regs, 0);     // only the registers that change
+    if (n)
+        _WriteRegisterTable(regs, n);
+    //SetTextCursor(x,y);
+    //SetGraphicsCursor(x,y);
+    return noerror;
+}
+
+
+void RA8875::_WindowRect(loc_t x, loc_t y, dim_t width, dim_t height)
+{
     if (width == (dim_t)-1)
-        width = screenwidth - x;
+        width = RA8875::width() - x;
     if (height == (dim_t)-1)
-        height = screenheight - y;
+        height = RA8875::height() - y;
     windowrect.p1.x = x;
     windowrect.p1.y = y;
     windowrect.p2.x = x + width - 1;
     windowrect.p2.y = y + height - 1;
     GraphicsDisplay::window(x,y, width,height);
-    WriteCommandW(0x30, x);
-    WriteCommandW(0x32, y);
-    WriteCommandW(0x34, (x+width-1));
-    WriteCommandW(0x36, (y+height-1));
-    //SetTextCursor(x,y);
-    //SetGraphicsCursor(x,y);
+}
+
+
+// The index of a register in regShadow, or -1 when it is not shadowed.
+static int ShadowIndex(uint8_t reg)
+{
+    if (reg >= 0x30 && reg <= 0x37)
+        return reg - 0x30;          // HSAW0 .. VEAW1, the active window
+    if (reg == 0x40)
+        return 8;                   // MWCR0
+    return -1;
+}
+
+
+void RA8875::_Shadow(uint8_t reg, uint8_t data)
+{
+    int i = ShadowIndex(reg);
+
+    if (i >= 0) {
+        regShadow[i] = data;
+        shadowValid |= 1 << i;
+    }
+}
+
+
+uint16_t RA8875::_AppendReg(uint8_t * regs, uint16_t n, uint8_t reg, uint8_t data)
+{
+    int i = ShadowIndex(reg);
+
+    if (i >= 0 && (shadowValid & (1 << i)) && regShadow[i] == data)
+        return n;                   // it already holds this
+    regs[2 * n] = reg;
+    regs[2 * n + 1] = data;
+    return n + 1;
+}
+
+
+uint16_t RA8875::_AppendWindow(uint8_t * regs, uint16_t n)
+{
+    loc_t xy[4] = { windowrect.p1.x, windowrect.p1.y, windowrect.p2.x, windowrect.p2.y };
+
+    if (portraitmode) {             // see _WriteCommandXY
+        loc_t t = xy[0]; xy[0] = xy[1]; xy[1] = t;
+        t = xy[2]; xy[2] = xy[3]; xy[3] = t;
+    }
+    for (int i = 0; i < 4; i++) {
+        n = _AppendReg(regs, n, 0x30 + 2 * i, xy[i] & 0xFF);
+        n = _AppendReg(regs, n, 0x31 + 2 * i, xy[i] >> 8);
+    }
+    return n;
+}
+
+
+RetCode_t RA8875::_BeginBlit(loc_t x, loc_t y, bool setWindow, bool read)
+{
+    uint8_t cursor = (read) ? 0x4A : 0x46;      // RCURH0 or CURH0
+    uint8_t regs[2 * (8 + 4 + 1)];
+    uint16_t n = 0;
+
+    if (setWindow)
+        n = _AppendWindow(regs, n);
+    if (portraitmode) {
+        loc_t t = x;
+
+        x = y;
+        y = t;
+    }
+    // The cursor moves as pixels are written, so it is always sent.
+    regs[2 * n] = cursor + 0;  regs[2 * n + 1] = x & 0xFF;  n++;
+    regs[2 * n] = cursor + 1;  regs[2 * n + 1] = x >> 8;    n++;
+    regs[2 * n] = cursor + 2;  regs[2 * n + 1] = y & 0xFF;  n++;
+    regs[2 * n] = cursor + 3;  regs[2 * n + 1] = y >> 8;    n++;
+    n = _AppendReg(regs, n, 0x40, _DirectionBits(writeDirection) << 2);    // Graphics write mode, see _StartGraphicsStream
+    _select(true);
+    for (uint16_t i = 0; i < n; i++) {
+        _spiwrite(0x80);            // Cmd: write command
+        _spiwrite(regs[2 * i]);
+        _spiwrite(0x00);            // Cmd: write data
+        _spiwrite(regs[2 * i + 1]);
+        _Shadow(regs[2 * i], regs[2 * i + 1]);
+    }
+    lastCommand = 0x02;
+    _spiwrite(0x80);                // Cmd: write command
+    _spiwrite(0x02);                // Prepare for streaming data
+    _select(false);
     return noerror;
 }
 
@@ -1251,6 +1658,75 @@ RetCode_t RA8875::clsw(RA8875::Region_t region)
 }
 
 
+RetCode_t RA8875::clsRects(const rect_t * rects, int count, uint16_t layers)
+{
+    uint16_t prevLayer = GetDrawingLayer();
+    loc_t right = width() - 1;
+    loc_t bottom = height() - 1;
+    RetCode_t ret = noerror;
+
+    if (layers > 3 || (count && rects == NULL))
+        return bad_parameter;
+    PERFORMANCE_RESET;
+    _writeColorTrio(0x63, _background);     // the fill uses the foreground registers
+    uint16_t pass = (layers) ? layers : (uint16_t)(1 << prevLayer);    // 0 is the drawing layer, once
+    for (uint16_t layer = 0; layer < 2; layer++) {
+        uint8_t regs[2 * 9];
+        uint16_t last[4];                   // the coordinates written last
+        bool first = true;
+        bool busy = false;
+
+        if (!(pass & (1 << layer)))
+            continue;
+        if (layers)
+            SelectDrawingLayer(layer);
+        for (int i = 0; i < count; i++) {
+            loc_t x1 = max(rects[i].p1.x, 0);
+            loc_t y1 = max(rects[i].p1.y, 0);
+            loc_t x2 = min(rects[i].p2.x, right);
+            loc_t y2 = min(rects[i].p2.y, bottom);
+            uint16_t xy[4];
+            uint16_t n = 0;
+
+            if (x2 < x1 || y2 < y1)
+                continue;
+            if (portraitmode) {             // see _WriteCommandXY
+                xy[0] = y1; xy[1] = x1; xy[2] = y2; xy[3] = x2;
+            } else {
+                xy[0] = x1; xy[1] = y1; xy[2] = x2; xy[3] = y2;
+            }
+            for (int k = 0; k < 4; k++) {   // 0x91-0x98, low then high byte
+                if (first || (xy[k] & 0xFF) != (last[k] & 0xFF)) {
+                    regs[n++] = 0x91 + 2 * k;  regs[n++] = xy[k] & 0xFF;
+                }
+                if (first || (xy[k] >> 8) != (last[k] >> 8)) {
+                    regs[n++] = 0x92 + 2 * k;  regs[n++] = xy[k] >> 8;
+                }
+                last[k] = xy[k];
+            }
+            // A line, when the rectangle is one pixel thin, as for rect().
+            regs[n++] = 0x90;  regs[n++] = (x1 == x2 || y1 == y2) ? 0x80 : 0xB0;
+            first = false;
+            if (busy && !_WaitWhileReg(0x90, 0x80)) {
+                ret = external_abort;
+                break;
+            }
+            _WriteRegisterTable(regs, n/2);
+            busy = true;
+        }
+        if (busy && !_WaitWhileReg(0x90, 0x80))
+            ret = external_abort;
+        if (ret != noerror)
+            break;
+    }
+    if (layers)
+        SelectDrawingLayer(prevLayer);
+    _writeColorTrio(0x63, _foreground);
+    REGISTERPERFORMANCE(PRF_CLS);
+    return ret;
+}
+
+
 RetCode_t RA8875::pixel(point_t p, color_t color)
 {
     return pixel(p.x, p.y, color);
@@ -1286,19 +1762,61 @@ RetCode_t RA8875::pixel(loc_t x, loc_t y)
 
 RetCode_t RA8875::pixelStream(color_t * p, uint32_t count, loc_t x, loc_t y)
 {
+    PixelBuffer_T buf = { p, count, HostRGB565 };
+
+    return pixelStream(buf, x, y);
+}
+
+RetCode_t RA8875::pixelStream8(uint8_t * p, uint32_t count, loc_t x, loc_t y)
+{
+    PixelBuffer_T buf = { p, count, WireRGB332 };   // one byte carries a whole pixel
+
+    return pixelStream(buf, x, y);
+}
+
+RetCode_t RA8875::pixelStream(const PixelBuffer_T & buf, loc_t x, loc_t y)
+{
+    const uint8_t * p = (const uint8_t *)buf.data;
+    uint32_t count = buf.count;
+
+    if (p == NULL && buf.count)
+        return bad_parameter;
     PERFORMANCE_RESET;
-    SetGraphicsCursor(x, y);
-    _StartGraphicsStream();
+    _BeginBlit(x, y);
     _select(true);
     _spiwrite(0x00);         // Cmd: write data
-    while (count--) {
-        if (screenbpp == 16) {
-            _spiwrite(*p >> 8);
-            _spiwrite(*p & 0xFF);
-        } else {
-            _spiwrite(_cvt16to8(*p));
+    if (screenbpp == 16 && buf.format == WireRGB565) {
+        _spiwriteBlock(p, count * 2);       // the caller's memory, as it is
+    } else if (screenbpp == 8 && buf.format == WireRGB332) {
+        _spiwriteBlock(p, count);
+    } else {
+        color_t c16[RA8875_WIRE_CHUNK];
+        uint8_t wire[2 * RA8875_WIRE_CHUNK];
+
+        while (count) {
+            uint32_t n = (count < RA8875_WIRE_CHUNK) ? count : RA8875_WIRE_CHUNK;
+            const color_t * host = c16;
+
+            // Reach color_t first, unless the buffer is already there.
+            if (buf.format == HostRGB565) {
+                host = (const color_t *)p;
+                p += 2 * n;
+            } else if (buf.format == WireRGB565) {
+                WireToRGB565(c16, p, n);
+                p += 2 * n;
+            } else {
+                RGB332ToRGB565(c16, p, n);
+                p += n;
+            }
+            if (screenbpp == 16) {
+                RGB565ToWire(wire, host, n);
+                _spiwriteBlock(wire, 2 * n);
+            } else {
+                RGB565ToRGB332(wire, host, n);
+                _spiwriteBlock(wire, n);
+            }
+            count -= n;
         }
-        p++;
     }
     _select(false);
     _EndGraphicsStream();
@@ -1306,30 +1824,33 @@ RetCode_t RA8875::pixelStream(color_t * p, uint32_t count, loc_t x, loc_t y)
     return(noerror);
 }
 
+
 RetCode_t RA8875::booleanStream(loc_t x, loc_t y, dim_t w, dim_t h, const uint8_t * boolStream)
 {
     PERFORMANCE_RESET;
     rect_t restore = windowrect;
 
-    window(x, y, w, h);
-    SetGraphicsCursor(x, y);
-    _StartGraphicsStream();
+    _WindowRect(x, y, w, h);
+    _BeginBlit(x, y, true);         // the window, cursor and mode in one burst
     _select(true);
     _spiwrite(0x00);         // Cmd: write data
+    // Both colors are reduced to the wire format once, rather than per pixel.
+    uint8_t fg8 = RGB565To332(_foreground);
+    uint8_t bg8 = RGB565To332(_background);
     while (h--) {
-        uint8_t pixels = w;
+        dim_t pixels = w;
         uint8_t bitmask = 0x01;
 
         while (pixels) {
             uint8_t byte = *boolStream;
             //INFO("byte, mask: %02X, %02X", byte, bitmask);
-            color_t c = (byte & bitmask) ? _foreground : _background;
-                if (screenbpp == 16) {
-                    _spiwrite(c >> 8);
-                    _spiwrite(c & 0xFF);
-                } else {
-                    _spiwrite(_cvt16to8(c));
-                }
+            if (screenbpp == 16) {
+                color_t c = (byte & bitmask) ? _foreground : _background;
+                _spiwrite(c >> 8);
+                _spiwrite(c & 0xFF);
+            } else {
+                _spiwrite((byte & bitmask) ? fg8 : bg8);
+            }
             bitmask <<= 1;
             if (pixels > 1 && bitmask == 0) {
                 bitmask = 0x01;
@@ -1375,9 +1896,7 @@ RetCode_t RA8875::getPixelStream(color_t * p, uint32_t count, loc_t x, loc_t y)
     RetCode_t ret = noerror;
 
     PERFORMANCE_RESET;
-    ret = WriteCommand(0x40,0x00);    // Graphics write mode
-    ret = SetGraphicsCursorRead(x, y);
-    ret = WriteCommand(0x02);
+    ret = _BeginBlit(x, y, false, true);    // graphics mode, read cursor
     _select(true);
     _spiwrite(0x40);         // Cmd: read data
     _spiwrite(0x00);         // dummy read
@@ -1398,14 +1917,58 @@ RetCode_t RA8875::getPixelStream(color_t * p, uint32_t count, loc_t x, loc_t y)
 }
 
 
-RetCode_t RA8875::line(point_t p1, point_t p2)
+RetCode_t RA8875::getPixelRect(color_t * p, rect_t r, dim_t stride)
 {
-    return line(p1.x, p1.y, p2.x, p2.y);
-}
-
+    dim_t w = r.p2.x - r.p1.x + 1;
+    dim_t h = r.p2.y - r.p1.y + 1;
+    rect_t restore = windowrect;
 
-RetCode_t RA8875::line(point_t p1, point_t p2, color_t color)
-{
+    if (p == NULL || r.p1.x < 0 || r.p1.y < 0 || r.p2.x < r.p1.x || r.p2.y < r.p1.y
+    || r.p2.x >= width() || r.p2.y >= height())
+        return bad_parameter;
+    if (stride == 0)
+        stride = w;
+    if (stride < w)
+        return bad_parameter;
+    PERFORMANCE_RESET;
+    _WindowRect(r.p1.x, r.p1.y, w, h);
+    _BeginBlit(r.p1.x, r.p1.y, true, true);     // the read cursor wraps within the window
+    _select(true);
+    _spiwrite(0x40);         // Cmd: read data
+    _spiwrite(0x00);         // dummy read
+    if (screenbpp == 16)
+        _spiwrite(0x00);     // dummy read is only necessary when in 16-bit mode
+    for (dim_t j = 0; j < h; j++) {
+        color_t * q = p + (uint32_t)j * stride;
+
+        // Unlike getPixelStream, these are in the order of color_t, so
+        // they can be streamed back as they are.
+        if (screenbpp == 16) {
+            for (dim_t i = 0; i < w; i++) {
+                color_t pixel = _spiread() << 8;
+
+                *q++ = pixel | _spiread();
+            }
+        } else {
+            for (dim_t i = 0; i < w; i++)
+                *q++ = RGB332To565(_spiread());
+        }
+    }
+    _select(false);
+    window(restore);
+    REGISTERPERFORMANCE(PRF_READPIXELSTREAM);
+    return noerror;
+}
+
+
+RetCode_t RA8875::line(point_t p1, point_t p2)
+{
+    return line(p1.x, p1.y, p2.x, p2.y);
+}
+
+
+RetCode_t RA8875::line(point_t p1, point_t p2, color_t color)
+{
     return line(p1.x, p1.y, p2.x, p2.y, color);
 }
 
@@ -1423,10 +1986,8 @@ RetCode_t RA8875::line(loc_t x1, loc_t y1, loc_t x2, loc_t y2)
     if (x1 == x2 && y1 == y2) {
         pixel(x1, y1);
     } else {
-        WriteCommandW(0x91, x1);
-        WriteCommandW(0x93, y1);
-        WriteCommandW(0x95, x2);
-        WriteCommandW(0x97, y2);
+        _WriteCommandXY(0x91, x1, y1);
+        _WriteCommandXY(0x95, x2, y2);
         unsigned char drawCmd = 0x00;       // Line
         WriteCommand(0x90, drawCmd);
         WriteCommand(0x90, 0x80 + drawCmd); // Start drawing.
@@ -1449,10 +2010,13 @@ RetCode_t RA8875::ThickLine(point_t p1, point_t p2, dim_t thickness, color_t col
         int dy = abs(p2.y-p1.y), sy = p1.y<p2.y ? 1 : -1;
         int err = (dx>dy ? dx : -dy)/2, e2;
 
+        _YieldBegin();
         for (;;) {
             fillcircle(p1.x, p1.y, thickness/2, color);
             if (p1.x==p2.x && p1.y==p2.y)
                 break;
+            if (_YieldFor(draw_yield) == external_abort)
+                return external_abort;
             e2 = err;
             if (e2 >-dx)
                 { err -= dy; p1.x += sx; }
@@ -1497,8 +2061,8 @@ RetCode_t RA8875::rect(loc_t x1, loc_t y1, loc_t x2, loc_t y2,
     RetCode_t ret = noerror;
     PERFORMANCE_RESET;
     // check for bad_parameter
-    if (x1 < 0 || x1 >= screenwidth || x2 < 0 || x2 >= screenwidth
-    || y1 < 0 || y1 >= screenheight || y2 < 0 || y2 >= screenheight) {
+    if (x1 < 0 || x1 >= width() || x2 < 0 || x2 >= width()
+    || y1 < 0 || y1 >= height() || y2 < 0 || y2 >= height()) {
         ret = bad_parameter;
     } else {
         if (x1 == x2 && y1 == y2) {
@@ -1508,10 +2072,8 @@ RetCode_t RA8875::rect(loc_t x1, loc_t y1, loc_t x2, loc_t y2,
         } else if (y1 == y2) {
             line(x1, y1, x2, y2);
         } else {
-            WriteCommandW(0x91, x1);
-            WriteCommandW(0x93, y1);
-            WriteCommandW(0x95, x2);
-            WriteCommandW(0x97, y2);
+            _WriteCommandXY(0x91, x1, y1);
+            _WriteCommandXY(0x95, x2, y2);
             unsigned char drawCmd = 0x10;   // Rectangle
             if (fillit == FILL)
                 drawCmd |= 0x20;
@@ -1563,8 +2125,8 @@ RetCode_t RA8875::roundrect(loc_t x1, loc_t y1, loc_t x2, loc_t y2,
     RetCode_t ret = noerror;
 
     PERFORMANCE_RESET;
-    if (x1 < 0 || x1 >= screenwidth || x2 < 0 || x2 >= screenwidth
-    || y1 < 0 || y1 >= screenheight || y2 < 0 || y2 >= screenheight) {
+    if (x1 < 0 || x1 >= width() || x2 < 0 || x2 >= width()
+    || y1 < 0 || y1 >= height() || y2 < 0 || y2 >= height()) {
         ret = bad_parameter;
     } else if (x1 > x2 || y1 > y2 || (radius1 > (x2-x1)/2) || (radius2 > (y2-y1)/2) ) {
         ret = bad_parameter;
@@ -1575,12 +2137,9 @@ RetCode_t RA8875::roundrect(loc_t x1, loc_t y1, loc_t x2, loc_t y2,
     } else if (y1 == y2) {
         line(x1, y1, x2, y2);
     } else {
-        WriteCommandW(0x91, x1);
-        WriteCommandW(0x93, y1);
-        WriteCommandW(0x95, x2);
-        WriteCommandW(0x97, y2);
-        WriteCommandW(0xA1, radius1);
-        WriteCommandW(0xA3, radius2);
+        _WriteCommandXY(0x91, x1, y1);
+        _WriteCommandXY(0x95, x2, y2);
+        _WriteCommandXY(0xA1, radius1, radius2);
         // Should not need this...
         WriteCommandW(0xA5, 0);
         WriteCommandW(0xA7, 0);
@@ -1608,8 +2167,8 @@ RetCode_t RA8875::triangle(loc_t x1, loc_t y1, loc_t x2, loc_t y2,
 {
     RetCode_t ret;
 
-    if (x1 < 0 || x1 >= screenwidth || x2 < 0 || x2 >= screenwidth || x3 < 0 || x3 >= screenwidth
-    || y1 < 0 || y1 >= screenheight || y2 < 0 || y2 >= screenheight || y3 < 0 || y3 >= screenheight)
+    if (x1 < 0 || x1 >= width() || x2 < 0 || x2 >= width() || x3 < 0 || x3 >= width()
+    || y1 < 0 || y1 >= height() || y2 < 0 || y2 >= height() || y3 < 0 || y3 >= height())
         ret = bad_parameter;
     foreground(color);
     ret = triangle(x1,y1,x2,y2,x3,y3,fillit);
@@ -1637,12 +2196,9 @@ RetCode_t RA8875::triangle(loc_t x1, loc_t y1 ,loc_t x2, loc_t y2,
     if (x1 == x2 && y1 == y2 && x1 == x3 && y1 == y3) {
         pixel(x1, y1);
     } else {
-        WriteCommandW(0x91, x1);
-        WriteCommandW(0x93, y1);
-        WriteCommandW(0x95, x2);
-        WriteCommandW(0x97, y2);
-        WriteCommandW(0xA9, x3);
-        WriteCommandW(0xAB, y3);
+        _WriteCommandXY(0x91, x1, y1);
+        _WriteCommandXY(0x95, x2, y2);
+        _WriteCommandXY(0xA9, x3, y3);
         unsigned char drawCmd = 0x01;       // Triangle
         if (fillit == FILL)
             drawCmd |= 0x20;
@@ -1701,14 +2257,13 @@ RetCode_t RA8875::circle(loc_t x, loc_t y, dim_t radius, fill_t fillit)
     RetCode_t ret = noerror;
 
     PERFORMANCE_RESET;
-    if (radius <= 0 || (x - radius) < 0 || (x + radius) > screenwidth
-    || (y - radius) < 0 || (y + radius) > screenheight) {
+    if (radius <= 0 || (x - radius) < 0 || (x + radius) > width()
+    || (y - radius) < 0 || (y + radius) > height()) {
         ret = bad_parameter;
     } else if (radius == 1) {
         pixel(x,y);
     } else {
-        WriteCommandW(0x99, x);
-        WriteCommandW(0x9B, y);
+        _WriteCommandXY(0x99, x, y);
         WriteCommand(0x9d, radius & 0xFF);
         unsigned char drawCmd = 0x00;       // Circle
         if (fillit == FILL)
@@ -1744,16 +2299,14 @@ RetCode_t RA8875::ellipse(loc_t x, loc_t y, dim_t radius1, dim_t radius2, fill_t
     RetCode_t ret = noerror;
 
     PERFORMANCE_RESET;
-    if (radius1 <= 0 || radius2 <= 0 || (x - radius1) < 0 || (x + radius1) > screenwidth
-    || (y - radius2) < 0 || (y + radius2) > screenheight) {
+    if (radius1 <= 0 || radius2 <= 0 || (x - radius1) < 0 || (x + radius1) > width()
+    || (y - radius2) < 0 || (y + radius2) > height()) {
         ret = bad_parameter;
     } else if (radius1 == 1 && radius2 == 1) {
         pixel(x, y);
     } else {
-        WriteCommandW(0xA5, x);
-        WriteCommandW(0xA7, y);
-        WriteCommandW(0xA1, radius1);
-        WriteCommandW(0xA3, radius2);
+        _WriteCommandXY(0xA5, x, y);
+        _WriteCommandXY(0xA1, radius1, radius2);
         unsigned char drawCmd = 0x00;   // Ellipse
         if (fillit == FILL)
             drawCmd |= 0x40;
@@ -1781,19 +2334,38 @@ RetCode_t RA8875::frequency(unsigned long Hz, unsigned long Hz2)
     // Clock   ___A     Rising edge latched
     //       ___ ____
     // Data  ___X____
-    spi.format(8, 3);           // 8 bits and clock to data phase 0
+    if (bus)
+        bus->SetFormat(busId, 8, 3);
+    else
+        spi->format(8, 3);      // 8 bits and clock to data phase 0
+    return noerror;
+}
+
+
+RetCode_t RA8875::AddMirror(RA8875 & panel)
+{
+    if (!bus || panel.bus != bus || busId < 0 || panel.busId < 0 || panel.busId == busId)
+        return bad_parameter;
+    mirrorMask |= 1 << panel.busId;
+    return noerror;
+}
+
+
+RetCode_t RA8875::ClearMirrors(void)
+{
+    mirrorMask = 0;
     return noerror;
 }
 
 void RA8875::_setWriteSpeed(bool writeSpeed)
 {
-    if (writeSpeed) {
-        spi.frequency(spiwritefreq);
-        spiWriteSpeed = true;
-    } else {
-        spi.frequency(spireadfreq);
-        spiWriteSpeed = false;
-    }
+    unsigned long hz = (writeSpeed) ? spiwritefreq : spireadfreq;
+
+    if (bus)
+        bus->SetFrequency(busId, hz);   // and restored by the bus after another device
+    else
+        spi->frequency(hz);
+    spiWriteSpeed = writeSpeed;
 }
 
 
@@ -1806,6 +2378,11 @@ RetCode_t RA8875::BlockMove(uint8_t dstLayer, uint8_t dstDataSelect, point_t dst
     uint8_t cmd;
 
     PERFORMANCE_RESET;
+    if (portraitmode) {                 // see _WriteCommandXY
+        srcPoint = _Transpose(srcPoint);
+        dstPoint = _Transpose(dstPoint);
+        dim_t t = bte_width; bte_width = bte_height; bte_height = t;
+    }
     ///@todo range check and error return rather than to secretly fix
     srcPoint.x &= 0x3FF;    // prevent high bits from doing unexpected things
     srcPoint.y &= 0x1FF;
@@ -1831,6 +2408,10 @@ RetCode_t RA8875::BlockMove(uint8_t dstLayer, uint8_t dstDataSelect, point_t dst
 
 RetCode_t RA8875::Power(bool on)
 {
+    if (on && resumeShowPending) {
+        _ResumeShow();                  // the display was left off by Resume for a repaint
+        return noerror;
+    }
     WriteCommand(0x01, (on) ? 0x80 : 0x00);
     return noerror;
 }
@@ -1838,18 +2419,19 @@ RetCode_t RA8875::Power(bool on)
 
 RetCode_t RA8875::Backlight_u8(uint8_t brightness)
 {
-    static bool is_enabled = false;
-
+    fadeActive = false;                 // this overrides any fade in progress
+    fadePending = false;
+    fadeLevel = brightness;
     if (brightness == 0) {
         WriteCommand(0x8a); // Disable the PWM
         WriteData(0x00);
-        is_enabled = false;
-    } else if (!is_enabled) {
+        pwmEnabled = false;
+    } else if (!pwmEnabled) {
         WriteCommand(0x8a); // Enable the PWM
         WriteData(0x80);
         WriteCommand(0x8a); // Not sure why this is needed, but following the pattern
         WriteData(0x81);    // open PWM (SYS_CLK / 2 as best I can tell)
-        is_enabled = true;
+        pwmEnabled = true;
     }
     WriteCommand(0x8b, brightness);  // Brightness parameter 0xff-0x00
     return noerror;
@@ -1937,6 +2519,12 @@ color_t RA8875::GetForeColor(void)
 }
 
 
+color_t RA8875::GetBackColor(void)
+{
+    return _readColorTrio(0x60);
+}
+
+
 color_t RA8875::DOSColor(int i)
 {
     const color_t colors[16] = {
@@ -1976,19 +2564,43 @@ unsigned char RA8875::_spiwrite(unsigned char data)
 
     if (!spiWriteSpeed)
         _setWriteSpeed(true);
-    retval = spi.write(data);
+    retval = spi->write(data);
+    COUNTBUSBYTE;
     return retval;
 }
 
 
+void RA8875::_spiwriteBlock(const uint8_t * p, uint32_t count)
+{
+    if (!spiWriteSpeed)
+        _setWriteSpeed(true);
+#ifdef RA8875_SPI_BLOCK
+    spi->write((const char *)p, count, NULL, 0);
+#else
+    for (uint32_t i = 0; i < count; i++)
+        spi->write(p[i]);
+#endif
+    COUNTBUSBYTES(count);
+}
+
+
 unsigned char RA8875::_spiread(void)
 {
     unsigned char retval;
     unsigned char data = 0;
 
+    // Only this panel answers. The mirrors stay deselected until the next
+    // _select, since they would take a write in the middle of this
+    // transaction as the start of a new one. Every read in the driver
+    // ends its transaction, so nothing is lost.
+    if (mirrorSelected) {
+        bus->Deselect(mirrorMask);
+        mirrorSelected = false;
+    }
     if (spiWriteSpeed)
         _setWriteSpeed(false);
-    retval = spi.read(data);
+    retval = spi->read(data);
+    COUNTBUSBYTE;
     return retval;
 }
 
@@ -1996,11 +2608,51 @@ unsigned char RA8875::_spiread(void)
 RetCode_t RA8875::_select(bool chipsel)
 {
     // cs = (chipsel == true) ? 0 : 1;
-    spi.udma_cs((chipsel == true) ? 0 : 1);
+    // spiInUse brackets the selection, so the backlight fade interrupt
+    // can tell when the bus is free.
+    if (chipsel) {
+        spiInUse = true;
+        if (bus) {
+            bus->Acquire(busId);
+            if (mirrorMask) {
+                bus->Select(mirrorMask);
+                mirrorSelected = true;
+            }
+        } else {
+            spi->udma_cs(0);
+        }
+    } else {
+        if (bus) {
+            bus->Release(busId);
+            mirrorSelected = false;
+        } else {
+            spi->udma_cs(1);
+        }
+        spiInUse = false;
+    }
     return noerror;
 }
 
 
+bool RA8875::_trySelect(void)
+{
+    if (spiInUse)
+        return false;
+    if (bus) {
+        if (!bus->TryAcquire(busId))
+            return false;
+        if (mirrorMask) {
+            bus->Select(mirrorMask);
+            mirrorSelected = true;
+        }
+    } else {
+        spi->udma_cs(0);
+    }
+    spiInUse = true;
+    return true;
+}
+
+
 RetCode_t RA8875::PrintScreen(uint16_t layer, loc_t x, loc_t y, dim_t w, dim_t h, const char *Name_BMP)
 {
     (void)layer;
@@ -2046,10 +2698,10 @@ RetCode_t RA8875::PrintScreen(loc_t x, loc_t y, dim_t w, dim_t h)
     color_t * pixelBuffer2 = NULL;
 
     INFO("(%d,%d) - (%d,%d)", x,y,w,h);
-    if (x >= 0 && x < screenwidth
-            && y >= 0 && y < screenheight
-            && w > 0 && x + w <= screenwidth
-            && h > 0 && y + h <= screenheight) {
+    if (x >= 0 && x < width()
+            && y >= 0 && y < height()
+            && w > 0 && x + w <= width()
+            && h > 0 && y + h <= height()) {
 
         BMP_Header.bfType = BF_TYPE;
         BMP_Header.bfSize = (w * h * sizeof(RGBQUAD)) + sizeof(BMP_Header) + sizeof(BMP_Header);
@@ -2132,6 +2784,8 @@ RetCode_t RA8875::PrintScreen(loc_t x, loc_t y, dim_t w, dim_t h)
 
         // Read the display from the last line toward the top
         // so we can write the file in one pass.
+        RetCode_t ret = noerror;
+        _YieldBegin();
         for (int j = h - 1; j >= 0; j--) {
             if (ltpr0 >= 2)             // Need to combine the layers...
                 SelectDrawingLayer(0);  // so read layer 0 first
@@ -2147,40 +2801,39 @@ RetCode_t RA8875::PrintScreen(loc_t x, loc_t y, dim_t w, dim_t h)
             }
             INFO("1st Color: %04X", pixelBuffer[0]);
             HexDump("Raster", (uint8_t *)pixelBuffer, w);
-            // Convert the local buffer to RGBQUAD format
-            int lb = 0;
-            for (int i=0; i<w; i++) {
-                RGBQUAD q0 = RGB16ToRGBQuad(pixelBuffer[x+i]);      // Scale to 24-bits
-                RGBQUAD q1 = RGB16ToRGBQuad(pixelBuffer2[x+i]);     // Scale to 24-bits
-                switch (ltpr0) {
-                    case 0:
-                    case 1:
-                    case 2: // lighten-overlay  (@TODO Not supported yet)
-                    case 6: // Floating Windows     (@TODO not sure how to support)
-                    default: // Reserved...
-                        lineBuffer[lb++] = q0.rgbBlue;
-                        lineBuffer[lb++] = q0.rgbGreen;
-                        lineBuffer[lb++] = q0.rgbRed;
-                        break;
-                    case 3: // transparent mode (@TODO Read the background color register for transparent)
-                    case 4: // boolean or
-                        lineBuffer[lb++] = q0.rgbBlue | q1.rgbBlue;
-                        lineBuffer[lb++] = q0.rgbGreen | q1.rgbGreen;
-                        lineBuffer[lb++] = q0.rgbRed | q1.rgbRed;
-                        break;
-                    case 5: // boolean AND
-                        lineBuffer[lb++] = q0.rgbBlue & q1.rgbBlue;
-                        lineBuffer[lb++] = q0.rgbGreen & q1.rgbGreen;
-                        lineBuffer[lb++] = q0.rgbRed & q1.rgbRed;
-                        break;
-                }
+            // Combine the layers, then convert the line to BMP format. Widening
+            // a color repeats its bits, so the OR and AND of the 16-bit colors
+            // widen to the OR and AND of the 24-bit colors.
+            switch (ltpr0) {
+                case 0:
+                case 1:
+                case 2: // lighten-overlay  (@TODO Not supported yet)
+                case 6: // Floating Windows     (@TODO not sure how to support)
+                default: // Reserved...
+                    break;
+                case 3: // transparent mode (@TODO Read the background color register for transparent)
+                case 4: // boolean or
+                    for (int i=0; i<w; i++)
+                        pixelBuffer[i] |= pixelBuffer2[i];
+                    break;
+                case 5: // boolean AND
+                    for (int i=0; i<w; i++)
+                        pixelBuffer[i] &= pixelBuffer2[i];
+                    break;
             }
+            SwapColorBytes(pixelBuffer, pixelBuffer, w);        // getPixelStream is byte-swapped
+            RGB565ToBGR888(lineBuffer, pixelBuffer, w);         // Scale to 24-bits
+            int lb = 3 * w;
             if (j == h - 1) {
                 HexDump("Line", lineBuffer, lineBufSize);
             }
             // Write to disk
             //fwrite(lineBuffer, sizeof(char), lb, Image);
             privateCallback(WRITE, (uint8_t *)lineBuffer, lb);
+            if (_YieldFor(capture_yield) == external_abort) {
+                ret = external_abort;       // the file is closed, but incomplete
+                break;
+            }
         }
         SelectDrawingLayer(prevLayer);
         //fclose(Image);
@@ -2194,7 +2847,7 @@ RetCode_t RA8875::PrintScreen(loc_t x, loc_t y, dim_t w, dim_t h)
             swFree(pixelBuffer);
         swFree(lineBuffer);
         INFO("Image closed");
-        return noerror;
+        return ret;
     } else {
         return bad_parameter;
     }
@@ -2209,10 +2862,10 @@ RetCode_t RA8875::PrintScreen(loc_t x, loc_t y, dim_t w, dim_t h, const char *Na
     color_t * pixelBuffer2 = NULL;
 
     INFO("(%d,%d) - (%d,%d) %s", x,y,w,h,Name_BMP);
-    if (x >= 0 && x < screenwidth
-            && y >= 0 && y < screenheight
-            && w > 0 && x + w <= screenwidth
-            && h > 0 && y + h <= screenheight) {
+    if (x >= 0 && x < width()
+            && y >= 0 && y < height()
+            && w > 0 && x + w <= width()
+            && h > 0 && y + h <= height()) {
 
         BMP_Header.bfType = BF_TYPE;
         BMP_Header.bfSize = (w * h * sizeof(RGBQUAD)) + sizeof(BMP_Header) + sizeof(BMP_Header);
@@ -2303,6 +2956,8 @@ RetCode_t RA8875::PrintScreen(loc_t x, loc_t y, dim_t w, dim_t h, const char *Na
 
         // Read the display from the last line toward the top
         // so we can write the file in one pass.
+        RetCode_t ret = noerror;
+        _YieldBegin();
         for (int j = h - 1; j >= 0; j--) {
             if (ltpr0 >= 2)             // Need to combine the layers...
                 SelectDrawingLayer(0);  // so read layer 0 first
@@ -2318,39 +2973,38 @@ RetCode_t RA8875::PrintScreen(loc_t x, loc_t y, dim_t w, dim_t h, const char *Na
             }
             INFO("1st Color: %04X", pixelBuffer[0]);
             HexDump("Raster", (uint8_t *)pixelBuffer, w);
-            // Convert the local buffer to RGBQUAD format
-            int lb = 0;
-            for (int i=0; i<w; i++) {
-                RGBQUAD q0 = RGB16ToRGBQuad(pixelBuffer[x+i]);      // Scale to 24-bits
-                RGBQUAD q1 = RGB16ToRGBQuad(pixelBuffer2[x+i]);     // Scale to 24-bits
-                switch (ltpr0) {
-                    case 0:
-                    case 1:
-                    case 2: // lighten-overlay  (@TODO Not supported yet)
-                    case 6: // Floating Windows     (@TODO not sure how to support)
-                    default: // Reserved...
-                        lineBuffer[lb++] = q0.rgbBlue;
-                        lineBuffer[lb++] = q0.rgbGreen;
-                        lineBuffer[lb++] = q0.rgbRed;
-                        break;
-                    case 3: // transparent mode (@TODO Read the background color register for transparent)
-                    case 4: // boolean or
-                        lineBuffer[lb++] = q0.rgbBlue | q1.rgbBlue;
-                        lineBuffer[lb++] = q0.rgbGreen | q1.rgbGreen;
-                        lineBuffer[lb++] = q0.rgbRed | q1.rgbRed;
-                        break;
-                    case 5: // boolean AND
-                        lineBuffer[lb++] = q0.rgbBlue & q1.rgbBlue;
-                        lineBuffer[lb++] = q0.rgbGreen & q1.rgbGreen;
-                        lineBuffer[lb++] = q0.rgbRed & q1.rgbRed;
-                        break;
-                }
+            // Combine the layers, then convert the line to BMP format. Widening
+            // a color repeats its bits, so the OR and AND of the 16-bit colors
+            // widen to the OR and AND of the 24-bit colors.
+            switch (ltpr0) {
+                case 0:
+                case 1:
+                case 2: // lighten-overlay  (@TODO Not supported yet)
+                case 6: // Floating Windows     (@TODO not sure how to support)
+                default: // Reserved...
+                    break;
+                case 3: // transparent mode (@TODO Read the background color register for transparent)
+                case 4: // boolean or
+                    for (int i=0; i<w; i++)
+                        pixelBuffer[i] |= pixelBuffer2[i];
+                    break;
+                case 5: // boolean AND
+                    for (int i=0; i<w; i++)
+                        pixelBuffer[i] &= pixelBuffer2[i];
+                    break;
             }
+            SwapColorBytes(pixelBuffer, pixelBuffer, w);        // getPixelStream is byte-swapped
+            RGB565ToBGR888(lineBuffer, pixelBuffer, w);         // Scale to 24-bits
+            int lb = 3 * w;
             if (j == h - 1) {
                 HexDump("Line", lineBuffer, lineBufSize);
             }
             // Write to disk
             fwrite(lineBuffer, sizeof(char), lb, Image);
+            if (_YieldFor(capture_yield) == external_abort) {
+                ret = external_abort;       // the file is closed, but incomplete
+                break;
+            }
         }
         SelectDrawingLayer(prevLayer);
         fclose(Image);
@@ -2362,7 +3016,7 @@ RetCode_t RA8875::PrintScreen(loc_t x, loc_t y, dim_t w, dim_t h, const char *Na
             swFree(pixelBuffer);
         swFree(lineBuffer);
         INFO("Image closed");
-        return noerror;
+        return ret;
     } else {
         return bad_parameter;
     }
@@ -2377,6 +3031,13 @@ RetCode_t RA8875::PrintScreen(loc_t x, loc_t y, dim_t w, dim_t h, const char *Na
 
 #include "BPG_Arial08x08.h"
 #include "BPG_Arial20x20.h"
+#include "Widgets.h"
+#include "StripChart.h"
+#include "Gauge.h"
+#include "Keyboard.h"
+#include "ListView.h"
+#include "Overlay.h"
+#include "DeferredFrame.h"
 
 //      ______________  ______________  ______________  _______________
 //     /_____   _____/ /  ___________/ /  ___________/ /_____   ______/
@@ -2548,6 +3209,45 @@ void TextCursorTest(RA8875 & display, Serial & pc)
 }
 
 
+void GraphicCursorTest(RA8875 & display, Serial & pc)
+{
+    uint8_t arrow[256];
+    int delay = 20;
+
+    if (!SuppressSlowStuff)
+        pc.printf("Graphic Cursor Test\r\n");
+    else
+        delay = 0;
+    display.background(Black);
+    display.foreground(Blue);
+    display.cls();
+    display.Backlight_u8(255);
+    display.puts("Graphic Cursor Test.");
+    for (int i = 0; i < display.width(); i += 40)
+        display.fillrect(i, 40, i + 19, display.height() - 1, display.DOSColor((i/40) & 0x0F));
+
+    // An arrow, color 1 outline, color 0 fill, transparent elsewhere
+    memset(arrow, 0xAA, sizeof(arrow));
+    for (int r = 0; r < 16; r++) {
+        for (int c = 0; c <= r; c++) {
+            uint8_t v = (c == 0 || c == r || r == 15) ? 0x1 : 0x0;
+            int shift = 6 - 2 * (c & 3);
+            arrow[r * 8 + c / 4] = (arrow[r * 8 + c / 4] & ~(0x3 << shift)) | (v << shift);
+        }
+    }
+    display.LoadGraphicCursor(0, arrow);
+    display.SelectGraphicCursor(0);
+    display.SetGraphicCursorColors(White, Black);
+    display.SetGraphicCursorPosition(0, 0);
+    display.ShowGraphicCursor(true);
+    for (int x = 0; x < display.width() - 32; x += 2) {
+        display.SetGraphicCursorPosition(x, 40 + (x * (display.height() - 80)) / display.width());
+        wait_ms(delay);
+    }
+    display.ShowGraphicCursor(false);
+}
+
+
 void BacklightTest(RA8875 & display, Serial & pc, float ramptime)
 {
     char buf[60];
@@ -2596,6 +3296,70 @@ void BacklightTest2(RA8875 & display, Serial & pc)
 }
 
 
+void BacklightFadeTest(RA8875 & display, Serial & pc)
+{
+    Timer t;
+    int circles = 0;
+
+    if (!SuppressSlowStuff)
+        pc.printf("Backlight Fade Test\r\n");
+    display.Backlight_u8(0);
+    display.background(Black);
+    display.foreground(Blue);
+    display.cls();
+    display.puts("RA8875 Backlight Fade Test - drawing while fading.");
+
+    // The fades run from the Ticker, so the drawing here is never held up.
+    for (int curve = RA8875::FadeLinear; curve <= RA8875::FadeEaseInOut; curve++) {
+        display.BacklightFade((curve & 1) ? 32 : 255, 1000, (RA8875::FadeCurve_T)curve);
+        t.reset();
+        t.start();
+        while (display.IsBacklightFading()) {
+            display.fillcircle(rand() % display.width(), 20 + rand() % (display.height() - 20),
+                5 + rand() % 20, display.DOSColor(rand() % 16));
+            circles++;
+        }
+        t.stop();
+        pc.printf("  curve %d: %d ms, %d circles drawn during the fade\r\n", curve, t.read_ms(), circles);
+        circles = 0;
+    }
+    display.BacklightFade(255, 250);
+}
+
+
+void SleepTest(RA8875 & display, Serial & pc)
+{
+    RetCode_t r;
+
+    if (!SuppressSlowStuff)
+        pc.printf("Sleep Test\r\n");
+    display.background(Black);
+    display.foreground(Yellow);
+    display.cls();
+    display.puts("RA8875 Sleep Test - this screen is kept across the sleep.");
+    display.fillrect(50,50, 150,150, Blue);
+    wait(1);
+
+    // Deep sleep, and a resume with no repaint.
+    r = display.Sleep(RA8875::SleepDeep);
+    pc.printf("  deep sleep: %d; %s\r\n", r, display.GetErrorMessage(r));
+    wait(1);
+    display.Resume();
+    pc.printf("  deep sleep resume: %u usec\r\n", display.GetResumeTime());
+    wait(1);
+
+    // Standby, with layer 0 declared invalid, so it is repainted before it is shown.
+    r = display.Sleep(RA8875::SleepStandby, 0x02);
+    pc.printf("  standby: %d; %s\r\n", r, display.GetErrorMessage(r));
+    wait(1);
+    display.Resume();
+    display.fillrect(50,50, 150,150, Green);
+    display.Power(true);
+    pc.printf("  standby resume, with repaint: %u usec\r\n", display.GetResumeTime());
+    wait(1);
+}
+
+
 void ExternalFontTest(RA8875 & display, Serial & pc)
 {
     if (!SuppressSlowStuff)
@@ -2612,6 +3376,30 @@ void ExternalFontTest(RA8875 & display, Serial & pc)
     display.SelectUserFont(BPG_Arial20x20);
     display.puts("0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz\r\n");
 
+    // The second of each pair is drawn from the scaled glyph cache.
+    uint32_t hits, misses;
+    display.SelectUserFont(BPG_Arial08x08);
+    display.SetUserFontScale(2.0);
+    display.puts("Arial 8 at 2x, nearest. Arial 8 at 2x, nearest.\r\n");
+    display.SelectUserFont(BPG_Arial20x20);
+    display.SetUserFontScale(0.75, 0.75, RA8875::FontSmooth);
+    display.puts("Arial 20 at 0.75x, smooth. Arial 20 at 0.75x, smooth.\r\n");
+    display.SetUserFontScale();
+    uint32_t bytes = display.GetGlyphCacheStats(&hits, &misses);
+    if (!SuppressSlowStuff)
+        pc.printf("  glyph cache: %u hits, %u misses, %u bytes\r\n", hits, misses, bytes);
+    display.FlushGlyphCache();
+
+    // Too large for the cache, so each glyph is streamed as it is scaled.
+    display.SelectUserFont(BPG_Arial20x20);
+    display.SetUserFontScale(6.5, 6.5, RA8875::FontSmooth);
+    display.SetTextCursor(200, 120);
+    display.puts("Ag");
+    if (!SuppressSlowStuff)
+        pc.printf("  Arial 20 at 6.5x, uncached: advanced %d pixels, cache %u bytes\r\n",
+            display.GetTextCursor_X() - 200, display.GetGlyphCacheStats(NULL, NULL));
+    display.SetUserFontScale();
+
     display.SelectUserFont();
 
     display.puts("Normal font again.");
@@ -2619,6 +3407,810 @@ void ExternalFontTest(RA8875 & display, Serial & pc)
 }
 
 
+void OrientationSpeedTest(RA8875 & display, Serial & pc)
+{
+    LocalFileSystem local("local");
+    const char * names[] = { "normal", "rotate_90", "rotate_180", "rotate_270" };
+    color_t line[100];
+    Timer t;
+
+    pc.printf("Orientation Speed Test - msec for stream, text, bitmap\r\n");
+    for (int i = 0; i < 100; i++)
+        line[i] = RGB(i * 2, 255 - i * 2, 128);
+    for (int o = RA8875::normal; o <= RA8875::rotate_270; o++) {
+        int stream, text, bitmap;
+
+        display.SetOrientation((RA8875::orientation_t)o);
+        display.background(Black);
+        display.foreground(Blue);
+        display.cls();
+        t.reset();
+        t.start();
+        display.window(10,10, 100,100);     // 100 rows of 100, streamed contiguously
+        for (int y = 10; y < 110; y++)
+            display.pixelStream(line, 100, 10, y);
+        display.window();
+        stream = t.read_ms();
+        t.reset();
+        display.SelectUserFont(BPG_Arial08x08);  // booleanStream per glyph
+        display.puts(120,10, "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ\r\n");
+        display.puts("abcdefghijklmnopqrstuvwxyz\r\n");
+        display.SelectUserFont();
+        text = t.read_ms();
+        t.reset();
+        display.RenderImageFile(10,120, "/local/TestPat.bmp");
+        bitmap = t.read_ms();
+        t.stop();
+        pc.printf("  %-10s %5d %5d %5d\r\n", names[o], stream, text, bitmap);
+        if (!SuppressSlowStuff)
+            wait(2);
+    }
+    display.SetOrientation(RA8875::normal);
+}
+
+
+// Print what one step of the widget test cost, and start the next.
+static void WidgetCost(RA8875 & display, Serial & pc, Timer & t, const char * what)
+{
+#ifdef PERF_METRICS
+    pc.printf("  %-16s %6d usec %7u bytes\r\n", what, t.read_us(), display.GetBusBytes());
+    display.ClearPerformance();
+#else
+    (void)display;
+    pc.printf("  %-16s %6d usec\r\n", what, t.read_us());
+#endif
+    t.reset();
+}
+
+
+void WidgetTest(RA8875 & display, Serial & pc)
+{
+    static const char * const items[] = { "Red", "Green", "Blue", "Cyan", "Magenta", "Yellow" };
+    static color_t pixels[32 * 32];
+    char volumeText[20];
+    WidgetScreen ui(display, Black);
+    Label title(10, 10, 300, 24, "Widget Test", Label::AlignCenter);
+    Label volumeLabel(10, 44, 140, 20, "");
+    Slider volume(160, 40, 200, 24, 0, 100);
+    ProgressBar progress(10, 80, 350, 16, 100);
+    Button ok(10, 110, 100, 32, "OK");
+    ListBox list(160, 110, 200, 120, items, 6, 20);
+    Image icon(400, 10, 32, 32, pixels);
+    Timer t;
+
+    pc.printf("Widget Test - cost of a full redraw, and of each state change\r\n");
+    for (int i = 0; i < 32 * 32; i++)
+        pixels[i] = RGB((i % 32) * 8, (i / 32) * 8, 128);
+    title.SetColors(Yellow, Blue);
+    ok.SetColors(White, Gray);
+    ui.Add(&title);
+    ui.Add(&volumeLabel);
+    ui.Add(&volume);
+    ui.Add(&progress);
+    ui.Add(&ok);
+    ui.Add(&list);
+    ui.Add(&icon);
+    snprintf(volumeText, sizeof(volumeText), "Volume %3d", volume.GetValue());
+    volumeLabel.SetText(volumeText);
+#ifdef PERF_METRICS
+    display.ClearPerformance();
+#endif
+    t.start();
+    ui.Redraw();
+    WidgetCost(display, pc, t, "full redraw");
+    volume.SetValue(40);
+    snprintf(volumeText, sizeof(volumeText), "Volume %3d", volume.GetValue());
+    volumeLabel.SetText(volumeText);
+    ui.Update();
+    WidgetCost(display, pc, t, "slider + label");
+    progress.SetValue(progress.GetValue() + 5);
+    ui.Update();
+    WidgetCost(display, pc, t, "progress +5%");
+    list.Select(2);
+    ui.Update();
+    WidgetCost(display, pc, t, "list select");
+    list.Select(4);
+    ui.Update();
+    WidgetCost(display, pc, t, "list reselect");
+    ok.Touch(touch, ok.GetBounds().p1);
+    ui.Update();
+    WidgetCost(display, pc, t, "button press");
+    icon.Invalidate();
+    ui.Update();
+    WidgetCost(display, pc, t, "image");
+    for (int i = 0; i <= 100; i += 5) {
+        progress.SetValue(i);
+        ui.Update();
+    }
+    WidgetCost(display, pc, t, "21 progress steps");
+    for (int i = 0; i <= 100; i += 5) {
+        progress.SetValue(i);
+        ui.Redraw();
+    }
+    WidgetCost(display, pc, t, "same, full redraw");
+    t.stop();
+    if (!SuppressSlowStuff)
+        wait(2);
+}
+
+
+void StripChartTest(RA8875 & display, Serial & pc)
+{
+    StripChart chart(display, 10, 10, 400, 200, 2);
+    int wave, noise;
+    Timer t;
+
+    pc.printf("Strip Chart Test - cost per sample, and of a full redraw\r\n");
+    display.background(Black);
+    display.cls();
+    wave = chart.AddSeries(BrightGreen);
+    noise = chart.AddSeries(BrightRed);
+    chart.SetColors(White, Black);
+    chart.Draw(display, chart.GetBounds());
+#ifdef PERF_METRICS
+    display.ClearPerformance();
+#endif
+    t.start();
+    for (int i = 0; i < 400; i++) {
+        float v[2];
+
+        v[wave] = 50.0f * sin(i / 20.0f);
+        v[noise] = (float)(rand() % 40) - 20.0f + ((i > 200) ? 60.0f : 0.0f);   // the step rescales
+        chart.AddSample(v);
+    }
+    WidgetCost(display, pc, t, "400 samples");
+    pc.printf("  %u rescales\r\n", chart.GetRescaleCount());
+    chart.SetDecimation(8);                 // 8 samples per column, drawn as min to max
+    for (int i = 0; i < 400 * 8; i++) {
+        float v[2] = { 50.0f * sin(i / 160.0f), (float)(rand() % 40) + 40.0f };
+
+        chart.AddSample(v);
+    }
+    WidgetCost(display, pc, t, "3200 samples / 8");
+    display.window(chart.GetBounds());
+    chart.Draw(display, chart.GetBounds());
+    display.window();
+    WidgetCost(display, pc, t, "full redraw");
+    t.stop();
+    if (!SuppressSlowStuff)
+        wait(2);
+}
+
+
+void GaugeTest(RA8875 & display, Serial & pc)
+{
+    Gauge dial(display, 20, 20, 200, 0, 100, 10);
+    Timer t;
+
+    pc.printf("Gauge Test - cost of the face, of a full redraw, and per update\r\n");
+    display.SelectDrawingLayer(0);
+    display.SetLayerMode(RA8875::ShowLayer0);
+    display.background(Black);
+    display.cls();
+    dial.SetColors(White, Blue);
+#ifdef PERF_METRICS
+    display.ClearPerformance();
+#endif
+    t.start();
+    dial.Draw(display, dial.GetBounds());       // renders the face into layer 2 first
+    display.window();
+    WidgetCost(display, pc, t, "face and needle");
+    dial.Draw(display, dial.GetBounds());
+    display.window();
+    WidgetCost(display, pc, t, "full redraw");
+    for (int v = 0; v <= 100; v++)
+        dial.SetValue(v);
+    WidgetCost(display, pc, t, "101 updates");
+    for (int v = 100; v >= 0; v -= 2) {
+        dial.SetValue(v);
+        dial.Draw(display, dial.GetBounds());
+    }
+    display.window();
+    WidgetCost(display, pc, t, "51 full redraws");
+    t.stop();
+    if (!SuppressSlowStuff)
+        wait(2);
+}
+
+
+void KeyboardTest(RA8875 & display, Serial & pc)
+{
+    Keyboard kb(display, 0, 136, 480, 136);
+    point_t p = { 24, 150 };                // the 'q' key
+    Timer t;
+
+    pc.printf("Keyboard Test - cost of a full draw, a key press and release, and a layout\r\n");
+    display.SelectDrawingLayer(0);
+    display.SetLayerMode(RA8875::ShowLayer0);
+    display.background(Black);
+    display.cls();
+    kb.SetColors(White, Gray);
+#ifdef PERF_METRICS
+    display.ClearPerformance();
+#endif
+    t.start();
+    kb.Draw(display, kb.GetBounds());       // renders both images into layer 2 first
+    display.window();
+    WidgetCost(display, pc, t, "render and draw");
+    kb.Draw(display, kb.GetBounds());
+    display.window();
+    WidgetCost(display, pc, t, "full draw");
+    kb.Touch(touch, p);
+    WidgetCost(display, pc, t, "press");
+    p.x += 48;                              // slide to 'e'
+    kb.Touch(held, p);
+    WidgetCost(display, pc, t, "slide");
+    kb.Touch(release, p);
+    WidgetCost(display, pc, t, "release");
+    kb.SetLayout(Keyboard::Numeric);
+    WidgetCost(display, pc, t, "layout");
+    t.stop();
+    if (!SuppressSlowStuff)
+        wait(2);
+}
+
+
+static const char * ListViewLine(int index)
+{
+    static char buf[24];
+
+    snprintf(buf, sizeof(buf), "Log entry %5d", index);
+    return buf;
+}
+
+
+static dim_t ListViewHeight(int index)
+{
+    return (index % 7 == 0) ? 32 : 20;      // every seventh row is a heading
+}
+
+
+void ListViewTest(RA8875 & display, Serial & pc)
+{
+    ListView list(display, 40, 10, 400, 252, 5000, ListViewLine);
+    point_t p = { 200, 200 };
+    Timer t;
+
+    pc.printf("List View Test - 5000 rows of variable height\r\n");
+    display.background(Black);
+    display.cls();
+    list.SetColors(White, Blue);
+    list.SetHeights(ListViewHeight);
+#ifdef PERF_METRICS
+    display.ClearPerformance();
+#endif
+    t.start();
+    list.Draw(display, list.GetBounds());
+    display.window();
+    WidgetCost(display, pc, t, "full draw");
+    for (int i = 0; i < 100; i++)
+        list.ScrollBy(3);
+    WidgetCost(display, pc, t, "100 x 3 pixels");
+    list.ScrollTo(60000);                   // far away, so a full draw
+    WidgetCost(display, pc, t, "jump");
+    list.ShowItem(4999);
+    WidgetCost(display, pc, t, "to the end");
+    list.Touch(touch, p);                   // a flick toward the start
+    for (int i = 0; i < 5; i++) {
+        wait_ms(10);
+        p.y += 15;
+        list.Touch(held, p);
+    }
+    list.Touch(release, p);
+    while (list.Animate())
+        wait_ms(5);
+    WidgetCost(display, pc, t, "flick");
+    pc.printf("  scrolled to %d\r\n", list.GetScroll());
+    t.stop();
+    if (!SuppressSlowStuff)
+        wait(2);
+}
+
+
+void OverlayTest(RA8875 & display, Serial & pc)
+{
+    OverlayLayer ui(display);
+    int popup, toast;
+    Timer t;
+
+    pc.printf("Overlay Test - cost of popup show and hide, against a repaint\r\n");
+    display.SelectDrawingLayer(0);
+    display.background(Black);
+    display.cls(3);
+    for (int i = 0; i < 40; i++)            // content, which must not be repainted
+        display.fillcircle(rand() % 480, rand() % 272, 10 + rand() % 30, display.DOSColor(i % 16));
+    if (ui.Begin() != noerror) {
+        pc.printf("  needs two layers\r\n");
+        return;
+    }
+    popup = ui.Create(140, 80, 200, 100);
+    toast = ui.Create(40, 230, 400, 30);
+    ui.BeginPaint(popup);
+    display.fillroundrect(140,80, 339,179, 8,8, Blue);
+    display.foreground(White);
+    display.background(Blue);
+    display.puts(180, 120, "Popup");
+    ui.EndPaint();
+    ui.BeginPaint(toast);
+    display.fillrect(40,230, 439,259, Gray);
+    display.foreground(Black);
+    display.background(Gray);
+    display.puts(60, 237, "Toast");
+    ui.EndPaint();
+#ifdef PERF_METRICS
+    display.ClearPerformance();
+#endif
+    t.start();
+    ui.Show(popup);
+    WidgetCost(display, pc, t, "popup show");
+    wait_ms(500);
+    t.reset();
+    ui.Hide(popup);
+    WidgetCost(display, pc, t, "popup hide");
+    ui.Show(popup);
+    ui.Show(toast);
+    WidgetCost(display, pc, t, "show both");
+    ui.Hide(toast);
+    WidgetCost(display, pc, t, "hide one of two");
+    ui.Hide(popup);
+
+    // The average of many show and hide cycles, alone, where it is a mode
+    // switch, and over another, where the hide is a clear of its rect.
+    for (int over = 0; over < 2; over++) {
+        if (over)
+            ui.Show(toast);
+#ifdef PERF_METRICS
+        display.ClearPerformance();
+#endif
+        t.reset();
+        for (int i = 0; i < 20; i++) {
+            ui.Show(popup);
+            ui.Hide(popup);
+        }
+#ifdef PERF_METRICS
+        pc.printf("  %-16s %6d usec %7u bytes per show and hide\r\n", (over) ? "cycle over toast" : "cycle alone",
+            t.read_us() / 20, display.GetBusBytes() / 20);
+#else
+        pc.printf("  %-16s %6d usec per show and hide\r\n", (over) ? "cycle over toast" : "cycle alone",
+            t.read_us() / 20);
+#endif
+        if (over)
+            ui.Hide(toast);
+    }
+    t.reset();
+    ui.ShowFor(toast, 1000);
+    t.reset();
+    while (ui.IsShown(toast))
+        ui.Poll();
+    pc.printf("  toast hid after %d msec\r\n", t.read_ms());
+#ifdef PERF_METRICS
+    display.ClearPerformance();
+#endif
+    t.reset();
+    display.fillroundrect(140,80, 339,179, 8,8, Blue);      // the same popup, without the layer
+    display.window(140,80, 200,100);
+    display.cls();
+    for (int i = 0; i < 40; i++)            // stands in for repainting what was beneath
+        display.fillcircle(rand() % 480, rand() % 272, 10 + rand() % 30, display.DOSColor(i % 16));
+    display.window();
+    WidgetCost(display, pc, t, "paint and repaint");
+    t.stop();
+    display.SetLayerMode(RA8875::ShowLayer0);
+    if (!SuppressSlowStuff)
+        wait(2);
+}
+
+
+static void FrameLabel(RA8875 & display, void * context)
+{
+    display.foreground(White);
+    display.background(Blue);
+    display.puts(60, 100, (const char *)context);
+}
+
+
+void DeferredFrameTest(RA8875 & display, Serial & pc)
+{
+    static color_t tile[40 * 40];
+    DeferredFrame frame(display);
+    rect_t panel = { { 40, 80 }, { 439, 191 } };
+    Timer t;
+
+    pc.printf("Deferred Frame Test - a wallpaper of tiles, mostly under a panel\r\n");
+    for (int i = 0; i < 40 * 40; i++)
+        tile[i] = display.DOSColor((i / 40 + i % 40) / 5 % 16);
+    display.background(Black);
+    display.cls();
+#ifdef PERF_METRICS
+    display.ClearPerformance();
+#endif
+    t.start();
+    for (int pass = 0; pass < 2; pass++) {
+        frame.ClearStats();
+        if (pass)
+            frame.Begin();
+        for (loc_t y = 0; y < 240; y += 40) {
+            for (loc_t x = 0; x < 480; x += 40) {
+                rect_t r = { { x, y }, { (loc_t)(x + 39), (loc_t)(y + 39) } };
+
+                frame.Image(r, tile);
+            }
+        }
+        frame.FillRect(panel, Blue);
+        frame.Draw(panel, FrameLabel, (void *)"Only what shows is sent", false, 200);
+        if (pass)
+            frame.End();
+        WidgetCost(display, pc, t, (pass) ? "deferred" : "direct");
+    }
+    t.stop();
+    pc.printf("  %u draws, %u culled, %u clipped, %u bytes culled of %u\r\n",
+        frame.GetStats().draws, frame.GetStats().culled, frame.GetStats().clipped,
+        frame.GetStats().culledBytes, frame.GetStats().bytes + frame.GetStats().culledBytes);
+    if (!SuppressSlowStuff)
+        wait(2);
+}
+
+
+void ClearRectsTest(RA8875 & display, Serial & pc)
+{
+    rect_t cells[12];
+    Timer t;
+
+    pc.printf("Clear Rects Test - 12 cells, batched, one at a time, and all\r\n");
+    for (int i = 0; i < 12; i++) {
+        cells[i].p1.x = 20 + (i % 4) * 115;
+        cells[i].p1.y = 20 + (i / 4) * 80;
+        cells[i].p2.x = cells[i].p1.x + 99;
+        cells[i].p2.y = cells[i].p1.y + 59;
+    }
+    display.background(Black);
+    display.cls();
+    for (int pass = 0; pass < 3; pass++) {
+        for (int i = 0; i < 12; i++)
+            display.fillrect(cells[i], display.DOSColor(i + 1));
+        display.background(Blue);
+#ifdef PERF_METRICS
+        display.ClearPerformance();
+#endif
+        t.reset();
+        t.start();
+        if (pass == 0) {
+            display.clsRects(cells, 12);
+        } else if (pass == 1) {
+            for (int i = 0; i < 12; i++) {
+                display.window(cells[i]);
+                display.clsw(RA8875::ACTIVEWINDOW);
+            }
+            display.window();
+        } else {
+            display.cls();
+        }
+        WidgetCost(display, pc, t, (pass == 0) ? "clsRects" : (pass == 1) ? "window + clsw" : "cls");
+        display.background(Black);
+        if (!SuppressSlowStuff)
+            wait_ms(500);
+    }
+    t.stop();
+}
+
+
+void SmallBlitTest(RA8875 & display, Serial & pc)
+{
+    static const uint8_t sprite[8] = { 0x3C, 0x42, 0xA5, 0x81, 0xA5, 0x99, 0x42, 0x3C };
+    color_t row[8];
+    Timer t;
+
+    pc.printf("Small Blit Test - the setup of many small blits\r\n");
+    for (int i = 0; i < 8; i++)
+        row[i] = display.DOSColor(i + 8);
+    display.background(Black);
+    display.cls();
+#ifdef PERF_METRICS
+    display.ClearPerformance();
+#endif
+    t.start();
+    display.foreground(BrightGreen);
+    for (int i = 0; i < 400; i++)
+        display.booleanStream((i % 40) * 12, (i / 40) * 12, 8, 8, sprite);
+    WidgetCost(display, pc, t, "400 8x8 sprites");
+    for (int i = 0; i < 400; i++)
+        display.pixelStream(row, 8, (i % 40) * 12, 130 + (i / 40) * 12);
+    WidgetCost(display, pc, t, "400 8-pixel rows");
+    t.stop();
+    if (!SuppressSlowStuff)
+        wait(2);
+}
+
+
+void StreamDirectionTest(RA8875 & display, Serial & pc)
+{
+    static const char * const names[4] = { "left-right, top-bottom", "right-left, top-bottom",
+        "top-bottom, left-right", "bottom-top, left-right" };
+    color_t pixels[64];
+    loc_t x = 100, y = 100;
+
+    pc.printf("Stream Direction Test - stream 8x8 in each order, and read it back\r\n");
+    if (display.color_bpp() != 16) {
+        pc.printf("  needs 16-bit color, to compare the pixels\r\n");
+        return;
+    }
+    for (int k = 0; k < 64; k++)
+        pixels[k] = RGB(k * 4, 255 - k * 4, (k & 7) * 32);
+    display.background(Black);
+    display.cls();
+    for (int d = 0; d < 4; d++) {
+        RA8875::direction_t dir = (RA8875::direction_t)d;
+        loc_t sx = (dir == RA8875::RightLeftTopBottom) ? x + 7 : x;
+        loc_t sy = (dir == RA8875::BottomTopLeftRight) ? y + 7 : y;
+        int errors = 0;
+
+        display.SetWriteDirection(dir);
+        display.window(x, y, 8, 8);
+        display.pixelStream(pixels, 64, sx, sy);
+        display.window();
+        display.SetWriteDirection(RA8875::LeftRightTopBottom);
+        for (int k = 0; k < 64; k++) {
+            int col = k % 8, row = k / 8;           // where pixel k belongs
+            loc_t px, py;
+
+            switch (dir) {
+                default:
+                case RA8875::LeftRightTopBottom: px = col;     py = row;     break;
+                case RA8875::RightLeftTopBottom: px = 7 - col; py = row;     break;
+                case RA8875::TopBottomLeftRight: px = row;     py = col;     break;
+                case RA8875::BottomTopLeftRight: px = row;     py = 7 - col; break;
+            }
+            color_t c = display.getPixel(x + px, y + py);       // which is byte-swapped
+
+            if ((color_t)((c << 8) | (c >> 8)) != pixels[k])
+                errors++;
+        }
+        pc.printf("  %-24s %s (%d of 64 wrong)\r\n", names[d], (errors) ? "FAIL" : "pass", errors);
+        x += 20;
+    }
+    if (!SuppressSlowStuff)
+        wait(2);
+}
+
+
+void ReadRectTest(RA8875 & display, Serial & pc)
+{
+    static color_t rows[64 * 48];
+    static color_t rect[64 * 48];
+    rect_t r = { { 200, 100 }, { 263, 147 } };
+    int differ = 0;
+    Timer t;
+
+    pc.printf("Read Rect Test - 64x48 by rows, and in one burst\r\n");
+    display.background(Black);
+    display.cls();
+    for (int i = 0; i < 30; i++)
+        display.fillcircle(180 + rand() % 120, 80 + rand() % 90, 5 + rand() % 20, display.DOSColor(i % 16));
+#ifdef PERF_METRICS
+    display.ClearPerformance();
+#endif
+    t.start();
+    for (int j = 0; j < 48; j++)
+        display.getPixelStream(rows + j * 64, 64, r.p1.x, r.p1.y + j);
+    WidgetCost(display, pc, t, "48 row reads");
+    display.getPixelRect(rect, r);
+    WidgetCost(display, pc, t, "one rect read");
+    t.stop();
+    for (int i = 0; i < 64 * 48; i++) {
+        if ((color_t)((rows[i] << 8) | (rows[i] >> 8)) != rect[i])     // getPixelStream is byte-swapped
+            differ++;
+    }
+    pc.printf("  %d pixels differ\r\n", differ);
+    display.window(20, 100, 64, 48);            // show the copy
+    display.pixelStream(rect, 64 * 48, 20, 100);
+    display.window();
+    if (!SuppressSlowStuff)
+        wait(2);
+}
+
+
+void WireStreamTest(RA8875 & display, Serial & pc)
+{
+    static color_t host[64 * 48];
+    static uint8_t wire[2 * 64 * 48];
+    static uint8_t wire8[64 * 48];
+    static color_t back[64 * 48];
+    static const char * const names[3] = { "host order", "wire order", "wire RGB332" };
+    PixelBuffer_T bufs[3] = {
+        { host, 64 * 48, HostRGB565 },
+        { wire, 64 * 48, WireRGB565 },
+        { wire8, 64 * 48, WireRGB332 }
+    };
+    Timer t;
+
+    pc.printf("Wire Stream Test - 64x48 from a buffer in each format, read back to compare\r\n");
+    for (int j = 0; j < 48; j++)
+        for (int i = 0; i < 64; i++)
+            host[j * 64 + i] = RGB(i * 4, j * 5, 255 - i * 4);
+    RGB565ToWire(wire, host, 64 * 48);
+    RGB565ToRGB332(wire8, host, 64 * 48);
+    display.background(Black);
+    display.cls();
+#ifdef PERF_METRICS
+    display.ClearPerformance();
+#endif
+    t.start();
+    for (int k = 0; k < 3; k++) {
+        loc_t x = 20 + k * 150;
+        rect_t r = { { x, 100 }, { (loc_t)(x + 63), 147 } };
+        int differ = 0;
+
+        display.window(x, 100, 64, 48);
+        display.pixelStream(bufs[k], x, 100);
+        display.window();
+        WidgetCost(display, pc, t, names[k]);
+        display.getPixelRect(back, r);
+        for (int i = 0; i < 64 * 48; i++) {
+            color_t expect = (k == 2) ? RGB332To565(wire8[i]) : host[i];
+
+            if (display.color_bpp() == 8)
+                expect = RGB332To565(RGB565To332(expect));
+            if (back[i] != expect)
+                differ++;
+        }
+        t.reset();
+        pc.printf("  %d pixels differ\r\n", differ);
+    }
+    t.stop();
+    if (!SuppressSlowStuff)
+        wait(2);
+}
+
+
+static int yieldCount;
+static int yieldAbortAt;
+
+static RetCode_t YieldTestHandler(RA8875::IdleReason_T reason)
+{
+    if (reason < RA8875::image_yield)
+        return noerror;             // the waits on the display are not counted
+    if (++yieldCount == yieldAbortAt)
+        return external_abort;
+    return noerror;
+}
+
+void YieldTest(RA8875 & display, Serial & pc)
+{
+    static uint8_t mask[200 * 100];
+    point_t p1 = { 10, 10 }, p2 = { 470, 260 };
+    RetCode_t r;
+
+    pc.printf("Yield Test - long operations yield every 2 msec, then one is stopped\r\n");
+    for (int i = 0; i < 200 * 100; i++)
+        mask[i] = (uint8_t)(i * 7);
+    display.background(Black);
+    display.cls();
+    display.AttachIdleHandler(YieldTestHandler);
+    display.SetYieldBudget(2000);
+    yieldAbortAt = 0;
+    for (int k = 0; k < 2; k++) {
+        yieldCount = 0;
+        display.ClearYieldStats();
+        if (k == 0)
+            r = display.ThickLine(p1, p2, 9, BrightBlue);
+        else
+            r = display.AlphaBlit(140, 80, 200, 100, mask, Yellow, RA8875::BlendOverScreen);
+        pc.printf("  %-10s %3d yields, most %5u usec apart, returned %d\r\n", (k == 0) ? "ThickLine" : "AlphaBlit",
+            yieldCount, display.GetYieldStats().maxGap, r);
+    }
+    yieldCount = 0;
+    yieldAbortAt = 3;
+    p1.y = 260; p2.y = 10;
+    r = display.ThickLine(p1, p2, 9, BrightRed);
+    pc.printf("  stopped at the 3rd yield: returned %d, expected %d\r\n", r, external_abort);
+    display.SetYieldBudget();
+    display.AttachIdleHandler();
+    if (!SuppressSlowStuff)
+        wait(2);
+}
+
+
+void AlphaBlitTest(RA8875 & display, Serial & pc)
+{
+    static uint8_t mask[120 * 60];
+    static const char * const names[3] = { "over a color", "over layer 1", "over the screen" };
+    Timer t;
+
+    pc.printf("Alpha Blit Test - a translucent panel, from each source of the pixels beneath\r\n");
+    for (int j = 0; j < 60; j++)                // opaque in the middle, fading to the edges
+        for (int i = 0; i < 120; i++) {
+            int e = min(min(i, 119 - i), min(j, 59 - j)) * 16;
+
+            mask[j * 120 + i] = (e > 160) ? 160 : e;
+        }
+    display.SelectDrawingLayer(0);
+    display.background(Black);
+    display.cls(3);
+    for (int i = 0; i < 30; i++) {
+        loc_t cx = rand() % 480, cy = rand() % 272;
+        dim_t r = 5 + rand() % 25;
+        color_t c = display.DOSColor(i % 16);
+
+        display.fillcircle(cx, cy, r, c);
+        display.SelectDrawingLayer(1);          // a copy, for BlendOverLayer
+        display.fillcircle(cx, cy, r, c);
+        display.SelectDrawingLayer(0);
+    }
+#ifdef PERF_METRICS
+    display.ClearPerformance();
+#endif
+    t.start();
+    for (int k = 0; k < 3; k++) {
+        display.AlphaBlit(20 + k * 150, 100, 120, 60, mask, White, (RA8875::BlendUnder_T)k, Black, 1);
+        WidgetCost(display, pc, t, names[k]);
+    }
+    t.stop();
+    if (!SuppressSlowStuff)
+        wait(2);
+}
+
+
+void ColorConvertTest(RA8875 &, Serial & pc)
+{
+    static uint8_t rgb[480 * 3 + 3], out8[480 * 3 + 3];
+    static color_t c16[480], out16[480];
+    int fail = 0;
+    Timer t;
+
+    pc.printf("Color Convert Test - every color through the round trips, then the spans timed\r\n");
+    for (uint32_t c = 0; c < 65536; c++) {          // widen then narrow is lossless
+        color_t in = (color_t)c, back;
+        uint8_t q[3];
+
+        RGB565ToRGB888(q, &in, 1);
+        RGB888ToRGB565(&back, q, 1);
+        if (back != in || RGB888To565(q[0], q[1], q[2]) != RGB(q[0], q[1], q[2]))
+            fail++;
+    }
+    for (int c = 0; c < 256; c++)
+        if (RGB565To332(RGB332To565(c)) != c)
+            fail++;
+    for (int i = 0; i < 480 * 3 + 3; i++)
+        rgb[i] = rand();
+    for (int i = 0; i < 480; i++)
+        c16[i] = rand();
+    for (uint32_t n = 0; n < 9; n++) {              // the word loops against the scalar tails
+        RGB888ToRGB565(out16, rgb + 1, n);          // and from an unaligned source
+        RGB565ToRGB332(out8, c16, n);
+        for (uint32_t i = 0; i < n; i++)
+            if (out16[i] != RGB888To565(rgb[1 + 3 * i], rgb[2 + 3 * i], rgb[3 + 3 * i])
+            || out8[i] != RGB565To332(c16[i]))
+                fail++;
+    }
+    pc.printf("  %d failures\r\n", fail);
+
+    static const char * const names[8] = {
+        "888 to 565", "BGR888 to 565", "565 to 888", "565 to BGR888",
+        "565 to 332", "332 to 565", "swap red, blue", "swap bytes"
+    };
+    for (int k = 0; k < 8; k++) {
+        t.reset();
+        t.start();
+        for (int r = 0; r < 100; r++) {
+            switch (k) {
+                case 0: RGB888ToRGB565(out16, rgb, 480); break;
+                case 1: BGR888ToRGB565(out16, rgb, 480); break;
+                case 2: RGB565ToRGB888(out8, c16, 480); break;
+                case 3: RGB565ToBGR888(out8, c16, 480); break;
+                case 4: RGB565ToRGB332(out8, c16, 480); break;
+                case 5: RGB332ToRGB565(out16, rgb, 480); break;
+                case 6: SwapRedBlue888(out8, rgb, 480); break;
+                case 7: SwapColorBytes(out16, c16, 480); break;
+            }
+        }
+        t.stop();
+        int us = t.read_us();                       // pixels per cycle, from the core clock
+        float perCycle = (us > 0) ? 48000.0f / ((float)us * (SystemCoreClock / 1000000)) : 0.0f;
+        pc.printf("  %-15s %5d uSec for 48000 pixels, %5.3f pixels per cycle\r\n", names[k], us, perCycle);
+    }
+}
+
+
 void DOSColorTest(RA8875 & display, Serial & pc)
 {
     if (!SuppressSlowStuff)
@@ -3114,6 +4706,16 @@ void RunTestSet(RA8875 & lcd, Serial & pc)
                   "K - Keypad Test       s - touch screen test\r\n"
                   "p - print screen      r - reset  \r\n"
                   "l - layer test        w - wrapping text \r\n"
+                  "M - graphic cursor (Mouse pointer)  f - backlight fade\r\n"
+                  "z - sleep and resume  o - orientation speed\r\n"
+                  "u - widget redraw cost  c - strip chart\r\n"
+                  "g - gauge             k - virtual keyboard\r\n"
+                  "v - list view         y - overlay popups\r\n"
+                  "d - deferred frame    x - clear rects\r\n"
+                  "h - small blit setup  j - stream directions\r\n"
+                  "e - read a rectangle  a - alpha blit\r\n"
+                  "n - color conversion  i - wire order stream\r\n"
+                  "Y - yield points\r\n"
 #ifdef PERF_METRICS
                   "0 - clear performance 1 - report performance\r\n"
 #endif
@@ -3144,12 +4746,69 @@ void RunTestSet(RA8875 & lcd, Serial & pc)
             case 'b':
                 BacklightTest2(lcd, pc);
                 break;
+            case 'f':
+                BacklightFadeTest(lcd, pc);
+                break;
+            case 'z':
+                SleepTest(lcd, pc);
+                break;
+            case 'o':
+                OrientationSpeedTest(lcd, pc);
+                break;
+            case 'u':
+                WidgetTest(lcd, pc);
+                break;
+            case 'c':
+                StripChartTest(lcd, pc);
+                break;
+            case 'g':
+                GaugeTest(lcd, pc);
+                break;
+            case 'k':
+                KeyboardTest(lcd, pc);
+                break;
+            case 'v':
+                ListViewTest(lcd, pc);
+                break;
+            case 'y':
+                OverlayTest(lcd, pc);
+                break;
+            case 'd':
+                DeferredFrameTest(lcd, pc);
+                break;
+            case 'x':
+                ClearRectsTest(lcd, pc);
+                break;
+            case 'h':
+                SmallBlitTest(lcd, pc);
+                break;
+            case 'j':
+                StreamDirectionTest(lcd, pc);
+                break;
+            case 'e':
+                ReadRectTest(lcd, pc);
+                break;
+            case 'a':
+                AlphaBlitTest(lcd, pc);
+                break;
+            case 'n':
+                ColorConvertTest(lcd, pc);
+                break;
+            case 'i':
+                WireStreamTest(lcd, pc);
+                break;
+            case 'Y':
+                YieldTest(lcd, pc);
+                break;
             case 'D':
                 DOSColorTest(lcd, pc);
                 break;
             case 'K':
                 KeyPadTest(lcd, pc);
                 break;
+            case 'M':
+                GraphicCursorTest(lcd, pc);
+                break;
             case 'W':
                 WebColorTest(lcd, pc);
                 break;
@@ -72,9 +72,28 @@
 
 #include "RA8875_Regs.h"
 #include "GraphicsDisplay.h"
+#include "SPIBus.h"
 
 #define RA8875_DEFAULT_SPI_FREQ 5000000
 
+// The scaled glyph cache, for external fonts. See SetUserFontScale.
+#ifndef RA8875_GLYPH_CACHE_ENTRIES
+#define RA8875_GLYPH_CACHE_ENTRIES 48       /* most glyphs held at once */
+#endif
+#ifndef RA8875_GLYPH_CACHE_BYTES
+#define RA8875_GLYPH_CACHE_BYTES 6144       /* most RAM held by the glyphs */
+#endif
+
+// The pixels that AlphaBlit blends at a time, held on the stack.
+#ifndef RA8875_ALPHA_CHUNK
+#define RA8875_ALPHA_CHUNK 128
+#endif
+
+// The pixels that a stream converts to wire order at a time, held on the stack.
+#ifndef RA8875_WIRE_CHUNK
+#define RA8875_WIRE_CHUNK 32
+#endif
+
 // Define this to enable code that monitors the performance of various
 // graphics commands.
 //#define PERF_METRICS
@@ -114,6 +133,84 @@
 #define max(a,b) ((a>b)?a:b)
 
 
+/// Pseudo-register used in a packed register table to insert a delay.
+///
+/// The RA8875 has no register at this address, so an entry of
+/// { RA8875_REG_DELAY, n } in a table means "wait n milliseconds".
+/// See @ref RA8875_PANEL_REGS.
+///
+#define RA8875_REG_DELAY    0xFF
+
+/// Size, in bytes, of the register state that is captured by @ref RA8875::Sleep.
+///
+/// This is checked at compile time against the registers that are captured,
+/// and has room for a few more.
+///
+#define RA8875_SLEEP_TABLE  168
+
+/// Generate the packed register table for a panel profile.
+///
+/// This expands at compile time to a brace-enclosed list of
+/// (register, value) pairs, covering the PLL, color depth, pixel clock,
+/// horizontal and vertical timing and the layer configuration, so that
+/// the panel setup lives in flash and is streamed to the controller by
+/// @ref RA8875::init(const PanelProfile_T &, uint8_t, bool, bool, const rect_t *)
+/// without any computation or branching at boot.
+///
+/// @code
+/// static const uint8_t MyPanelRegs[] = RA8875_PANEL_REGS(800, 480, 8, 2,
+///     0x0C, 0x02, 0x81, 0x00, 0x03, 0x03, 0x0B, 0x0020, 0x0016, 0x01);
+/// static const RA8875::PanelProfile_T MyPanel = RA8875_PANEL_PROFILE(800, 480, 8, 2, MyPanelRegs);
+/// ...
+///     lcd.init(MyPanel);
+/// @endcode
+///
+/// @param[in] width in pixels.
+/// @param[in] height in pixels.
+/// @param[in] bpp is the color depth, 8 or 16.
+/// @param[in] layers is the number of layers, 1 or 2.
+/// @param[in] pllc1 is the PLL control register 1 value (0x88).
+/// @param[in] pllc2 is the PLL control register 2 value (0x89).
+/// @param[in] pcsr is the pixel clock setting register value (0x04).
+/// @param[in] hndftr is the horizontal non-display period fine tune (0x15).
+/// @param[in] hndr is the horizontal non-display period (0x16).
+/// @param[in] hstr is the HSYNC start position (0x17).
+/// @param[in] hpwr is the HSYNC polarity and pulse width (0x18).
+/// @param[in] vndr is the 9-bit vertical non-display period (0x1B, 0x1C).
+/// @param[in] vstr is the 9-bit VSYNC start position (0x1D, 0x1E).
+/// @param[in] vpwr is the VSYNC polarity and pulse width (0x1F).
+///
+#define RA8875_PANEL_REGS(width, height, bpp, layers, pllc1, pllc2, pcsr, \
+        hndftr, hndr, hstr, hpwr, vndr, vstr, vpwr) { \
+    0x88, (pllc1),                                  /* PLLC1 */ \
+    RA8875_REG_DELAY, 1,                            \
+    0x89, (pllc2),                                  /* PLLC2 */ \
+    RA8875_REG_DELAY, 1,                            \
+    0x10, (uint8_t)(((bpp) == 16) ? 0x0C : 0x00),   /* SYSR */ \
+    0x04, (pcsr),                                   /* PCSR */ \
+    RA8875_REG_DELAY, 1,                            \
+    0x14, (uint8_t)((width)/8 - 1),                 /* HDWR */ \
+    0x15, (hndftr),                                 /* HNDFTR */ \
+    0x16, (hndr),                                   /* HNDR */ \
+    0x17, (hstr),                                   /* HSTR */ \
+    0x18, (hpwr),                                   /* HPWR */ \
+    0x19, (uint8_t)(((height)-1) & 0xFF),           /* VDHR0 */ \
+    0x1A, (uint8_t)(((height)-1) >> 8),             /* VDHR1 */ \
+    0x1B, (vndr) & 0xFF,                            /* VNDR0 */ \
+    0x1C, (vndr) >> 8,                              /* VNDR1 */ \
+    0x1D, (vstr) & 0xFF,                            /* VSTR0 */ \
+    0x1E, (vstr) >> 8,                              /* VSTR1 */ \
+    0x1F, (vpwr),                                   /* VPWR */ \
+    0x20, (uint8_t)(((layers) == 2) ? 0x80 : 0x00)  /* DPCR */ \
+    }
+
+/// Generate the initializer for a @ref RA8875::PanelProfile_T from a
+/// table created with @ref RA8875_PANEL_REGS.
+///
+#define RA8875_PANEL_PROFILE(width, height, bpp, layers, regTable) \
+    { (dim_t)(width), (dim_t)(height), (uint8_t)(bpp), (uint8_t)(layers), (regTable), sizeof(regTable)/2 }
+
+
 /// FT5206 definitions follow
 #define FT5206_I2C_FREQUENCY                400000
 
@@ -286,6 +383,15 @@ public:
         rotate_270,     ///< rotated clockwise 270 degree
     } orientation_t;
 
+    /// the order in which a stream of pixels fills the window
+    typedef enum
+    {
+        LeftRightTopBottom,     ///< rows, from the top left (the default)
+        RightLeftTopBottom,     ///< rows mirrored, from the top right
+        TopBottomLeftRight,     ///< columns, from the top left
+        BottomTopLeftRight,     ///< columns upward, from the bottom left
+    } direction_t;
+
     /// alignment
     typedef enum
     {
@@ -376,9 +482,20 @@ public:
         command_wait,       ///< driver is polling the command register while busy
         getc_wait,          ///< user has called the getc function
         touch_wait,         ///< user has called the touch function
-        touchcal_wait       ///< driver is performing a touch calibration
+        touchcal_wait,      ///< driver is performing a touch calibration
+        image_yield,        ///< a yield point while rendering a bitmap or jpeg image
+        capture_yield,      ///< a yield point while writing a PrintScreen capture
+        draw_yield          ///< a yield point in a long drawing, such as ThickLine or AlphaBlit
     } IdleReason_T;
 
+    /// Statistics of the yield points, since @ref ClearYieldStats.
+    /// @see SetYieldBudget.
+    typedef struct
+    {
+        uint32_t yields;    ///< times the idle callback was called at a yield point
+        uint32_t maxGap;    ///< most uSec between yields, or from the start of an operation to its first
+    } YieldStats_T;
+
     /// Idle Callback
     ///
     /// This defines the interface for an idle callback. That is, when the
@@ -411,6 +528,97 @@ public:
     ///
     typedef RetCode_t (* IdleCallback_T)(IdleReason_T reason);
 
+    /// The easing curve of a backlight fade. See @ref BacklightFade.
+    typedef enum
+    {
+        FadeLinear,         ///< constant rate of change
+        FadeEaseIn,         ///< starts slowly, finishes quickly
+        FadeEaseOut,        ///< starts quickly, finishes slowly
+        FadeEaseInOut       ///< starts and finishes slowly
+    } FadeCurve_T;
+
+    /// Backlight schedule callback, for ambient light or time of day control.
+    ///
+    /// This is called periodically, once installed with @ref AttachBacklightSchedule.
+    /// It returns the brightness that the backlight should have now, and
+    /// when that differs from the present target, a fade to it begins.
+    ///
+    /// @attention This is called from interrupt context, so it must be
+    ///     brief and it must not call any of the display APIs. Sampling
+    ///     an analog light sensor is a typical use.
+    ///
+    /// @code
+    /// AnalogIn lightSensor(p20);
+    ///
+    /// uint8_t AmbientBrightness(uint8_t current)
+    /// {
+    ///     return 32 + (uint8_t)(lightSensor.read() * 223);
+    /// }
+    /// ...
+    ///     lcd.AttachBacklightSchedule(AmbientBrightness, 2000, 1000);
+    /// @endcode
+    ///
+    /// @param current is the present backlight brightness.
+    /// @returns the desired backlight brightness.
+    ///
+    typedef uint8_t (* BacklightSchedule_T)(uint8_t current);
+
+    /// A panel profile, which describes the display geometry and holds
+    /// the packed register table that configures the controller for it.
+    ///
+    /// Profiles are intended to be constant, so both the profile and its
+    /// register table are resolved at compile time and placed in flash.
+    /// See @ref RA8875_PANEL_REGS and @ref RA8875_PANEL_PROFILE, and the
+    /// predefined profiles such as @ref Panel480x272_16.
+    ///
+    typedef struct
+    {
+        dim_t width;                ///< panel width in pixels
+        dim_t height;               ///< panel height in pixels
+        uint8_t color_bpp;          ///< color depth, 8 or 16
+        uint8_t layers;             ///< number of layers, 1 or 2
+        const uint8_t * regs;       ///< packed (register, value) pairs
+        uint16_t regCount;          ///< number of pairs in regs
+    } PanelProfile_T;
+
+    static const PanelProfile_T Panel480x272_16;    ///< 480 x 272, 16-bit color, 2 layers
+    static const PanelProfile_T Panel480x272_8;     ///< 480 x 272, 8-bit color, 2 layers
+    static const PanelProfile_T Panel800x480_16;    ///< 800 x 480, 16-bit color, 1 layer
+    static const PanelProfile_T Panel800x480_8;     ///< 800 x 480, 8-bit color, 2 layers
+
+    /// How an external font is scaled. See @ref SetUserFontScale.
+    typedef enum
+    {
+        FontNearest,        ///< nearest neighbor, sharp edges and two colors
+        FontSmooth          ///< area averaged, anti-aliased with 16 levels
+    } FontScaleMode_T;
+
+    /// The phases of the boot sequence, which are timestamped by @ref BootSplash.
+    typedef enum
+    {
+        BOOT_INIT,          ///< reset, panel registers, keypad and touch are initialized
+        BOOT_ASSET,         ///< the splash asset is open and its header is read
+        BOOT_CLEAR,         ///< layer 0 is cleared around the splash
+        BOOT_PAINT,         ///< the splash is painted
+        BOOT_SHOW,          ///< the display and backlight are on
+        BOOT_PHASECOUNT     ///< the number of boot phases
+    } BootPhase_T;
+
+    /// Where @ref AlphaBlit gets the pixels that it blends over.
+    typedef enum
+    {
+        BlendOverColor,     ///< a color the caller knows is there, so nothing is read
+        BlendOverLayer,     ///< the same place on another layer, which holds a copy
+        BlendOverScreen     ///< the display itself, read back a rectangle at a time
+    } BlendUnder_T;
+
+    /// The low power modes of @ref Sleep.
+    typedef enum
+    {
+        SleepStandby,       ///< display and backlight off, the controller keeps running
+        SleepDeep           ///< as standby, and the controller clocks are stopped
+    } SleepMode_T;
+
     /// Basic constructor for a display based on the RAiO RA8875
     /// display controller, which can be used with no touchscreen,
     /// or the RA8875 managed resistive touchscreen.
@@ -489,6 +697,36 @@ public:
         PinName sda, PinName scl, PinName irq, const char * name = "lcd");
 
 
+    /// Constructor for a display on a shared SPI bus.
+    ///
+    /// This is as the basic constructor, but the SPI port is shared with other
+    /// devices, such as more displays or an SD card, through the bus. The bus
+    /// is acquired for each transaction, and it is reconfigured for this
+    /// display's clock and mode only when another device used it in between.
+    /// See @ref SPIBus.
+    ///
+    /// When the bus already has SPIBUS_MAX_DEVICES, the display is not
+    /// added to it. Then @ref init returns not_enough_ram, and the display
+    /// must not be used, since the bus will not select it.
+    ///
+    /// @code
+    /// #include "RA8875.h"
+    /// SPIBus bus(p5, p6, p7);
+    /// RA8875 lcd(bus, p12, NC, "tft");
+    /// @endcode
+    ///
+    /// @param[in] bus is the shared SPI bus.
+    /// @param[in] csel is the DigitalOut pin on the mbed to use as the
+    ///         active low chip select for the display controller.
+    /// @param[in] reset is the DigitalOut pin on the mbed to use as the
+    ///         active low reset input on the display controller -
+    ///         but this is not currently used.
+    /// @param[in] name is a text name for this object, which will permit
+    ///         capturing stdout to puts() and printf() directly to it.
+    ///
+    RA8875(SPIBus & bus, PinName csel, PinName reset, const char * name = "lcd");
+
+
     // Destructor doesn't have much to do as this would typically be created
     // at startup, and not at runtime.
     //~RA8875();
@@ -526,6 +764,92 @@ public:
         uint8_t poweron = 255, bool keypadon = true, bool touchscreeenon = true);
 
 
+    /// Initialize the driver from a panel profile.
+    ///
+    /// This is the faster form of @ref init. The panel configuration is
+    /// a precomputed register table, which is streamed to the controller
+    /// in batches, each batch under a single chip select, and broken only
+    /// where the table requires a settling delay.
+    ///
+    /// For a faster first frame, the application can identify the region
+    /// that it will paint immediately after init. That region of layer 0 is
+    /// then not cleared, since it would be overwritten anyway.
+    ///
+    /// @code
+    ///     rect_t splash = { {0,0}, {479,271} };
+    ///     lcd.init(RA8875::Panel480x272_16, 255, true, true, &splash);
+    ///     lcd.RenderImageFile(0,0, "/local/splash.bmp");
+    /// @endcode
+    ///
+    /// @param[in] profile is the panel profile. See @ref PanelProfile_T.
+    /// @param[in] poweron defines if the display should be initialized into the power-on or off state.
+    ///            If power is non-zero(on), the backlight is set to this value. This parameter is optional
+    ///             and the default is 255 (on and full brightness). See @ref Power.
+    /// @param[in] keypadon defines if the keypad support should be enabled. This parameter is optional
+    ///             and the default is true (enabled). See @ref KeypadInit.
+    /// @param[in] touchscreeenon defines if the touchscreen support should be enabled.
+    ///             This parameter is optional and the default is true (enabled). See @ref TouchPanelInit.
+    /// @param[in] firstFrame is an optional pointer to the region of layer 0 that the
+    ///             application will paint right away, and which is therefore not cleared.
+    ///             The default is NULL, which clears all layers, as @ref init does.
+    /// @returns success/failure code. See @ref RetCode_t. This is not_enough_ram
+    ///             when the display is on an SPIBus that had no room for it.
+    ///
+    RetCode_t init(const PanelProfile_T & profile, uint8_t poweron = 255,
+        bool keypadon = true, bool touchscreeenon = true, const rect_t * firstFrame = NULL);
+
+
+    /// Initialize the driver and show a splash image, as quickly as possible.
+    ///
+    /// This is an alternative to @ref init, followed by @ref RenderImageFile,
+    /// which overlaps the two where it can:
+    /// - The splash file is opened, and its header read, during the settling 
+    ///     delays of the reset, the PLL and the pixel clock, rather than after.
+    ///     A bitmap is then rendered from that open file. Any other format
+    ///     is closed and opened again by @ref RenderImageFile, so it does
+    ///     not gain from this.
+    /// - For a bitmap, only the area around the image is cleared, since the
+    ///     image covers the rest.
+    /// - The splash is painted while the display is still off, so it is
+    ///     never seen partially drawn. The display and the backlight are then
+    ///     turned on together in a single register burst.
+    ///
+    /// Each phase is timestamped, see @ref GetBootTime.
+    ///
+    /// @code
+    ///     lcd.BootSplash(RA8875::Panel480x272_16, "/local/splash.bmp");
+    ///     for (int i = 0; i < RA8875::BOOT_PHASECOUNT; i++)
+    ///         pc.printf("phase %d at %u usec\r\n", i, lcd.GetBootTime((RA8875::BootPhase_T)i));
+    /// @endcode
+    ///
+    /// @param[in] profile is the panel profile. See @ref PanelProfile_T.
+    /// @param[in] splash is the fully qualified path and name of the splash image.
+    ///             Any format supported by @ref RenderImageFile can be used, but only
+    ///             a bitmap benefits from the reduced clear.
+    /// @param[in] x is the horizontal position of the splash image. The default is 0.
+    /// @param[in] y is the vertical position of the splash image. The default is 0.
+    /// @param[in] brightness is the backlight level when the splash is shown.
+    ///             The default is 255.
+    /// @param[in] keypadon defines if the keypad support should be enabled. See @ref init.
+    /// @param[in] touchscreeenon defines if the touchscreen support should be enabled. See @ref init.
+    /// @returns success/failure code. See @ref RetCode_t. If the splash could not
+    ///             be rendered, the display is still initialized and turned on.
+    ///
+    RetCode_t BootSplash(const PanelProfile_T & profile, const char * splash,
+        loc_t x = 0, loc_t y = 0, uint8_t brightness = 255,
+        bool keypadon = true, bool touchscreeenon = true);
+
+
+    /// Get the timestamp of a boot phase.
+    ///
+    /// @param[in] phase is the boot phase of interest. See @ref BootPhase_T.
+    /// @returns the time, in microseconds from the start of @ref BootSplash,
+    ///     when that phase completed. Since the asset load overlaps with the
+    ///     panel setup, BOOT_ASSET may be earlier than BOOT_INIT.
+    ///
+    uint32_t GetBootTime(BootPhase_T phase);
+
+
     /// Get a pointer to the error code.
     ///
     /// This method returns a pointer to a text string that matches the
@@ -594,6 +918,30 @@ public:
     virtual uint16_t GetDrawingLayer(void);
 
 
+    /// Claim a layer for a user that needs all of it, such as an
+    /// OverlayLayer, which keeps every pixel that is not an overlay at
+    /// its key color.
+    ///
+    /// The widgets that cache images in a layer, such as Gauge and
+    /// Keyboard, do not cache in a claimed layer. If the layer is claimed
+    /// after they cached there, they stop using the cache, and draw
+    /// directly instead.
+    ///
+    /// @param[in] layer is 0 or 1.
+    /// @param[in] claim is true to claim it, and false to release it.
+    /// @returns success/failure code. See @ref RetCode_t.
+    ///
+    RetCode_t ClaimLayer(uint16_t layer, bool claim = true);
+
+
+    /// Determine if a layer is claimed. See @ref ClaimLayer.
+    ///
+    /// @param[in] layer is 0 or 1.
+    /// @returns true if the layer is claimed.
+    ///
+    bool IsLayerClaimed(uint16_t layer);
+
+
     /// Set the Layer presentation mode.
     ///
     /// This sets the presentation mode for layers, and permits showing
@@ -1407,6 +1755,68 @@ public:
     RetCode_t SetTextCursorControl(cursor_t cursor = NOCURSOR, bool blink = false);
 
 
+    /// Load an image into one of the hardware graphic cursors.
+    ///
+    /// The RA8875 has 8 graphic cursors (pointers) in hardware, each
+    /// 32 x 32 pixels. The graphic cursor is composited by the controller,
+    /// so moving it needs no repaint and no save-under of the display.
+    ///
+    /// The image is 256 bytes, 2 bits per pixel, left to right in each
+    /// byte starting with the most significant bits, and 8 bytes per row.
+    /// Each pixel is one of:
+    /// \li 00b: graphic cursor color 0, see @ref SetGraphicCursorColors
+    /// \li 01b: graphic cursor color 1
+    /// \li 10b: transparent, the display shows through
+    /// \li 11b: the inverse of the display beneath
+    ///
+    /// @param[in] cursor is the cursor number to load, 0 to 7.
+    /// @param[in] image is a pointer to the 256 byte image.
+    /// @returns success/failure code. See @ref RetCode_t.
+    ///
+    RetCode_t LoadGraphicCursor(uint8_t cursor, const uint8_t * image);
+
+
+    /// Select which of the hardware graphic cursors is shown.
+    ///
+    /// @param[in] cursor is the cursor number, 0 to 7.
+    /// @returns success/failure code. See @ref RetCode_t.
+    ///
+    RetCode_t SelectGraphicCursor(uint8_t cursor);
+
+
+    /// Set the two colors of the hardware graphic cursor.
+    ///
+    /// @note The graphic cursor colors are held in 8-bit (RGB332) format,
+    ///     regardless of the display color depth.
+    ///
+    /// @param[in] color0 is the color for image pixels of value 00b.
+    /// @param[in] color1 is the color for image pixels of value 01b.
+    /// @returns success/failure code. See @ref RetCode_t.
+    ///
+    RetCode_t SetGraphicCursorColors(color_t color0, color_t color1);
+
+
+    /// Move the hardware graphic cursor.
+    ///
+    /// This is a single register burst. Only the changed high bytes of
+    /// the position are written, so typical pointer motion is 2 register
+    /// writes.
+    ///
+    /// @param[in] x is the horizontal position of the left edge of the cursor image.
+    /// @param[in] y is the vertical position of the top edge of the cursor image.
+    /// @returns success/failure code. See @ref RetCode_t.
+    ///
+    RetCode_t SetGraphicCursorPosition(loc_t x, loc_t y);
+
+
+    /// Show or hide the hardware graphic cursor.
+    ///
+    /// @param[in] show when true shows the selected graphic cursor.
+    /// @returns success/failure code. See @ref RetCode_t.
+    ///
+    RetCode_t ShowGraphicCursor(bool show);
+
+
     /// Select the built-in ISO 8859-X font to use next.
     ///
     /// Supported fonts: ISO 8859-1, -2, -3, -4
@@ -1431,7 +1841,16 @@ public:
     ///       to sending text to the screen, or you end with a blended
     ///       image that is probably not as intended.
     ///
-    /// @note This command only operates on the RA8875 internal fonts.
+    /// In the rotate_90 and rotate_270 portrait orientations, the display
+    /// memory holds the transpose of the view. The coordinates of the window,
+    /// the cursors and the drawing primitives are transposed as they are
+    /// written, and the memory read and write directions are set so that
+    /// each row of the view streams contiguously. So @ref pixelStream,
+    /// @ref booleanStream, the image renderers and @ref PrintScreen all work
+    /// in view coordinates, with no per-pixel transform.
+    ///
+    /// @note The graphic cursor image is not rotated, so for portrait use,
+    ///     load an image that is drawn rotated.
     ///
     /// @code
     ///     lcd.cls();
@@ -1465,6 +1884,58 @@ public:
     RetCode_t SetOrientation(orientation_t angle = normal);
 
 
+    /// Set the order in which a stream of pixels is written.
+    ///
+    /// The controller moves the write cursor after each pixel, and wraps
+    /// it at the edge of the window. So a mirrored sprite, or an asset
+    /// stored in columns, can be streamed in the order it is stored,
+    /// with no buffer to reorder it. The first pixel goes where the
+    /// cursor is put, which is the corner the direction starts from.
+    /// The direction is of the view, so it holds in any orientation.
+    ///
+    /// It applies to every stream until it is set back, so not only to
+    /// @ref pixelStream and @ref pixelStream8, but to all that draws
+    /// through them, the bitmap and JPEG images, and to @ref booleanStream,
+    /// which draws every character of an external font, scaled or not.
+    /// So while it is set, that text is mirrored or turned as well, one
+    /// glyph at a time. Only the internal font, drawn by the controller,
+    /// is unchanged. Set it back to LeftRightTopBottom before drawing
+    /// anything that should be the right way round.
+    ///
+    /// @code
+    ///     lcd.SetWriteDirection(RA8875::RightLeftTopBottom);
+    ///     lcd.window(x, y, w, h);
+    ///     lcd.pixelStream(sprite, w * h, x + w - 1, y);   // mirrored
+    ///     lcd.window();
+    ///     lcd.SetWriteDirection(RA8875::LeftRightTopBottom);
+    /// @endcode
+    ///
+    /// @param[in] dir is the direction.
+    /// @returns success/failure code. See @ref RetCode_t.
+    ///
+    RetCode_t SetWriteDirection(direction_t dir = LeftRightTopBottom);
+
+    /// Get the order in which a stream of pixels is written.
+    ///
+    /// @returns the direction.
+    ///
+    direction_t GetWriteDirection(void) { return writeDirection; }
+
+    /// Set the order in which a stream of pixels is read, as for
+    /// @ref getPixelStream. @see SetWriteDirection.
+    ///
+    /// @param[in] dir is the direction.
+    /// @returns success/failure code. See @ref RetCode_t.
+    ///
+    RetCode_t SetReadDirection(direction_t dir = LeftRightTopBottom);
+
+    /// Get the order in which a stream of pixels is read.
+    ///
+    /// @returns the direction.
+    ///
+    direction_t GetReadDirection(void) { return readDirection; }
+
+
     /// Control the font behavior.
     ///
     /// This command lets you make several modifications to any text that
@@ -1709,6 +2180,29 @@ public:
     RetCode_t clsw(RA8875::Region_t region = FULLWINDOW);
 
 
+    /// Clear a list of rectangles to the background color.
+    ///
+    /// Each rectangle is a hardware fill, so it costs the same few bytes
+    /// whatever its size. The background color is set once for the
+    /// list, each fill sends only the coordinate registers that differ
+    /// from the one before, under a single chip select, and the next is
+    /// prepared while the controller fills the last. This is the way to
+    /// clear just the areas that a screen transition will not redraw.
+    ///
+    /// @code
+    ///     rect_t stale[] = { { {0,0}, {479,31} }, { {0,240}, {479,271} } };
+    ///     lcd.clsRects(stale, 2);
+    /// @endcode
+    ///
+    /// @param[in] rects is the list, where each is clipped to the screen.
+    /// @param[in] count is the number of rectangles.
+    /// @param[in] layers is optional, and as for @ref cls, is 0 for the
+    ///     drawing layer, or the bits of the layers to clear.
+    /// @returns success/failure code. See @ref RetCode_t.
+    ///
+    RetCode_t clsRects(const rect_t * rects, int count, uint16_t layers = 0);
+
+
     /// Set the background color.
     ///
     /// @param[in] color is expressed in 16-bit format.
@@ -1752,6 +2246,13 @@ public:
     color_t GetForeColor(void);
 
 
+    /// Get the current background color value.
+    ///
+    /// @returns the current background color.
+    ///
+    color_t GetBackColor(void);
+
+
     /// Draw a pixel in the specified color.
     ///
     /// @note Unlike many other operations, this does not
@@ -1813,6 +2314,47 @@ public:
     virtual RetCode_t pixelStream(color_t * p, uint32_t count, loc_t x, loc_t y);
 
 
+    /// Write an RGB332 stream of pixels to the display.
+    ///
+    /// When the display is configured for 8 bits per pixel, each byte is 
+    /// sent unchanged, so each SPI byte carries a full pixel and there is
+    /// no per-pixel conversion. In 16-bit mode, each pixel is expanded
+    /// to RGB565 on the way out.
+    ///
+    /// @param[in] p is a pointer to a uint8_t array of RRRG GGBB pixels.
+    /// @param[in] count is the number of pixels to write.
+    /// @param[in] x is the horizontal position on the display.
+    /// @param[in] y is the vertical position on the display.
+    /// @returns success/failure code. See @ref RetCode_t.
+    ///
+    virtual RetCode_t pixelStream8(uint8_t * p, uint32_t count, loc_t x, loc_t y);
+
+
+    /// Write a buffer of pixels to the display, in whatever format it has.
+    ///
+    /// When the buffer is already in the order of the wire, which is
+    /// WireRGB565 in 16-bit color, or WireRGB332 in 8-bit color, it is
+    /// handed to the SPI port as one block, from the caller's memory, with
+    /// no work per pixel. Where the port can, that is done by DMA. Any
+    /// other buffer is converted RA8875_WIRE_CHUNK pixels at a time, and
+    /// each chunk is written as a block.
+    ///
+    /// @code
+    ///     static uint8_t sprite[2 * 32 * 32];     // built high byte first
+    ///     PixelBuffer_T buf = { sprite, 32 * 32, WireRGB565 };
+    ///     lcd.window(x, y, 32, 32);
+    ///     lcd.pixelStream(buf, x, y);
+    ///     lcd.window();
+    /// @endcode
+    ///
+    /// @param[in] buf is the pixels, their count and their format.
+    /// @param[in] x is the horizontal position on the display.
+    /// @param[in] y is the vertical position on the display.
+    /// @returns success/failure code. See @ref RetCode_t.
+    ///
+    virtual RetCode_t pixelStream(const PixelBuffer_T & buf, loc_t x, loc_t y);
+
+
     /// Get a stream of pixels from the display.
     ///
     /// @param[in] p is a pointer to a color_t array to accept the stream.
@@ -1824,6 +2366,88 @@ public:
     virtual RetCode_t getPixelStream(color_t * p, uint32_t count, loc_t x, loc_t y);
 
 
+    /// Get a rectangle of pixels from the display.
+    ///
+    /// The window is set to the rectangle once, and the whole of it is
+    /// read in one burst, as the read cursor wraps at the window's edge.
+    /// This is much faster than @ref getPixelStream for each row, which
+    /// sets up the cursor and the dummy read every time. The window is
+    /// restored after.
+    ///
+    /// The pixels are in the order of color_t, as for @ref pixelStream,
+    /// so they can be written back as they are. This differs from
+    /// @ref getPixelStream, whose pixels are byte-swapped.
+    ///
+    /// @code
+    ///     color_t saveUnder[100 * 40];
+    ///     rect_t r = { {50, 50}, {149, 89} };
+    ///     lcd.getPixelRect(saveUnder, r);
+    ///     ... draw a popup, then put back what was under it
+    ///     lcd.window(r);
+    ///     lcd.pixelStream(saveUnder, 100 * 40, 50, 50);
+    ///     lcd.window();
+    /// @endcode
+    ///
+    /// @param[out] p is the buffer, which must hold (height - 1) * stride + width pixels.
+    /// @param[in] r is the rectangle, which must be on the screen.
+    /// @param[in] stride is the pixels from one row of the buffer to the
+    ///         next, or 0 when it is the width of the rectangle.
+    /// @returns success/failure code. See @ref RetCode_t.
+    ///
+    RetCode_t getPixelRect(color_t * p, rect_t r, dim_t stride = 0);
+
+
+    /// Blend a translucent ARGB image over the display.
+    ///
+    /// Blending needs the pixels beneath, which are the costly part, so
+    /// the caller says where they come from. Cheapest is a color known
+    /// to be there, as for a panel over a plain background. Next is a
+    /// copy on another layer, which is read back without disturbing the
+    /// view. Last is the display itself. Each is read a rectangle of
+    /// RA8875_ALPHA_CHUNK pixels at a time, with @ref getPixelRect.
+    /// A chunk that is all opaque is not read, and one that is all
+    /// transparent is neither read nor written.
+    ///
+    /// The blend is on RGB565, with the three channels of a pixel in one
+    /// 32-bit word, so each pixel costs one multiply.
+    ///
+    /// @code
+    ///     // a shadow under a popup, over a plain background
+    ///     lcd.AlphaBlit(100, 60, 200, 8, shadowMask, Black, RA8875::BlendOverColor, White);
+    /// @endcode
+    ///
+    /// @param[in] x is the left edge.
+    /// @param[in] y is the top edge.
+    /// @param[in] w is the width.
+    /// @param[in] h is the height.
+    /// @param[in] argb is the image, of w * h pixels, each 0xAARRGGBB.
+    /// @param[in] under is where the pixels beneath come from. See @ref BlendUnder_T.
+    /// @param[in] color is the color beneath, for BlendOverColor.
+    /// @param[in] layer is the layer that holds the copy, for BlendOverLayer.
+    /// @returns success/failure code. See @ref RetCode_t.
+    ///
+    RetCode_t AlphaBlit(loc_t x, loc_t y, dim_t w, dim_t h, const uint32_t * argb,
+        BlendUnder_T under = BlendOverScreen, color_t color = Black, uint16_t layer = 1);
+
+    /// Blend one color over the display, through an 8-bit alpha mask,
+    /// as for anti-aliased shapes, shadows and tinted panels.
+    /// See the ARGB form of @ref AlphaBlit.
+    ///
+    /// @param[in] x is the left edge.
+    /// @param[in] y is the top edge.
+    /// @param[in] w is the width.
+    /// @param[in] h is the height.
+    /// @param[in] alpha is the mask, of w * h bytes, where 255 is opaque.
+    /// @param[in] fg is the color that is blended.
+    /// @param[in] under is where the pixels beneath come from. See @ref BlendUnder_T.
+    /// @param[in] color is the color beneath, for BlendOverColor.
+    /// @param[in] layer is the layer that holds the copy, for BlendOverLayer.
+    /// @returns success/failure code. See @ref RetCode_t.
+    ///
+    RetCode_t AlphaBlit(loc_t x, loc_t y, dim_t w, dim_t h, const uint8_t * alpha, color_t fg,
+        BlendUnder_T under = BlendOverScreen, color_t color = Black, uint16_t layer = 1);
+
+
     /// Write a boolean stream to the display.
     ///
     /// This takes a bit stream in memory and using the current color settings
@@ -1834,6 +2458,9 @@ public:
     /// This is similar, but different, to the @ref pixelStream API, which is
     /// given a stream of color values.
     ///
+    /// It is how the characters of an external font are drawn, so they
+    /// follow @ref SetWriteDirection as images do.
+    ///
     /// @param[in] x is the horizontal position on the display.
     /// @param[in] y is the vertical position on the display.
     /// @param[in] w is the width of the rectangular region to fill.
@@ -2378,6 +3005,9 @@ public:
 
     /// Control display power
     ///
+    /// When @ref Resume left the display off, so the application could
+    /// repaint an invalid layer, turning it on also restores the backlight.
+    ///
     /// @param[in] on when set to true will turn on the display, when false it is turned off.
     /// @returns success/failure code. See @ref RetCode_t.
     ///
@@ -2426,6 +3056,111 @@ public:
     float GetBacklight(void);
 
 
+    /// Fade the backlight to a new brightness, without blocking.
+    ///
+    /// The fade is driven by a Ticker, so this returns immediately and
+    /// drawing continues while the fade progresses. The backlight register
+    /// is only written when the SPI bus is free; if a drawing operation
+    /// holds the bus, the step is deferred to the next tick, so a fade
+    /// never stalls the drawing.
+    ///
+    /// A call to @ref Backlight_u8 or @ref Backlight cancels the fade.
+    ///
+    /// @code
+    ///     lcd.BacklightFade(255, 750, RA8875::FadeEaseOut);
+    ///     lcd.RenderImageFile(0,0, "/local/splash.bmp");  // draws while fading in
+    /// @endcode
+    ///
+    /// @param[in] brightness is the target, from 0 (off) to 255 (full on).
+    /// @param[in] duration_ms is the duration of the fade. When zero, the
+    ///             brightness is set immediately.
+    /// @param[in] curve is the easing curve. The default is FadeLinear.
+    ///             See @ref FadeCurve_T.
+    /// @returns success/failure code. See @ref RetCode_t.
+    ///
+    RetCode_t BacklightFade(uint8_t brightness, uint32_t duration_ms, FadeCurve_T curve = FadeLinear);
+
+
+    /// Determine if a backlight fade is in progress.
+    ///
+    /// @returns true while the backlight is still changing.
+    ///
+    bool IsBacklightFading(void);
+
+
+    /// Attach a backlight schedule, such as an ambient light control.
+    ///
+    /// The callback is polled at the given interval, and when the brightness
+    /// it returns differs from the present target, a fade to it is started.
+    /// See @ref BacklightSchedule_T.
+    ///
+    /// @param[in] schedule is the schedule function, or NULL to remove it.
+    /// @param[in] interval_ms is how often to call it. The default is 1000.
+    /// @param[in] fade_ms is the duration of the fades it starts. The default is 500.
+    /// @param[in] curve is the easing curve of those fades. The default is FadeEaseInOut.
+    /// @returns success/failure code. See @ref RetCode_t.
+    ///
+    RetCode_t AttachBacklightSchedule(BacklightSchedule_T schedule, uint32_t interval_ms = 1000,
+        uint32_t fade_ms = 500, FadeCurve_T curve = FadeEaseInOut);
+
+
+    /// Put the display into a low power mode.
+    ///
+    /// The register state is captured first, and the resume sequence is
+    /// prepared, so that @ref Resume is a single batched register write,
+    /// with no call to @ref init and no repaint of the screen.
+    ///
+    /// In SleepStandby, the display and backlight are turned off, but the
+    /// controller keeps running, so the layers may still be drawn.
+    /// In SleepDeep, the controller clocks are stopped as well, using the
+    /// sleep bit of the power register. Nothing may be drawn until it resumes.
+    ///
+    /// @code
+    ///     lcd.Sleep(RA8875::SleepDeep);
+    ///     ...                             // the host sleeps
+    ///     lcd.Resume();
+    ///     pc.printf("resume %u usec\r\n", lcd.GetResumeTime());
+    /// @endcode
+    ///
+    /// @param[in] mode is the low power mode. See @ref SleepMode_T.
+    /// @param[in] validLayers is a bit mask of the layers that the application
+    ///             expects to be valid at resume, bit 0 for layer 0 and bit 1
+    ///             for layer 1. The default is both. If a visible layer is not
+    ///             valid, @ref Resume leaves the display off, so that it can be
+    ///             repainted before it is shown with @ref Power.
+    /// @returns success/failure code. See @ref RetCode_t.
+    ///
+    RetCode_t Sleep(SleepMode_T mode = SleepStandby, uint8_t validLayers = 0x03);
+
+
+    /// Resume from @ref Sleep.
+    ///
+    /// The controller is woken and its register state restored, and, when
+    /// the visible layers are valid, the display and backlight are turned
+    /// on, all in one batched register write.
+    ///
+    /// @returns success/failure code. See @ref RetCode_t.
+    ///
+    RetCode_t Resume(void);
+
+
+    /// Determine if the display is in a low power mode.
+    ///
+    /// @returns true from @ref Sleep until @ref Resume.
+    ///
+    bool IsSleeping(void);
+
+
+    /// Get the time to the first frame after the last resume.
+    ///
+    /// This is measured from the start of @ref Resume until the display is
+    /// on, which includes the repaint when the display was left off for it.
+    ///
+    /// @returns the time in microseconds, or 0 if the display is not on yet.
+    ///
+    uint32_t GetResumeTime(void);
+
+
     /// Select a User Font for all subsequent text.
     ///
     /// @note Tool to create the fonts is accessible from its creator
@@ -2444,6 +3179,62 @@ public:
     ///
     virtual const uint8_t * GetUserFont(void) { return font; }
 
+    /// Scale the external (user) font.
+    ///
+    /// The glyphs of the font selected with @ref SelectUserFont are scaled
+    /// as they are drawn, by integer or fractional factors, so a single font
+    /// table can serve several sizes. Each scaled glyph is kept in a RAM cache,
+    /// so after its first use, it costs the same to draw as a native glyph.
+    /// A glyph too large for the cache, see RA8875_GLYPH_CACHE_BYTES, is
+    /// scaled again each time it is drawn.
+    ///
+    /// In FontSmooth, the coverage of each pixel is kept, rather than its
+    /// color, so a cached glyph is still valid when the colors change.
+    ///
+    /// @code
+    ///     lcd.SelectUserFont(BPG_Arial20x20);
+    ///     lcd.SetUserFontScale(1.5, 1.5, RA8875::FontSmooth);
+    ///     lcd.puts(0,0, "30 pixel text");
+    ///     lcd.SetUserFontScale();     // back to native
+    /// @endcode
+    ///
+    /// @param[in] hScale is the horizontal scale, from 0.25 to 8.0. The default is 1.0.
+    /// @param[in] vScale is the vertical scale, from 0.25 to 8.0. When zero, which is
+    ///             the default, it is the same as hScale.
+    /// @param[in] mode is the scaling method. The default is FontNearest. See
+    ///             @ref FontScaleMode_T.
+    /// @returns success/failure code. See @ref RetCode_t.
+    ///
+    RetCode_t SetUserFontScale(float hScale = 1.0, float vScale = 0, FontScaleMode_T mode = FontNearest);
+
+    /// Release the RAM held by the scaled glyph cache.
+    ///
+    /// @returns success/failure code. See @ref RetCode_t.
+    ///
+    RetCode_t FlushGlyphCache(void);
+
+    /// Get the scaled glyph cache statistics.
+    ///
+    /// @param[out] hits is where the number of glyphs drawn from the cache
+    ///             is written. It is ignored if NULL.
+    /// @param[out] misses is where the number of glyphs that had to be scaled
+    ///             is written. It is ignored if NULL.
+    /// @returns the number of bytes the cache presently holds.
+    ///
+    uint32_t GetGlyphCacheStats(uint32_t * hits, uint32_t * misses);
+
+    /// Get the metrics of a character of the external font, as scaled.
+    ///
+    /// See @ref GraphicsDisplay::getCharMetrics and @ref SetUserFontScale.
+    ///
+    virtual const uint8_t * getCharMetrics(const unsigned char c, dim_t * width, dim_t * height);
+
+    /// Draw a character of the external font, as scaled.
+    ///
+    /// See @ref GraphicsDisplay::fontblit and @ref SetUserFontScale.
+    ///
+    virtual int fontblit(loc_t x, loc_t y, const unsigned char c);
+
     /// Get the RGB value for a DOS color.
     ///
     /// @code
@@ -2516,6 +3307,22 @@ public:
     virtual RetCode_t _EndGraphicsStream(void);
 
 
+    /// Start timing a long operation for its yield points.
+    ///
+    /// @see SetYieldBudget.
+    ///
+    virtual void _YieldBegin(void);
+
+
+    /// A yield point in a long image rendering.
+    ///
+    /// @see SetYieldBudget.
+    ///
+    /// @returns external_abort if the idle callback asked to stop.
+    ///
+    virtual RetCode_t _Yield(void);
+
+
     /// Set the SPI port frequency (in Hz).
     ///
     /// This uses the mbed SPI driver, and is therefore dependent on
@@ -2546,6 +3353,45 @@ public:
     RetCode_t frequency(unsigned long Hz = RA8875_DEFAULT_SPI_FREQ, unsigned long Hz2 = 0);
 
 
+    /// Mirror the drawing onto another panel on the same SPI bus.
+    ///
+    /// While mirrored, the chip select of the other panel is asserted along
+    /// with this one for every write, so each register setup and each pixel
+    /// is sent once, and reaches all of the panels. Reads and status polls
+    /// are answered by this panel alone: the first read in a transaction
+    /// deselects the mirrors, and they are selected again only by the next
+    /// transaction. So a transaction that writes after it reads is not
+    /// mirrored past the read.
+    ///
+    /// The mirrored panels should be the same model, initialized with the
+    /// same profile, which is most easily done by adding them before @ref init.
+    /// They should not be drawn through their own objects while mirrored.
+    ///
+    /// @code
+    ///     SPIBus bus(p5, p6, p7);
+    ///     RA8875 lcd1(bus, p12, NC, "lcd1");
+    ///     RA8875 lcd2(bus, p13, NC, "lcd2");
+    ///
+    ///     lcd1.AddMirror(lcd2);
+    ///     lcd1.init(RA8875::Panel480x272_16);
+    ///     lcd1.puts("Both panels show this.");
+    /// @endcode
+    ///
+    /// @param[in] panel is the display to mirror onto.
+    /// @returns success/failure code. See @ref RetCode_t. If either display
+    ///     is not on a shared bus, or was not added to it because it was
+    ///     full, or they are on different buses, it returns bad_parameter.
+    ///
+    RetCode_t AddMirror(RA8875 & panel);
+
+
+    /// Stop mirroring the drawing onto other panels.
+    ///
+    /// @returns success/failure code. See @ref RetCode_t.
+    ///
+    RetCode_t ClearMirrors(void);
+
+
     /// This method captures the specified area as a 24-bit bitmap file.
     ///
     /// Even though this is a 16-bit display, the stored image is in
@@ -2651,6 +3497,46 @@ public:
     void AttachIdleHandler(IdleCallback_T callback = NULL) { idle_callback = callback; }
 
 
+    /// Set the time slice that long operations run for before they yield.
+    ///
+    /// The idle callback is otherwise called only while the driver waits
+    /// on the display. Long software loops, which are rendering an image,
+    /// PrintScreen, ThickLine and AlphaBlit, also have yield points, one
+    /// per row, MCU, step or chunk. At a yield point, when more than the
+    /// budget has passed since the operation started or last yielded, the
+    /// idle callback is called with image_yield, capture_yield or
+    /// draw_yield. So the application can service its control loop while
+    /// a large image renders, with a bounded latency.
+    ///
+    /// If the callback returns external_abort, the operation stops at
+    /// that point, and returns external_abort.
+    ///
+    /// The latency is the budget plus the time of one step, which is
+    /// reported by @ref GetYieldStats.
+    ///
+    /// @code
+    ///     lcd.AttachIdleHandler(myIdle_handler);
+    ///     lcd.SetYieldBudget(5000);           // every 5 msec, or so
+    ///     lcd.RenderImageFile(0, 0, "/local/photo.jpg");
+    ///     printf("worst gap %u usec\r\n", lcd.GetYieldStats().maxGap);
+    /// @endcode
+    ///
+    /// @param[in] usec is the time slice, in microseconds. The default
+    ///     of zero turns the yield points off.
+    ///
+    void SetYieldBudget(uint32_t usec = 0);
+
+    /// Get the statistics of the yield points, since @ref ClearYieldStats.
+    ///
+    /// @returns a reference to the statistics.
+    ///
+    const YieldStats_T & GetYieldStats(void) { return yieldStats; }
+
+    /// Clear the statistics of the yield points.
+    ///
+    void ClearYieldStats(void);
+
+
 #ifdef PERF_METRICS
     /// Clear the performance metrics to zero.
     void ClearPerformance();
@@ -2667,6 +3553,16 @@ public:
     /// @param[in,out] pc is the serial channel to write to.
     ///
     void ReportPerformance(Serial & pc);
+
+    /// Get the number of bytes moved on the SPI bus, in either direction,
+    /// since the last ClearPerformance.
+    ///
+    /// This is the measure of the cost of a drawing operation that does not
+    /// depend on the SPI clock, so it is useful to compare ways of drawing.
+    ///
+    /// @returns the byte count.
+    ///
+    uint32_t GetBusBytes(void) { return busBytes; }
 #endif
 
 
@@ -2814,10 +3710,201 @@ private:
     /// Convert an 8-bit color value to a 16-bit value
     ///
     /// @param[in] c8 is the 8-bit color value to convert.
-    /// @returns 16-bit color value.
+    /// @returns 16-bit color value, byte-swapped as getPixel returns it.
     ///
     color_t _cvt8to16(uint8_t c8);
 
+    /// Write a packed register table to the controller.
+    ///
+    /// The table is a sequence of (register, value) pairs. Consecutive
+    /// writes are issued under a single chip select, until an entry of
+    /// @ref RA8875_REG_DELAY is found, which waits the given number of
+    /// milliseconds.
+    ///
+    /// @param[in] regs is a pointer to the table.
+    /// @param[in] count is the number of pairs in the table.
+    /// @returns success/failure code. See @ref RetCode_t.
+    ///
+    RetCode_t _WriteRegisterTable(const uint8_t * regs, uint16_t count);
+
+    /// Clear the drawing layer around a rectangle.
+    ///
+    /// Up to four bands, above, below, left and right of the rectangle,
+    /// are each cleared with a single active window clear.
+    ///
+    /// @param[in] r is the rectangle which is not cleared.
+    /// @returns success/failure code. See @ref RetCode_t.
+    ///
+    RetCode_t _ClearAround(rect_t r);
+
+    /// Write an (x,y) pair to the coordinate registers command and command+2.
+    ///
+    /// In portrait, the display memory is the transpose of the view, so
+    /// x and y trade places. With the memory read and write directions set
+    /// to top to bottom, then left to right, a row of the view is then a
+    /// contiguous stream, and no per-pixel transform is needed.
+    ///
+    /// @param[in] command is the low byte register of the x coordinate.
+    /// @param[in] x is the horizontal coordinate of the view.
+    /// @param[in] y is the vertical coordinate of the view.
+    /// @returns success/failure code. See @ref RetCode_t.
+    ///
+    RetCode_t _WriteCommandXY(unsigned char command, loc_t x, loc_t y);
+
+    /// Set the window metrics, without writing the registers.
+    ///
+    /// @param[in] x is the left edge.
+    /// @param[in] y is the top edge.
+    /// @param[in] width is the width, or -1 for the rest of the screen.
+    /// @param[in] height is the height, or -1 for the rest of the screen.
+    ///
+    void _WindowRect(loc_t x, loc_t y, dim_t width, dim_t height);
+
+    /// Prepare to stream pixels, in one burst under a single chip select.
+    ///
+    /// This fuses @ref window, @ref SetGraphicsCursor and
+    /// @ref _StartGraphicsStream for a blit. Of the window registers, and
+    /// the graphics mode, only those that differ from what was last
+    /// written are sent. The cursor is always sent, since the controller
+    /// moves it as pixels are written. The caller then selects the chip
+    /// and sends the data command and the pixels.
+    ///
+    /// @param[in] x is the horizontal position of the first pixel.
+    /// @param[in] y is the vertical position of the first pixel.
+    /// @param[in] setWindow is true to also write the window, as set by
+    ///         @ref _WindowRect.
+    /// @param[in] read is true to set the read cursor, for a read stream.
+    /// @returns success/failure code. See @ref RetCode_t.
+    ///
+    RetCode_t _BeginBlit(loc_t x, loc_t y, bool setWindow = false, bool read = false);
+
+    /// Note a register write in the shadow, when it is one that is kept.
+    ///
+    /// @param[in] reg is the register.
+    /// @param[in] data is the value written.
+    ///
+    void _Shadow(uint8_t reg, uint8_t data);
+
+    /// Add a register write to a table, unless the shadow shows that the
+    /// register already holds the value.
+    ///
+    /// @param[in,out] regs is the table of (register, value) pairs.
+    /// @param[in] n is the number of pairs in the table.
+    /// @param[in] reg is the register.
+    /// @param[in] data is the value.
+    /// @returns the new number of pairs.
+    ///
+    uint16_t _AppendReg(uint8_t * regs, uint16_t n, uint8_t reg, uint8_t data);
+
+    /// Add the window registers that change to a table.
+    ///
+    /// @param[in,out] regs is the table, with room for 8 more pairs.
+    /// @param[in] n is the number of pairs in the table.
+    /// @returns the new number of pairs.
+    ///
+    uint16_t _AppendWindow(uint8_t * regs, uint16_t n);
+
+    /// Get the controller's direction bits for a direction of the view,
+    /// in the present orientation.
+    ///
+    /// @param[in] dir is the direction.
+    /// @returns the bits, 0 to 3, as for MWCR0 bits 3-2 and MRCD bits 1-0.
+    ///
+    uint8_t _DirectionBits(direction_t dir);
+
+    /// The common part of the two forms of @ref AlphaBlit, where one of
+    /// argb and alpha is given.
+    ///
+    RetCode_t _AlphaBlit(loc_t x, loc_t y, dim_t w, dim_t h, const uint32_t * argb,
+        const uint8_t * alpha, color_t fg, BlendUnder_T under, color_t color, uint16_t layer);
+
+    /// Swap the x and y of a point.
+    ///
+    /// @param[in] p is the point.
+    /// @returns the transposed point.
+    ///
+    point_t _Transpose(point_t p);
+
+    /// Start a backlight fade from the present level.
+    ///
+    /// @param[in] brightness is the target.
+    /// @param[in] duration_ms is the duration of the fade.
+    /// @param[in] curve is the easing curve.
+    ///
+    void _FadeStart(uint8_t brightness, uint32_t duration_ms, FadeCurve_T curve);
+
+    /// The Ticker callback that steps the backlight fade and schedule.
+    ///
+    void _FadeTicker(void);
+
+    /// Write the backlight level from interrupt context.
+    ///
+    /// This must only be called once @ref _trySelect has selected the
+    /// display, and it releases it. It restores the register that was last
+    /// selected, so a foreground sequence that was between transactions
+    /// continues unaffected.
+    ///
+    /// @param[in] brightness is the level to write.
+    ///
+    void _FadeWrite(uint8_t brightness);
+
+    /// Turn the display and backlight on, to complete a @ref Resume.
+    ///
+    /// This writes the tail of the resume sequence, when Resume left the
+    /// display off so the application could repaint first.
+    ///
+    void _ResumeShow(void);
+
+    /// Note the restored backlight state, and the time of the first frame.
+    ///
+    void _ResumeShown(void);
+
+    /// Perform the next step of the boot splash preload.
+    ///
+    /// This is called during the register table settling delays while
+    /// @ref BootSplash is in progress, so the file system work overlaps
+    /// with the controller setup.
+    ///
+    void _BootPreload(void);
+
+    /// A scaled glyph in the cache. See @ref SetUserFontScale.
+    typedef struct
+    {
+        const uint8_t * font;       ///< font it came from, or NULL if the slot is free
+        uint16_t scaleX;            ///< horizontal scale, 8.8 fixed point
+        uint16_t scaleY;            ///< vertical scale, 8.8 fixed point
+        uint8_t c;                  ///< character
+        uint8_t mode;               ///< FontScaleMode_T
+        dim_t w;                    ///< scaled width
+        dim_t h;                    ///< scaled height
+        uint8_t * data;             ///< 1 bit (nearest) or 4 bits (smooth) per pixel
+        uint32_t used;              ///< when it was last used, for the LRU eviction
+    } Glyph_T;
+
+    /// Find a scaled glyph in the cache, or scale it and add it.
+    ///
+    /// @param[in] c is the character.
+    /// @returns the glyph, or NULL if it is not printable, it is larger than
+    ///     RA8875_GLYPH_CACHE_BYTES, or there is not enough ram.
+    ///
+    Glyph_T * _GetScaledGlyph(const unsigned char c);
+
+    /// Scale a glyph and stream it to the display as it is scaled, without
+    /// caching it. This is for glyphs the cache cannot hold.
+    ///
+    /// @param[in] x is the horizontal position.
+    /// @param[in] y is the vertical position.
+    /// @param[in] c is the character.
+    /// @returns the scaled width, or 0 if the character is not printable.
+    ///
+    int _StreamScaledGlyph(loc_t x, loc_t y, const unsigned char c);
+
+    /// Remove a glyph from the cache.
+    ///
+    /// @param[in] g is the glyph.
+    ///
+    void _FreeGlyph(Glyph_T * g);
+
     /// Select the peripheral to use it.
     ///
     /// @param[in] chipsel when true will select the peripheral, and when false
@@ -2827,6 +3914,13 @@ private:
     ///
     RetCode_t _select(bool chipsel);
 
+    /// Select the peripheral from an interrupt, only if the bus is free.
+    ///
+    /// @returns true if it was selected, in which case @ref _select(false)
+    ///     releases it.
+    ///
+    bool _trySelect(void);
+
     /// Wait while the status register indicates the controller is busy.
     ///
     /// @param[in] mask is the mask of bits to monitor.
@@ -2863,6 +3957,22 @@ private:
     ///
     unsigned char _spiwrite(unsigned char data);
 
+    /// Write a block of bytes to the SPI interface, as one transfer where
+    /// the port supports it.
+    ///
+    /// @param[in] p is the bytes to write.
+    /// @param[in] count is the number of bytes.
+    ///
+    void _spiwriteBlock(const uint8_t * p, uint32_t count);
+
+    /// A yield point in a long operation, which calls the idle callback
+    /// once the yield budget has passed.
+    ///
+    /// @param[in] reason is passed to the idle callback.
+    /// @returns external_abort if the idle callback asked to stop.
+    ///
+    RetCode_t _YieldFor(IdleReason_T reason);
+
     /// The most primitive - to read a data value to the SPI interface.
     ///
     /// This is really just a specialcase of the write command, where
@@ -2875,7 +3985,11 @@ private:
 
     const uint8_t * pKeyMap;
 
-    SPI spi;                        ///< spi port
+    SPI * spi;                      ///< spi port, owned unless it is on a shared bus
+    SPIBus * bus;                   ///< shared bus, or NULL
+    int busId;                      ///< device id on the shared bus
+    uint32_t mirrorMask;            ///< bus devices that are mirrored
+    bool mirrorSelected;            ///< the mirrors are presently selected
     bool spiWriteSpeed;             ///< indicates if the current mode is write or read
     unsigned long spiwritefreq;     ///< saved write freq
     unsigned long spireadfreq;      ///< saved read freq
@@ -2888,13 +4002,66 @@ private:
     dim_t screenheight;             ///< configured screen height
     rect_t windowrect;              ///< window commands are held here for speed of access
     bool portraitmode;              ///< set true when in portrait mode (w,h are reversed)
+    direction_t writeDirection;     ///< stream write direction, of the view
+    direction_t readDirection;      ///< stream read direction, of the view
+    uint8_t claimedLayers;          ///< mask of the layers claimed, see ClaimLayer
 
     const unsigned char * font;     ///< reference to an external font somewhere in memory
     uint8_t extFontHeight;          ///< computed from the font table when the user sets the font
     uint8_t extFontWidth;           ///< computed from the font table when the user sets the font
+    uint16_t fontScaleX;            ///< external font horizontal scale, 8.8 fixed point
+    uint16_t fontScaleY;            ///< external font vertical scale, 8.8 fixed point
+    FontScaleMode_T fontScaleMode;  ///< external font scaling method
+    Glyph_T glyphCache[RA8875_GLYPH_CACHE_ENTRIES]; ///< scaled glyphs
+    uint32_t glyphCacheBytes;       ///< RAM held by the scaled glyphs
+    uint32_t glyphClock;            ///< counts glyph uses, for the LRU eviction
+    uint32_t glyphHits;             ///< glyphs drawn from the cache
+    uint32_t glyphMisses;           ///< glyphs that had to be scaled
 
     loc_t cursor_x, cursor_y;       ///< used for external fonts only
 
+    bool pwmEnabled;                ///< backlight PWM has been enabled
+    volatile bool spiInUse;         ///< chip select is asserted
+    volatile uint8_t lastCommand;   ///< register selected by the most recent command cycle
+    uint8_t regShadow[9];           ///< last written window (0x30-0x37) and MWCR0 (0x40)
+    uint16_t shadowValid;           ///< the bits of regShadow written since the reset
+
+    // Backlight fade, see BacklightFade
+    Ticker fadeTicker;              ///< steps the fade and the schedule
+    volatile bool fadeActive;       ///< a fade is in progress
+    volatile bool fadePending;      ///< fadeLevel has not been written yet
+    volatile uint8_t fadeLevel;     ///< present backlight level
+    uint8_t fadeStart;              ///< level at the start of the fade
+    uint8_t fadeTarget;             ///< level at the end of the fade
+    FadeCurve_T fadeCurve;          ///< easing curve of the fade
+    uint32_t fadeDuration_ms;       ///< duration of the fade
+    uint32_t fadeElapsed_ms;        ///< progress of the fade
+    BacklightSchedule_T fadeSchedule;   ///< backlight schedule callback
+    uint32_t scheduleInterval_ms;   ///< how often to poll the schedule
+    uint32_t scheduleElapsed_ms;    ///< time since the schedule was polled
+    uint32_t scheduleFade_ms;       ///< duration of the fades the schedule starts
+    FadeCurve_T scheduleCurve;      ///< easing curve of the fades the schedule starts
+    point_t gcPosition;             ///< last graphic cursor position written
+
+    // Boot splash, see BootSplash
+    const char * bootName;          ///< splash asset to preload
+    FILE * bootImage;               ///< splash asset file handle, once open
+    uint8_t bootStep;               ///< next preload step, 0 when there is none
+    uint32_t bootOffset;            ///< offset to the bitmap data, 0 if not a bitmap
+    rect_t bootRect;                ///< where the splash lands on screen
+    Timer bootTimer;                ///< timestamps the boot phases
+    uint32_t bootTime[BOOT_PHASECOUNT]; ///< usec at the end of each boot phase
+
+    // Sleep and resume, see Sleep
+    uint8_t sleepTable[RA8875_SLEEP_TABLE];  ///< the resume sequence, in (register, value) pairs
+    uint16_t sleepCount;            ///< number of pairs in sleepTable
+    uint16_t sleepShow;             ///< index of the pairs that turn the display on
+    bool sleeping;                  ///< between Sleep and Resume
+    bool sleepShowOnResume;         ///< the visible layers are valid, so Resume turns the display on
+    bool resumeShowPending;         ///< resumed, but the display is not on yet
+    Timer resumeTimer;              ///< times the resume
+    uint32_t resumeTime;            ///< usec from resume to the display on
+
     #ifdef PERF_METRICS
     typedef enum
     {
@@ -2915,6 +4082,7 @@ private:
     } method_e;
     unsigned long metrics[METRICCOUNT];
     unsigned long idletime_usec;
+    uint32_t busBytes;              ///< bytes moved on the bus
     void RegisterPerformance(method_e method);
     Timer performance;
     #endif
@@ -2939,6 +4107,9 @@ private:
     FPointerDummy  *obj_callback;
     RetCode_t (FPointerDummy::*method_callback)(filecmd_t cmd, uint8_t * buffer, uint16_t size);
     RetCode_t (* idle_callback)(IdleReason_T reason);
+    uint32_t yieldBudget;           ///< uSec between yields, or 0 for none
+    Timer yieldTimer;               ///< times since the last yield
+    YieldStats_T yieldStats;        ///< see GetYieldStats
 };
 
 
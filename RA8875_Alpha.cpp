@@ -0,0 +1,137 @@
+/// This file contains the RA8875 alpha blending methods.
+///
+/// The image is blended a chunk at a time: a rectangle of no more than
+/// RA8875_ALPHA_CHUNK pixels, which is read, blended in RAM, and
+/// streamed back. The pixels beneath come from where the caller says
+/// is cheapest, see BlendUnder_T.
+///
+#include "RA8875.h"
+
+//#define DEBUG "RAab"
+// ...
+// INFO("Stuff to show %d", var); // new-line is automatically appended
+//
+#if (defined(DEBUG) && !defined(TARGET_LPC11U24))
+#define INFO(x, ...) std::printf("[INF %s %4d] "x"\r\n", DEBUG, __LINE__, ##__VA_ARGS__);
+#define WARN(x, ...) std::printf("[WRN %s %4d] "x"\r\n", DEBUG, __LINE__, ##__VA_ARGS__);
+#define ERR(x, ...)  std::printf("[ERR %s %4d] "x"\r\n", DEBUG, __LINE__, ##__VA_ARGS__);
+#else
+#define INFO(x, ...)
+#define WARN(x, ...)
+#define ERR(x, ...)
+#endif
+
+// RGB565 spread over a 32-bit word, as 00000GGG GGG00000 RRRRR000 000BBBBB,
+// so each channel has room above it for the product with a 5-bit alpha.
+#define SPREAD_MASK 0x07E0F81F
+
+static inline uint32_t Spread(color_t c)
+{
+    return (c | ((uint32_t)c << 16)) & SPREAD_MASK;
+}
+
+
+// Blend fg over the spread bg, with alpha from 0 to 32, all three channels
+// with the one multiply.
+static inline color_t Blend(uint32_t fg, uint32_t bg, uint32_t a32)
+{
+    bg += ((fg - bg) * a32) >> 5;
+    bg &= SPREAD_MASK;
+    return (color_t)(bg | (bg >> 16));
+}
+
+
+static inline color_t ARGBTo565(uint32_t p)
+{
+    return RGB888To565((uint8_t)(p >> 16), (uint8_t)(p >> 8), (uint8_t)p);
+}
+
+
+RetCode_t RA8875::AlphaBlit(loc_t x, loc_t y, dim_t w, dim_t h, const uint32_t * argb,
+    BlendUnder_T under, color_t color, uint16_t layer)
+{
+    if (argb == NULL)
+        return bad_parameter;
+    return _AlphaBlit(x, y, w, h, argb, NULL, 0, under, color, layer);
+}
+
+
+RetCode_t RA8875::AlphaBlit(loc_t x, loc_t y, dim_t w, dim_t h, const uint8_t * alpha, color_t fg,
+    BlendUnder_T under, color_t color, uint16_t layer)
+{
+    if (alpha == NULL)
+        return bad_parameter;
+    return _AlphaBlit(x, y, w, h, NULL, alpha, fg, under, color, layer);
+}
+
+
+RetCode_t RA8875::_AlphaBlit(loc_t x, loc_t y, dim_t w, dim_t h, const uint32_t * argb,
+    const uint8_t * alpha, color_t fg, BlendUnder_T under, color_t color, uint16_t layer)
+{
+    color_t buf[RA8875_ALPHA_CHUNK];
+    dim_t cw = (w < RA8875_ALPHA_CHUNK) ? w : RA8875_ALPHA_CHUNK;
+    dim_t ch = RA8875_ALPHA_CHUNK / ((cw) ? cw : 1);
+    uint32_t fgSpread = Spread(fg);
+    uint32_t colorSpread = Spread(color);
+    rect_t restore = windowrect;
+    uint16_t prevLayer = GetDrawingLayer();
+
+    if (x < 0 || y < 0 || w == 0 || h == 0 || x + w > width() || y + h > height())
+        return bad_parameter;
+    if (under == BlendOverLayer && layer > 1)
+        return bad_parameter;
+    _YieldBegin();
+    for (dim_t ty = 0; ty < h; ty += ch) {
+        dim_t th = (h - ty < ch) ? h - ty : ch;
+
+        for (dim_t tx = 0; tx < w; tx += cw) {
+            dim_t tw = (w - tx < cw) ? w - tx : cw;
+            rect_t r = { { (loc_t)(x + tx), (loc_t)(y + ty) },
+                { (loc_t)(x + tx + tw - 1), (loc_t)(y + ty + th - 1) } };
+            uint8_t lo = 255, hi = 0;
+
+            // The range of alpha in the chunk decides what is read.
+            for (dim_t j = 0; j < th; j++) {
+                uint32_t row = (uint32_t)(ty + j) * w + tx;
+
+                for (dim_t i = 0; i < tw; i++) {
+                    uint8_t a = (argb) ? (uint8_t)(argb[row + i] >> 24) : alpha[row + i];
+
+                    if (a < lo) lo = a;
+                    if (a > hi) hi = a;
+                }
+            }
+            if (hi == 0)
+                continue;                           // all transparent, nothing changes
+            bool read = (lo < 255 && under != BlendOverColor);
+
+            if (read) {
+                if (under == BlendOverLayer)
+                    SelectDrawingLayer(layer);
+                getPixelRect(buf, r);
+                if (under == BlendOverLayer)
+                    SelectDrawingLayer(prevLayer);
+            }
+            for (dim_t j = 0; j < th; j++) {
+                uint32_t row = (uint32_t)(ty + j) * w + tx;
+                color_t * q = buf + j * tw;
+
+                for (dim_t i = 0; i < tw; i++) {
+                    uint32_t src = (argb) ? Spread(ARGBTo565(argb[row + i])) : fgSpread;
+                    uint8_t a = (argb) ? (uint8_t)(argb[row + i] >> 24) : alpha[row + i];
+                    uint32_t under32 = (read) ? Spread(q[i]) : colorSpread;
+
+                    q[i] = Blend(src, under32, ((uint32_t)a + 4) >> 3);
+                }
+            }
+            window(r);
+            pixelStream(buf, (uint32_t)tw * th, r.p1.x, r.p1.y);
+            if (_YieldFor(draw_yield) == external_abort) {
+                window(restore);
+                return external_abort;
+            }
+        }
+    }
+    window(restore);
+    return noerror;
+}
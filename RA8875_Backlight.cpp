@@ -0,0 +1,134 @@
+/// This file contains the RA8875 backlight fade methods.
+///
+/// A fade is stepped by a Ticker, and each step is written from the
+/// interrupt only when the SPI bus is free, so the foreground drawing
+/// is never blocked by, nor corrupted by, a fade in progress.
+///
+#include "RA8875.h"
+
+#define FADE_TICK_mS    10
+#define FADE_TICK_uS    (FADE_TICK_mS * 1000)
+
+
+// Apply the easing curve to the progress p, where both p and the
+// result are scaled 0 to 256.
+static uint16_t Ease(RA8875::FadeCurve_T curve, uint16_t p)
+{
+    switch (curve) {
+        case RA8875::FadeEaseIn:
+            return (p * p) >> 8;
+        case RA8875::FadeEaseOut:
+            return (p * (512 - p)) >> 8;
+        case RA8875::FadeEaseInOut:
+            if (p < 128)
+                return (2 * p * p) >> 8;
+            else
+                return 256 - ((2 * (256 - p) * (256 - p)) >> 8);
+        case RA8875::FadeLinear:
+        default:
+            return p;
+    }
+}
+
+
+RetCode_t RA8875::BacklightFade(uint8_t brightness, uint32_t duration_ms, FadeCurve_T curve)
+{
+    if (curve > FadeEaseInOut)
+        return bad_parameter;
+    if (duration_ms == 0)
+        return Backlight_u8(brightness);
+    fadeTicker.detach();                // quiet the interrupt while the fade is set up
+    _FadeStart(brightness, duration_ms, curve);
+    fadeTicker.attach_us(callback(this, &RA8875::_FadeTicker), FADE_TICK_uS);
+    return noerror;
+}
+
+
+bool RA8875::IsBacklightFading(void)
+{
+    return fadeActive || fadePending;
+}
+
+
+RetCode_t RA8875::AttachBacklightSchedule(BacklightSchedule_T schedule, uint32_t interval_ms,
+    uint32_t fade_ms, FadeCurve_T curve)
+{
+    if (curve > FadeEaseInOut || (schedule && interval_ms < FADE_TICK_mS))
+        return bad_parameter;
+    fadeTicker.detach();
+    fadeSchedule = schedule;
+    scheduleInterval_ms = interval_ms;
+    scheduleElapsed_ms = interval_ms;   // poll it on the first tick
+    scheduleFade_ms = fade_ms;
+    scheduleCurve = curve;
+    if (fadeSchedule || fadeActive || fadePending)
+        fadeTicker.attach_us(callback(this, &RA8875::_FadeTicker), FADE_TICK_uS);
+    return noerror;
+}
+
+
+void RA8875::_FadeStart(uint8_t brightness, uint32_t duration_ms, FadeCurve_T curve)
+{
+    fadeStart = fadeLevel;
+    fadeTarget = brightness;
+    fadeCurve = curve;
+    fadeDuration_ms = duration_ms;
+    fadeElapsed_ms = 0;
+    fadeActive = true;
+}
+
+
+void RA8875::_FadeTicker(void)
+{
+    if (fadeSchedule) {
+        scheduleElapsed_ms += FADE_TICK_mS;
+        if (scheduleElapsed_ms >= scheduleInterval_ms) {
+            uint8_t wanted = (*fadeSchedule)(fadeLevel);
+
+            scheduleElapsed_ms = 0;
+            if (wanted != ((fadeActive) ? fadeTarget : fadeLevel))
+                _FadeStart(wanted, scheduleFade_ms, scheduleCurve);
+        }
+    }
+    if (fadeActive) {
+        uint8_t level;
+
+        fadeElapsed_ms += FADE_TICK_mS;
+        if (fadeElapsed_ms >= fadeDuration_ms) {
+            level = fadeTarget;
+            fadeActive = false;
+        } else {
+            uint16_t e = Ease(fadeCurve, (uint16_t)((fadeElapsed_ms << 8) / fadeDuration_ms));
+            level = fadeStart + ((int)(fadeTarget - fadeStart) * e) / 256;
+        }
+        if (level != fadeLevel) {
+            fadeLevel = level;
+            fadePending = true;
+        }
+    }
+    if (fadePending && _trySelect()) {  // else, try again on the next tick
+        _FadeWrite(fadeLevel);
+        fadePending = false;
+    }
+    if (!fadeActive && !fadePending && !fadeSchedule)
+        fadeTicker.detach();
+}
+
+
+void RA8875::_FadeWrite(uint8_t brightness)
+{
+    uint8_t restore = lastCommand;
+
+    if (brightness && !pwmEnabled) {
+        _spiwrite(0x80); _spiwrite(0x8A);   // Enable the PWM
+        _spiwrite(0x00); _spiwrite(0x80);
+        _spiwrite(0x80); _spiwrite(0x8A);   // open PWM (SYS_CLK / 2)
+        _spiwrite(0x00); _spiwrite(0x81);
+        pwmEnabled = true;
+    }
+    _spiwrite(0x80); _spiwrite(0x8B);       // Brightness parameter
+    _spiwrite(0x00); _spiwrite(brightness);
+    _spiwrite(0x80); _spiwrite(restore);    // reselect what the foreground was using
+    _select(false);
+    lastCommand = restore;
+}
@@ -0,0 +1,133 @@
+/// This file contains the RA8875 boot splash methods.
+///
+/// The boot splash brings the display up and shows the first image
+/// sooner than the serial sequence of init, clear and render, by
+/// overlapping the file system work with the controller settling time,
+/// and by painting while the display is still off.
+///
+#include "RA8875.h"
+
+//#define DEBUG "RAbt"
+// ...
+// INFO("Stuff to show %d", var); // new-line is automatically appended
+//
+#if (defined(DEBUG) && !defined(TARGET_LPC11U24))
+#define INFO(x, ...) std::printf("[INF %s %4d] "x"\r\n", DEBUG, __LINE__, ##__VA_ARGS__);
+#define WARN(x, ...) std::printf("[WRN %s %4d] "x"\r\n", DEBUG, __LINE__, ##__VA_ARGS__);
+#define ERR(x, ...)  std::printf("[ERR %s %4d] "x"\r\n", DEBUG, __LINE__, ##__VA_ARGS__);
+#else
+#define INFO(x, ...)
+#define WARN(x, ...)
+#define ERR(x, ...)
+#endif
+
+
+RetCode_t RA8875::BootSplash(const PanelProfile_T & profile, const char * splash,
+    loc_t x, loc_t y, uint8_t brightness, bool keypadon, bool touchscreenon)
+{
+    rect_t full = { { 0, 0 }, { (loc_t)(profile.width - 1), (loc_t)(profile.height - 1) } };
+    RetCode_t ret;
+
+    memset(bootTime, 0, sizeof(bootTime));
+    bootTimer.reset();
+    bootTimer.start();
+    bootName = splash;
+    bootImage = NULL;
+    bootOffset = 0;
+    bootRect.p1.x = bootRect.p2.x = x;
+    bootRect.p1.y = bootRect.p2.y = y;
+    bootStep = 1;
+
+    // Layer 0 is not cleared here, and the display and backlight stay off.
+    // The preload runs during the settling delays of the register tables.
+    init(profile, 0, keypadon, touchscreenon, &full);
+    bootTime[BOOT_INIT] = bootTimer.read_us();
+    while (bootStep)                        // finish what the settling time did not cover
+        _BootPreload();
+
+    if (bootOffset)
+        _ClearAround(bootRect);
+    else
+        clsw(FULLWINDOW);
+    bootTime[BOOT_CLEAR] = bootTimer.read_us();
+
+    if (bootOffset) {
+        ret = _RenderBitmap(x, y, bootOffset, bootImage);  // closes the file on failure
+        if (ret == noerror) {
+            fclose(bootImage);
+        } else {
+            window(bootRect);
+            clsw(ACTIVEWINDOW);
+            window();
+        }
+    } else {
+        // RenderImageFile opens the file by name, so any other format is
+        // opened again here, and the preload saved nothing but the check
+        // that it exists.
+        if (bootImage)
+            fclose(bootImage);
+        ret = (bootImage) ? RenderImageFile(x, y, splash) : file_not_found;
+    }
+    bootImage = NULL;
+    bootTime[BOOT_PAINT] = bootTimer.read_us();
+
+    // Backlight and display on, in one burst.
+    const uint8_t show[] = {
+        0x8A, 0x80,                 // Enable the PWM
+        0x8A, 0x81,                 // open PWM (SYS_CLK / 2)
+        0x8B, brightness,           // Brightness parameter
+        0x01, 0x80                  // Display on
+    };
+    _WriteRegisterTable(show, sizeof(show)/2);
+    pwmEnabled = true;
+    fadeLevel = brightness;
+    bootTime[BOOT_SHOW] = bootTimer.read_us();
+    bootTimer.stop();
+    INFO("Boot: init %u, asset %u, clear %u, paint %u, show %u", bootTime[BOOT_INIT],
+        bootTime[BOOT_ASSET], bootTime[BOOT_CLEAR], bootTime[BOOT_PAINT], bootTime[BOOT_SHOW]);
+    return ret;
+}
+
+
+uint32_t RA8875::GetBootTime(BootPhase_T phase)
+{
+    if (phase >= BOOT_PHASECOUNT)
+        return 0;
+    return bootTime[phase];
+}
+
+
+void RA8875::_BootPreload(void)
+{
+    switch (bootStep) {
+        case 1:     // open the asset; the first file system access is usually the slow part
+            bootImage = fopen(bootName, "rb");
+            bootStep = (bootImage) ? 2 : 0;
+            break;
+        case 2: {   // read the header, so the clear can skip where a bitmap lands
+            BITMAPFILEHEADER fileHeader;
+            BITMAPINFOHEADER infoHeader;
+
+            if (fread(&fileHeader, 1, sizeof(fileHeader), bootImage) == sizeof(fileHeader)
+            && fileHeader.bfType == BF_TYPE
+            && fread(&infoHeader, 1, sizeof(infoHeader), bootImage) == sizeof(infoHeader)
+            && infoHeader.biWidth > 0 && infoHeader.biHeight > 0) {
+                // clamped to the loc_t range first, so a huge size cannot wrap
+                int32_t right = bootRect.p1.x + (int32_t)min(infoHeader.biWidth, (uint32_t)32767) - 1;
+                int32_t bottom = bootRect.p1.y + (int32_t)min(infoHeader.biHeight, (uint32_t)32767) - 1;
+
+                bootOffset = fileHeader.bfOffBits;
+                bootRect.p2.x = (loc_t)min(right, (int32_t)screenwidth - 1);
+                bootRect.p2.y = (loc_t)min(bottom, (int32_t)screenheight - 1);
+            }
+            fseek(bootImage, sizeof(fileHeader), SEEK_SET);     // where _RenderBitmap expects it
+            bootStep = 0;
+            break;
+        }
+        default:
+            bootStep = 0;
+            break;
+    }
+    if (bootStep == 0)
+        bootTime[BOOT_ASSET] = bootTimer.read_us();
+}
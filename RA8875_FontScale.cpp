@@ -0,0 +1,312 @@
+/// This file contains the RA8875 external font scaling methods.
+///
+/// A scaled glyph is produced once, from the font table, and kept in a
+/// small LRU cache in RAM. Later uses stream it as they would a native
+/// glyph, so the scaling cost is paid only on the first draw.
+///
+#include "RA8875.h"
+
+//#include "Utility.h"            // private memory manager
+#ifndef UTILITY_H
+#define swMalloc malloc         // use the standard
+#define swFree free
+#endif
+
+//#define DEBUG "RAfs"
+// ...
+// INFO("Stuff to show %d", var); // new-line is automatically appended
+//
+#if (defined(DEBUG) && !defined(TARGET_LPC11U24))
+#define INFO(x, ...) std::printf("[INF %s %4d] "x"\r\n", DEBUG, __LINE__, ##__VA_ARGS__);
+#define WARN(x, ...) std::printf("[WRN %s %4d] "x"\r\n", DEBUG, __LINE__, ##__VA_ARGS__);
+#define ERR(x, ...)  std::printf("[ERR %s %4d] "x"\r\n", DEBUG, __LINE__, ##__VA_ARGS__);
+#else
+#define INFO(x, ...)
+#define WARN(x, ...)
+#define ERR(x, ...)
+#endif
+
+#define SCALE_ONE   256         // 1.0 in 8.8 fixed point
+#define SCALED(n, s) ((dim_t)(((uint32_t)(n) * (s) + 128) >> 8))
+
+// A font glyph is stored a row at a time, each row starting on a byte,
+// with the left-most pixel in the least significant bit.
+static inline bool GlyphBit(const uint8_t * glyph, dim_t stride, dim_t x, dim_t y)
+{
+    return (glyph[y * stride + (x >> 3)] >> (x & 7)) & 1;
+}
+
+
+// The nearest source pixel of destination pixel (dx, dy), in a glyph
+// scaled from w x h to sw x sh.
+static inline bool NearestBit(const uint8_t * glyph, dim_t w, dim_t h, dim_t sw, dim_t sh,
+    dim_t dx, dim_t dy)
+{
+    return GlyphBit(glyph, (w + 7) / 8, (uint32_t)dx * w / sw, (uint32_t)dy * h / sh);
+}
+
+
+// The coverage, 0 to 15, of destination pixel (dx, dy), in a glyph scaled
+// from w x h to sw x sh. Coverage is the share of a 4 x 4 grid of samples,
+// spread evenly over the area of the destination pixel, that land on the
+// glyph.
+static uint8_t SmoothLevel(const uint8_t * glyph, dim_t w, dim_t h, dim_t sw, dim_t sh,
+    dim_t dx, dim_t dy)
+{
+    dim_t stride = (w + 7) / 8;
+    int hit = 0;
+
+    for (int j = 0; j < 4; j++) {
+        dim_t sy = ((uint32_t)(4 * dy + j) * 2 + 1) * h / (8 * (uint32_t)sh);
+
+        for (int k = 0; k < 4; k++) {
+            dim_t sx = ((uint32_t)(4 * dx + k) * 2 + 1) * w / (8 * (uint32_t)sw);
+
+            hit += GlyphBit(glyph, stride, sx, sy);
+        }
+    }
+    return (uint8_t)((hit * 15 + 8) / 16);
+}
+
+
+// The 16 colors from the background, at level 0, to the foreground, at 15.
+static void BlendShades(color_t bg, color_t fg, color_t shade[16], uint8_t shade8[16])
+{
+    int r0 = (bg >> 11) & 0x1F, g0 = (bg >> 5) & 0x3F, b0 = bg & 0x1F;
+    int r1 = (fg >> 11) & 0x1F, g1 = (fg >> 5) & 0x3F, b1 = fg & 0x1F;
+
+    for (int i = 0; i < 16; i++) {
+        shade[i] = ((r0 + (r1 - r0) * i / 15) << 11)
+            | ((g0 + (g1 - g0) * i / 15) << 5)
+            | (b0 + (b1 - b0) * i / 15);
+    }
+    RGB565ToRGB332(shade8, shade, 16);
+}
+
+
+RetCode_t RA8875::SetUserFontScale(float hScale, float vScale, FontScaleMode_T mode)
+{
+    if (vScale == 0)
+        vScale = hScale;
+    if (hScale < 0.25 || hScale > 8.0 || vScale < 0.25 || vScale > 8.0 || mode > FontSmooth)
+        return bad_parameter;
+    fontScaleX = (uint16_t)(hScale * SCALE_ONE + 0.5);
+    fontScaleY = (uint16_t)(vScale * SCALE_ONE + 0.5);
+    fontScaleMode = mode;
+    return noerror;
+}
+
+
+RetCode_t RA8875::FlushGlyphCache(void)
+{
+    for (int i = 0; i < RA8875_GLYPH_CACHE_ENTRIES; i++)
+        _FreeGlyph(&glyphCache[i]);
+    return noerror;
+}
+
+
+uint32_t RA8875::GetGlyphCacheStats(uint32_t * hits, uint32_t * misses)
+{
+    if (hits)
+        *hits = glyphHits;
+    if (misses)
+        *misses = glyphMisses;
+    return glyphCacheBytes;
+}
+
+
+const uint8_t * RA8875::getCharMetrics(const unsigned char c, dim_t * width, dim_t * height)
+{
+    const uint8_t * charRecord = GraphicsDisplay::getCharMetrics(c, width, height);
+
+    if (charRecord) {
+        if (width && fontScaleX != SCALE_ONE)
+            *width = max(SCALED(*width, fontScaleX), 1);
+        if (height && fontScaleY != SCALE_ONE)
+            *height = max(SCALED(*height, fontScaleY), 1);
+    }
+    return charRecord;
+}
+
+
+int RA8875::fontblit(loc_t x, loc_t y, const unsigned char c)
+{
+    Glyph_T * g;
+
+    if (fontScaleX == SCALE_ONE && fontScaleY == SCALE_ONE)
+        return GraphicsDisplay::fontblit(x, y, c);
+    g = _GetScaledGlyph(c);
+    if (g == NULL)
+        return _StreamScaledGlyph(x, y, c);     // too big for the cache, or no ram for it
+    if (g->mode == FontNearest) {
+        booleanStream(x, y, g->w, g->h, g->data);
+    } else {
+        // Blend each of the 16 coverage levels once, then stream the glyph.
+        color_t shade[16];
+        uint8_t shade8[16];
+        rect_t restore = windowrect;
+        uint32_t count = (uint32_t)g->w * g->h;
+        const uint8_t * p = g->data;
+
+        BlendShades(_background, _foreground, shade, shade8);
+        _WindowRect(x, y, g->w, g->h);
+        _BeginBlit(x, y, true);
+        _select(true);
+        _spiwrite(0x00);         // Cmd: write data
+        for (uint32_t i = 0; i < count; i++) {
+            uint8_t level = (i & 1) ? (p[i >> 1] >> 4) : (p[i >> 1] & 0x0F);
+
+            if (screenbpp == 16) {
+                _spiwrite(shade[level] >> 8);
+                _spiwrite(shade[level] & 0xFF);
+            } else {
+                _spiwrite(shade8[level]);
+            }
+        }
+        _select(false);
+        _EndGraphicsStream();
+        window(restore);
+    }
+    return g->w;
+}
+
+
+int RA8875::_StreamScaledGlyph(loc_t x, loc_t y, const unsigned char c)
+{
+    const uint8_t * charRecord;
+    dim_t w, h, sw, sh;
+    color_t shade[16];
+    uint8_t shade8[16];
+    rect_t restore = windowrect;
+
+    charRecord = GraphicsDisplay::getCharMetrics(c, &w, &h);
+    if (charRecord == NULL || w == 0)
+        return 0;
+    sw = max(SCALED(w, fontScaleX), 1);
+    sh = max(SCALED(h, fontScaleY), 1);
+    BlendShades(_background, _foreground, shade, shade8);
+    _WindowRect(x, y, sw, sh);
+    _BeginBlit(x, y, true);
+    _select(true);
+    _spiwrite(0x00);         // Cmd: write data
+    for (dim_t dy = 0; dy < sh; dy++) {
+        for (dim_t dx = 0; dx < sw; dx++) {
+            uint8_t level;
+
+            if (fontScaleMode == FontNearest)
+                level = NearestBit(charRecord, w, h, sw, sh, dx, dy) ? 15 : 0;
+            else
+                level = SmoothLevel(charRecord, w, h, sw, sh, dx, dy);
+            if (screenbpp == 16) {
+                _spiwrite(shade[level] >> 8);
+                _spiwrite(shade[level] & 0xFF);
+            } else {
+                _spiwrite(shade8[level]);
+            }
+        }
+    }
+    _select(false);
+    _EndGraphicsStream();
+    window(restore);
+    return sw;
+}
+
+
+RA8875::Glyph_T * RA8875::_GetScaledGlyph(const unsigned char c)
+{
+    Glyph_T * g = NULL;
+    Glyph_T * lru = &glyphCache[0];
+    const uint8_t * charRecord;
+    dim_t w, h, sw, sh;
+    uint32_t bytes;
+    int i;
+
+    glyphClock++;
+    for (i = 0; i < RA8875_GLYPH_CACHE_ENTRIES; i++) {
+        Glyph_T * e = &glyphCache[i];
+
+        if (e->font == font && e->c == c && e->scaleX == fontScaleX
+        && e->scaleY == fontScaleY && e->mode == fontScaleMode) {
+            e->used = glyphClock;
+            glyphHits++;
+            return e;
+        }
+        if (e->font == NULL)
+            lru = e;
+        else if (lru->font && e->used < lru->used)
+            lru = e;
+    }
+    glyphMisses++;
+    charRecord = GraphicsDisplay::getCharMetrics(c, &w, &h);
+    if (charRecord == NULL || w == 0)
+        return NULL;
+    sw = max(SCALED(w, fontScaleX), 1);
+    sh = max(SCALED(h, fontScaleY), 1);
+    if (fontScaleMode == FontNearest)
+        bytes = ((sw + 7) / 8) * sh;
+    else
+        bytes = ((uint32_t)sw * sh + 1) / 2;
+    if (bytes > RA8875_GLYPH_CACHE_BYTES)
+        return NULL;                        // fontblit streams it uncached
+
+    // Make room, oldest first
+    _FreeGlyph(lru);
+    while (glyphCacheBytes + bytes > RA8875_GLYPH_CACHE_BYTES) {
+        Glyph_T * oldest = NULL;
+
+        for (i = 0; i < RA8875_GLYPH_CACHE_ENTRIES; i++) {
+            if (glyphCache[i].font && (oldest == NULL || glyphCache[i].used < oldest->used))
+                oldest = &glyphCache[i];
+        }
+        _FreeGlyph(oldest);
+    }
+    g = lru;
+    g->data = (uint8_t *)swMalloc(bytes);
+    if (g->data == NULL) {
+        ERR("Not enough RAM for a scaled glyph");
+        return NULL;
+    }
+    memset(g->data, 0, bytes);
+    if (fontScaleMode == FontNearest) {
+        dim_t dstride = (sw + 7) / 8;
+
+        for (dim_t dy = 0; dy < sh; dy++) {
+            for (dim_t dx = 0; dx < sw; dx++) {
+                if (NearestBit(charRecord, w, h, sw, sh, dx, dy))
+                    g->data[dy * dstride + (dx >> 3)] |= 1 << (dx & 7);
+            }
+        }
+    } else {
+        uint32_t n = 0;
+
+        for (dim_t dy = 0; dy < sh; dy++) {
+            for (dim_t dx = 0; dx < sw; dx++, n++)
+                g->data[n >> 1] |= SmoothLevel(charRecord, w, h, sw, sh, dx, dy) << ((n & 1) ? 4 : 0);
+        }
+    }
+    g->font = font;
+    g->c = c;
+    g->scaleX = fontScaleX;
+    g->scaleY = fontScaleY;
+    g->mode = fontScaleMode;
+    g->w = sw;
+    g->h = sh;
+    g->used = glyphClock;
+    glyphCacheBytes += bytes;
+    INFO("glyph '%c' %dx%d -> %dx%d, %u bytes, cache %u", c, w, h, sw, sh, bytes, glyphCacheBytes);
+    return g;
+}
+
+
+void RA8875::_FreeGlyph(Glyph_T * g)
+{
+    if (g && g->font) {
+        if (g->mode == FontNearest)
+            glyphCacheBytes -= ((g->w + 7) / 8) * g->h;
+        else
+            glyphCacheBytes -= ((uint32_t)g->w * g->h + 1) / 2;
+        swFree(g->data);
+        g->data = NULL;
+        g->font = NULL;
+    }
+}
@@ -0,0 +1,174 @@
+/// This file contains the RA8875 sleep and resume methods.
+///
+/// The register state is captured when going to sleep, and kept as a
+/// packed register table, so the resume is a single batched write
+/// rather than a full init and repaint.
+///
+#include "RA8875.h"
+
+//#define DEBUG "RAsl"
+// ...
+// INFO("Stuff to show %d", var); // new-line is automatically appended
+//
+#if (defined(DEBUG) && !defined(TARGET_LPC11U24))
+#define INFO(x, ...) std::printf("[INF %s %4d] "x"\r\n", DEBUG, __LINE__, ##__VA_ARGS__);
+#define WARN(x, ...) std::printf("[WRN %s %4d] "x"\r\n", DEBUG, __LINE__, ##__VA_ARGS__);
+#define ERR(x, ...)  std::printf("[ERR %s %4d] "x"\r\n", DEBUG, __LINE__, ##__VA_ARGS__);
+#else
+#define INFO(x, ...)
+#define WARN(x, ...)
+#define ERR(x, ...)
+#endif
+
+
+// The registers restored after a deep sleep, in the order they are written.
+// The PLL is first, so it can lock while the rest are written.
+static const uint8_t PllRegs[] = {
+    0x88, 0x89                              // PLLC1, PLLC2
+};
+static const uint8_t StateRegs[] = {
+    0x04, 0x10,                             // PCSR, SYSR
+    0x14, 0x15, 0x16, 0x17, 0x18,           // HDWR, HNDFTR, HNDR, HSTR, HPWR
+    0x19, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F,   // VDHR0,1, VNDR0,1, VSTR0,1, VPWR
+    0x20, 0x21, 0x22, 0x23,                 // DPCR, FNCR0, FNCR1, CGSR
+    0x24, 0x25, 0x26, 0x27, 0x29, 0x2E, 0x2F,   // HOFS0,1, VOFS0,1, FLDR, FWTSET, SFRSET
+    0x30, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37, // active window
+    0x38, 0x39, 0x3A, 0x3B, 0x3C, 0x3D, 0x3E, 0x3F, // scroll window
+    0x40, 0x41, 0x44, 0x45,                 // MWCR0, MWCR1, BTCR, MRCD
+    0x46, 0x47, 0x48, 0x49,                 // memory write cursor
+    0x4E, 0x4F, 0x52, 0x53,                 // CURHS, CURVS, LTPR0, LTPR1
+    0x60, 0x61, 0x62, 0x63, 0x64, 0x65,     // background and foreground colors
+    0x67, 0x68, 0x69,                       // background color for transparency
+    0x70, 0x71,                             // TPCR0, TPCR1
+    0x80, 0x81, 0x82, 0x83, 0x84, 0x85,     // graphic cursor
+    0xC0, 0xC1, 0xF0                        // KSCR1, KSCR2, INTC1
+};
+static const uint8_t ShowRegs[] = {
+    0x8A, 0x8B                              // P1CR, P1DCR - the backlight
+};
+
+// Pairs beyond the captured registers - wake, the PLL delay and display on.
+#define SLEEP_EXTRA_PAIRS 3
+
+// The deep sleep table must fit in sleepTable. This fails to compile when
+// a register is added to the lists above without raising RA8875_SLEEP_TABLE.
+typedef char SleepTableFits[((sizeof(PllRegs) + sizeof(StateRegs) + sizeof(ShowRegs)
+    + SLEEP_EXTRA_PAIRS) * 2 <= RA8875_SLEEP_TABLE) ? 1 : -1];
+
+
+RetCode_t RA8875::Sleep(SleepMode_T mode, uint8_t validLayers)
+{
+    uint8_t * p = sleepTable;
+    uint8_t dpcr = 0;
+    uint8_t ltpr0 = 0;
+    uint8_t shown;
+    unsigned int i;
+
+    if (mode > SleepDeep || validLayers > 0x03)
+        return bad_parameter;
+    if (sleeping)
+        return noerror;
+    fadeTicker.detach();                    // the backlight is restored by the resume
+    fadeActive = fadePending = false;
+    _WaitWhileBusy(0x80);                   // let any drawing finish
+    if (mode == SleepDeep) {
+        *p++ = 0x01; *p++ = 0x00;           // wake, with the display off
+        for (i = 0; i < sizeof(PllRegs); i++) {
+            *p++ = PllRegs[i];
+            *p++ = ReadCommand(PllRegs[i]);
+        }
+        *p++ = RA8875_REG_DELAY; *p++ = 1;  // let the PLL lock
+        for (i = 0; i < sizeof(StateRegs); i++) {
+            *p++ = StateRegs[i];
+            *p++ = ReadCommand(StateRegs[i]);
+            if (StateRegs[i] == 0x20)
+                dpcr = p[-1];
+            else if (StateRegs[i] == 0x52)
+                ltpr0 = p[-1];
+        }
+    } else {
+        dpcr = ReadCommand(0x20);
+        ltpr0 = ReadCommand(0x52);
+    }
+    sleepShow = (p - sleepTable) / 2;
+    for (i = 0; i < sizeof(ShowRegs); i++) {
+        *p++ = ShowRegs[i];
+        *p++ = ReadCommand(ShowRegs[i]);
+    }
+    *p++ = 0x01; *p++ = 0x80;               // display on
+    sleepCount = (p - sleepTable) / 2;
+
+    // Layer 0 alone is shown in 1-layer mode, else it depends on the layer mode.
+    if ((dpcr & 0x80) == 0 || (ltpr0 & 0x07) == ShowLayer0)
+        shown = 0x01;
+    else if ((ltpr0 & 0x07) == ShowLayer1)
+        shown = 0x02;
+    else
+        shown = 0x03;
+    sleepShowOnResume = ((shown & validLayers) == shown);   // else it is left off for a repaint
+    INFO("Sleep(%d) %d pairs, shown %02X, valid %02X", mode, sleepCount, shown, validLayers);
+
+    const uint8_t enter[] = {
+        0x8A, 0x00,                         // Disable the PWM
+        0x01, 0x00,                         // Display off
+        0x01, (uint8_t)((mode == SleepDeep) ? 0x02 : 0x00)  // Sleep
+    };
+    _WriteRegisterTable(enter, sizeof(enter)/2);
+    pwmEnabled = false;
+    sleeping = true;
+    resumeShowPending = false;
+    return noerror;
+}
+
+
+RetCode_t RA8875::Resume(void)
+{
+    if (!sleeping)
+        return noerror;
+    resumeTimer.reset();
+    resumeTimer.start();
+    resumeTime = 0;
+    sleeping = false;
+    if (sleepShowOnResume) {
+        _WriteRegisterTable(sleepTable, sleepCount);
+        _ResumeShown();
+    } else {
+        _WriteRegisterTable(sleepTable, sleepShow);     // Power(true) writes the rest
+        resumeShowPending = true;
+    }
+    if (fadeSchedule)
+        AttachBacklightSchedule(fadeSchedule, scheduleInterval_ms, scheduleFade_ms, scheduleCurve);
+    return noerror;
+}
+
+
+void RA8875::_ResumeShow(void)
+{
+    _WriteRegisterTable(sleepTable + 2 * sleepShow, sleepCount - sleepShow);
+    _ResumeShown();
+}
+
+
+void RA8875::_ResumeShown(void)
+{
+    const uint8_t * show = sleepTable + 2 * sleepShow;     // P1CR, P1DCR
+
+    pwmEnabled = (show[1] & 0x80) != 0;
+    fadeLevel = show[3];
+    resumeTime = resumeTimer.read_us();
+    resumeTimer.stop();
+    resumeShowPending = false;
+    INFO("Resume %u usec", resumeTime);
+}
+
+
+bool RA8875::IsSleeping(void)
+{
+    return sleeping;
+}
+
+
+uint32_t RA8875::GetResumeTime(void)
+{
+    return resumeTime;
+}
@@ -0,0 +1,450 @@
+/// This file contains the Region methods.
+///
+/// Every operation is a sweep from the top, one slab at a time, where a
+/// slab is the rows between two band edges of either operand. Within a
+/// slab each operand is a sorted list of spans, so the operation is a
+/// merge of two lists, and a slab whose spans match the band above is
+/// joined to it.
+///
+#include "Region.h"
+
+#define REGION_MIN(a,b) (((a) < (b)) ? (a) : (b))
+#define REGION_MAX(a,b) (((a) > (b)) ? (a) : (b))
+
+
+static rect_t Normalize(const rect_t & r)
+{
+    rect_t n;
+
+    n.p1.x = REGION_MIN(r.p1.x, r.p2.x);
+    n.p1.y = REGION_MIN(r.p1.y, r.p2.y);
+    n.p2.x = REGION_MAX(r.p1.x, r.p2.x);
+    n.p2.y = REGION_MAX(r.p1.y, r.p2.y);
+    return n;
+}
+
+
+static uint32_t RectArea(const rect_t & r)
+{
+    return (uint32_t)(r.p2.x - r.p1.x + 1) * (uint32_t)(r.p2.y - r.p1.y + 1);
+}
+
+
+static rect_t Bound(const rect_t & a, const rect_t & b)
+{
+    rect_t r;
+
+    r.p1.x = REGION_MIN(a.p1.x, b.p1.x);
+    r.p1.y = REGION_MIN(a.p1.y, b.p1.y);
+    r.p2.x = REGION_MAX(a.p2.x, b.p2.x);
+    r.p2.y = REGION_MAX(a.p2.y, b.p2.y);
+    return r;
+}
+
+
+static uint32_t OverlapArea(const rect_t & a, const rect_t & b)
+{
+    int32_t w = REGION_MIN(a.p2.x, b.p2.x) - REGION_MAX(a.p1.x, b.p1.x) + 1;
+    int32_t h = REGION_MIN(a.p2.y, b.p2.y) - REGION_MAX(a.p1.y, b.p1.y) + 1;
+
+    return (w > 0 && h > 0) ? (uint32_t)w * (uint32_t)h : 0;
+}
+
+
+Region::Region(int _capacity)
+{
+    capacity = (_capacity > 0) ? _capacity : 1;
+    rects = (rect_t *)malloc(capacity * sizeof(rect_t));
+    if (rects == NULL)
+        capacity = 0;
+    count = 0;
+    owned = true;
+}
+
+
+Region::Region(rect_t * buffer, int _capacity)
+{
+    rects = buffer;
+    capacity = (buffer && _capacity > 0) ? _capacity : 0;
+    count = 0;
+    owned = false;
+}
+
+
+Region::~Region()
+{
+    if (owned)
+        free(rects);
+}
+
+
+void Region::Set(const rect_t & r)
+{
+    count = 0;
+    if (capacity) {
+        rects[0] = Normalize(r);
+        count = 1;
+    }
+}
+
+
+RetCode_t Region::Set(const Region & other)
+{
+    if (&other == this)
+        return noerror;
+    if (other.count > capacity) {
+        _Overflow(other.rects, other.count);
+        return not_enough_ram;
+    }
+    for (int i=0; i<other.count; i++)
+        rects[i] = other.rects[i];
+    count = other.count;
+    return noerror;
+}
+
+
+rect_t Region::Bounds(void) const
+{
+    rect_t b = { { 0, 0 }, { -1, -1 } };
+
+    if (count) {
+        b = rects[0];
+        for (int i=1; i<count; i++)
+            b = Bound(b, rects[i]);
+    }
+    return b;
+}
+
+
+uint32_t Region::Area(void) const
+{
+    uint32_t a = 0;
+
+    for (int i=0; i<count; i++)
+        a += RectArea(rects[i]);
+    return a;
+}
+
+
+bool Region::Contains(point_t p) const
+{
+    for (int i=0; i<count && rects[i].p1.y <= p.y; i++) {
+        if (p.y <= rects[i].p2.y && p.x >= rects[i].p1.x && p.x <= rects[i].p2.x)
+            return true;
+    }
+    return false;
+}
+
+
+bool Region::Contains(const rect_t & _r) const
+{
+    rect_t r = Normalize(_r);
+    uint32_t a = 0;
+
+    for (int i=0; i<count && rects[i].p1.y <= r.p2.y; i++)
+        a += OverlapArea(rects[i], r);          // the rectangles do not overlap
+    return a == RectArea(r);
+}
+
+
+bool Region::Overlaps(const rect_t & _r) const
+{
+    rect_t r = Normalize(_r);
+
+    for (int i=0; i<count && rects[i].p1.y <= r.p2.y; i++) {
+        if (OverlapArea(rects[i], r))
+            return true;
+    }
+    return false;
+}
+
+
+RetCode_t Region::Union(const rect_t & r)
+{
+    rect_t n = Normalize(r);
+
+    return _Op(&n, 1, OpUnion);
+}
+
+
+RetCode_t Region::Union(const Region & other)
+{
+    return _Op(other.rects, other.count, OpUnion);
+}
+
+
+RetCode_t Region::Subtract(const rect_t & r)
+{
+    rect_t n = Normalize(r);
+
+    return _Op(&n, 1, OpSubtract);
+}
+
+
+RetCode_t Region::Subtract(const Region & other)
+{
+    return _Op(other.rects, other.count, OpSubtract);
+}
+
+
+RetCode_t Region::Intersect(const rect_t & r)
+{
+    rect_t n = Normalize(r);
+
+    return _Op(&n, 1, OpIntersect);
+}
+
+
+RetCode_t Region::Intersect(const Region & other)
+{
+    return _Op(other.rects, other.count, OpIntersect);
+}
+
+
+// When a result does not fit, keep a superset that does: the bounding
+// box of the result.
+void Region::_Overflow(const rect_t * result, int n)
+{
+    rect_t b = result[0];
+
+    for (int i=1; i<n; i++)
+        b = Bound(b, result[i]);
+    Set(b);
+}
+
+
+// The band of list that covers row y, from index *i onward, which moves
+// past the bands above y. Returns the number of rectangles in the band.
+static int Band(const rect_t * list, int n, int * i, loc_t y)
+{
+    int k;
+
+    while (*i < n && list[*i].p2.y < y)
+        (*i)++;
+    if (*i >= n || list[*i].p1.y > y)
+        return 0;
+    for (k=*i; k<n && list[k].p1.y == list[*i].p1.y; k++)
+        ;
+    return k - *i;
+}
+
+
+// Where the band of list at index i next changes, at or after row y.
+static int32_t NextEdge(const rect_t * list, int n, int i, loc_t y)
+{
+    if (i >= n)
+        return INT32_MAX;
+    return (list[i].p1.y > y) ? list[i].p1.y : list[i].p2.y + 1;
+}
+
+
+RetCode_t Region::_Op(const rect_t * b, int bCount, Op_T op)
+{
+    rect_t result[REGION_MAX_RESULT];
+    loc_t span[REGION_MAX_RESULT][2];
+    int limit = REGION_MIN(capacity, REGION_MAX_RESULT);
+    int n = 0;
+    int ai = 0, bi = 0;
+    int bandStart = 0, bandCount = 0;           // the last band emitted
+    int32_t y, next;
+
+    if (op == OpIntersect && (count == 0 || bCount == 0)) {
+        count = 0;
+        return noerror;
+    }
+    if (op != OpUnion && (count == 0 || bCount == 0))
+        return noerror;
+    if (op == OpUnion && bCount == 0)
+        return noerror;
+    y = REGION_MIN(NextEdge(rects, count, 0, INT16_MIN), NextEdge(b, bCount, 0, INT16_MIN));
+    while (y != INT32_MAX) {
+        int aN = Band(rects, count, &ai, (loc_t)y);
+        int bN = Band(b, bCount, &bi, (loc_t)y);
+        const rect_t * a = rects + ai;
+        const rect_t * c = b + bi;
+        int spans = 0;
+        int i = 0, j = 0;
+
+        next = REGION_MIN(NextEdge(rects, count, ai, (loc_t)y), NextEdge(b, bCount, bi, (loc_t)y));
+        if (op == OpUnion) {                    // merge by left edge, joining what touches
+            while (i < aN || j < bN) {
+                const rect_t * r = (j >= bN || (i < aN && a[i].p1.x <= c[j].p1.x)) ? &a[i++] : &c[j++];
+
+                if (spans && r->p1.x <= span[spans - 1][1] + 1) {
+                    span[spans - 1][1] = REGION_MAX(span[spans - 1][1], r->p2.x);
+                } else if (spans < REGION_MAX_RESULT) {
+                    span[spans][0] = r->p1.x;
+                    span[spans++][1] = r->p2.x;
+                } else {
+                    n = limit + 1;              // overflow
+                    break;
+                }
+            }
+        } else if (op == OpIntersect) {
+            while (i < aN && j < bN) {
+                loc_t lo = REGION_MAX(a[i].p1.x, c[j].p1.x);
+                loc_t hi = REGION_MIN(a[i].p2.x, c[j].p2.x);
+
+                if (lo <= hi && spans < REGION_MAX_RESULT) {
+                    span[spans][0] = lo;
+                    span[spans++][1] = hi;
+                }
+                if (a[i].p2.x < c[j].p2.x)
+                    i++;
+                else
+                    j++;
+            }
+        } else {                                // subtract
+            for (i=0; i<aN; i++) {
+                int32_t cur = a[i].p1.x;
+
+                while (j < bN && c[j].p2.x < a[i].p1.x)
+                    j++;
+                for (int k=j; k<bN && c[k].p1.x <= a[i].p2.x && cur <= a[i].p2.x; k++) {
+                    if (c[k].p1.x > cur && spans < REGION_MAX_RESULT) {
+                        span[spans][0] = (loc_t)cur;
+                        span[spans++][1] = c[k].p1.x - 1;
+                    }
+                    cur = REGION_MAX(cur, c[k].p2.x + 1);
+                }
+                if (cur <= a[i].p2.x && spans < REGION_MAX_RESULT) {
+                    span[spans][0] = (loc_t)cur;
+                    span[spans++][1] = a[i].p2.x;
+                }
+            }
+        }
+        if (n > limit)
+            break;
+        if (spans) {
+            bool join = (bandCount == spans && result[bandStart].p2.y + 1 == y);
+
+            for (int k=0; join && k<spans; k++)
+                join = (result[bandStart + k].p1.x == span[k][0] && result[bandStart + k].p2.x == span[k][1]);
+            if (join) {                         // the same spans as the band above, so grow it
+                for (int k=0; k<spans; k++)
+                    result[bandStart + k].p2.y = (loc_t)(next - 1);
+            } else if (n + spans > limit) {
+                n = limit + 1;
+                break;
+            } else {
+                bandStart = n;
+                bandCount = spans;
+                for (int k=0; k<spans; k++, n++) {
+                    result[n].p1.x = span[k][0];
+                    result[n].p1.y = (loc_t)y;
+                    result[n].p2.x = span[k][1];
+                    result[n].p2.y = (loc_t)(next - 1);
+                }
+            }
+        }
+        y = next;
+    }
+    if (n > limit) {
+        if (op == OpUnion) {                    // the bounding box of both
+            rect_t bb = Bounds();
+
+            for (int k=0; k<bCount; k++)
+                bb = (count || k) ? Bound(bb, b[k]) : b[k];
+            Set(bb);
+        }
+        // A subtraction or intersection keeps what it had, which is a superset.
+        return not_enough_ram;
+    }
+    for (int k=0; k<n; k++)
+        rects[k] = result[k];
+    count = n;
+    return noerror;
+}
+
+
+// The bytes a merge of two rectangles saves, less the bytes of the pixels
+// it adds, so the best merge has the least.
+static int32_t MergeCost(const rect_t & a, const rect_t & b, uint32_t rectCost, uint32_t pixelCost)
+{
+    int32_t extra = (int32_t)RectArea(Bound(a, b)) - (int32_t)RectArea(a) - (int32_t)RectArea(b)
+        + (int32_t)OverlapArea(a, b);
+
+    return extra * (int32_t)pixelCost - (int32_t)rectCost;
+}
+
+
+int Region::Simplify(rect_t * out, int maxRects, uint32_t rectCost, uint32_t pixelCost) const
+{
+    rect_t w[REGION_MAX_RESULT];
+    int32_t cost[REGION_MAX_RESULT];            // of the best merge of each
+    uint8_t with[REGION_MAX_RESULT];            // and with which
+    bool gone[REGION_MAX_RESULT];
+    int total = REGION_MIN(count, REGION_MAX_RESULT);
+    int n = total;
+
+    if (maxRects <= 0 || count == 0)
+        return 0;
+    for (int i=0; i<total; i++) {
+        w[i] = rects[i];
+        gone[i] = false;
+    }
+    for (int i=total; i<count; i++)             // more than the scratch holds, fold into the last
+        w[total - 1] = Bound(w[total - 1], rects[i]);
+    for (int i=0; i<total; i++)
+        _Nearest(w, gone, total, i, &cost[i], &with[i], rectCost, pixelCost);
+    while (n > 1) {
+        int bi = -1;
+
+        for (int i=0; i<total; i++) {
+            if (!gone[i] && (bi < 0 || cost[i] < cost[bi]))
+                bi = i;
+        }
+        if (n <= maxRects && cost[bi] >= 0)
+            break;
+        w[bi] = Bound(w[bi], w[with[bi]]);
+        gone[with[bi]] = true;
+        n--;
+        for (int k=0; k<total; k++) {           // and drop what the merge swallowed
+            if (!gone[k] && k != bi && OverlapArea(w[k], w[bi]) == RectArea(w[k])) {
+                gone[k] = true;
+                n--;
+            }
+        }
+        // Only the merges with the grown rectangle, or with one that is
+        // gone, have changed.
+        _Nearest(w, gone, total, bi, &cost[bi], &with[bi], rectCost, pixelCost);
+        for (int k=0; k<total; k++) {
+            if (gone[k] || k == bi)
+                continue;
+            if (with[k] == bi || gone[with[k]]) {
+                _Nearest(w, gone, total, k, &cost[k], &with[k], rectCost, pixelCost);
+            } else {
+                int32_t c = MergeCost(w[k], w[bi], rectCost, pixelCost);
+
+                if (c < cost[k]) {
+                    cost[k] = c;
+                    with[k] = (uint8_t)bi;
+                }
+            }
+        }
+    }
+    n = 0;
+    for (int i=0; i<total; i++) {
+        if (!gone[i])
+            out[n++] = w[i];
+    }
+    return n;
+}
+
+
+void Region::_Nearest(const rect_t * w, const bool * gone, int total, int i,
+    int32_t * cost, uint8_t * with, uint32_t rectCost, uint32_t pixelCost)
+{
+    *cost = INT32_MAX;
+    *with = (uint8_t)i;
+    for (int j=0; j<total; j++) {
+        if (j != i && !gone[j]) {
+            int32_t c = MergeCost(w[i], w[j], rectCost, pixelCost);
+
+            if (c < *cost) {
+                *cost = c;
+                *with = (uint8_t)j;
+            }
+        }
+    }
+}
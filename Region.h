@@ -0,0 +1,228 @@
+/// Region - sets of rectangles, for damage, clipping and occlusion.
+///
+/// A region is a list of rectangles that do not overlap, kept in bands:
+/// sorted from the top, then from the left, where every rectangle of a
+/// band has the same top and bottom, and bands that could join do. So
+/// two regions that cover the same pixels have the same rectangles.
+///
+/// This depends only on DisplayDefs.h, so it builds and can be tested
+/// on the host as well.
+///
+#ifndef REGION_H
+#define REGION_H
+#include <stdint.h>
+#include <stdlib.h>
+#include "DisplayDefs.h"
+
+/// The capacity of a region made with the default constructor.
+#ifndef REGION_DEFAULT_CAPACITY
+#define REGION_DEFAULT_CAPACITY 32
+#endif
+
+/// The most rectangles an operation can produce, which is the size of
+/// the scratch space it uses on the stack.
+#ifndef REGION_MAX_RESULT
+#define REGION_MAX_RESULT 64
+#endif
+
+/// A banded set of rectangles, of fixed capacity.
+///
+/// No operation allocates. The capacity is allocated once, when the
+/// region is made, or the caller gives the storage, so a region can be
+/// used where the heap is not.
+///
+/// When the result of an operation would not fit, the region becomes a
+/// superset of it, by merging rectangles, and the operation returns
+/// not_enough_ram. A superset is the safe error, since it draws too
+/// much rather than too little.
+///
+/// A region cannot be copied or passed by value. Pass it by reference,
+/// or Set() one region from another.
+///
+/// @code
+/// rect_t store[16];
+/// Region damage(store, 16);
+///
+/// damage.Union(buttonRect);
+/// damage.Union(sliderRect);
+/// damage.Subtract(opaquePopupRect);     // hidden, so not drawn
+/// rect_t flush[4];
+/// int n = damage.Simplify(flush, 4);
+/// @endcode
+///
+class Region
+{
+public:
+    /// Constructor for an empty region, that allocates its capacity once.
+    ///
+    /// @param[in] capacity is the most rectangles it can hold.
+    ///
+    Region(int capacity = REGION_DEFAULT_CAPACITY);
+
+    /// Constructor for an empty region, in storage given by the caller.
+    ///
+    /// @param[in] buffer is the storage.
+    /// @param[in] capacity is the number of rectangles in the storage.
+    ///
+    Region(rect_t * buffer, int capacity);
+
+    /// Destructor, which frees the storage it allocated.
+    ///
+    ~Region();
+
+    /// Make the region empty.
+    ///
+    void Clear(void) { count = 0; }
+
+    /// Make the region one rectangle.
+    ///
+    /// @param[in] r is the rectangle, whose corners may be in any order.
+    ///
+    void Set(const rect_t & r);
+
+    /// Make the region a copy of another.
+    ///
+    /// @param[in] other is the region to copy.
+    /// @returns success/failure code. @see RetCode_t.
+    ///
+    RetCode_t Set(const Region & other);
+
+    /// Is the region empty.
+    ///
+    /// @returns true when it covers nothing.
+    ///
+    bool IsEmpty(void) const { return count == 0; }
+
+    /// Get the number of rectangles.
+    ///
+    /// @returns the count.
+    ///
+    int Count(void) const { return count; }
+
+    /// Get the capacity.
+    ///
+    /// @returns the most rectangles it can hold.
+    ///
+    int Capacity(void) const { return capacity; }
+
+    /// Get one of the rectangles.
+    ///
+    /// @param[in] i is the index, from 0 to Count() - 1.
+    /// @returns the rectangle.
+    ///
+    const rect_t & Rect(int i) const { return rects[i]; }
+
+    /// Get the bounding box.
+    ///
+    /// @returns the smallest rectangle that holds the region, which is
+    ///         not meaningful when it is empty.
+    ///
+    rect_t Bounds(void) const;
+
+    /// Get the area.
+    ///
+    /// @returns the number of pixels it covers.
+    ///
+    uint32_t Area(void) const;
+
+    /// Does the region hold a point.
+    ///
+    /// @param[in] p is the point.
+    /// @returns true when it does.
+    ///
+    bool Contains(point_t p) const;
+
+    /// Does the region hold all of a rectangle.
+    ///
+    /// @param[in] r is the rectangle.
+    /// @returns true when it does.
+    ///
+    bool Contains(const rect_t & r) const;
+
+    /// Does the region touch a rectangle.
+    ///
+    /// @param[in] r is the rectangle.
+    /// @returns true when they share a pixel.
+    ///
+    bool Overlaps(const rect_t & r) const;
+
+    /// Add a rectangle.
+    ///
+    /// @param[in] r is the rectangle.
+    /// @returns success/failure code. @see RetCode_t.
+    ///
+    RetCode_t Union(const rect_t & r);
+
+    /// Add a region.
+    ///
+    /// @param[in] other is the region.
+    /// @returns success/failure code. @see RetCode_t.
+    ///
+    RetCode_t Union(const Region & other);
+
+    /// Remove a rectangle.
+    ///
+    /// @param[in] r is the rectangle.
+    /// @returns success/failure code. @see RetCode_t.
+    ///
+    RetCode_t Subtract(const rect_t & r);
+
+    /// Remove a region.
+    ///
+    /// @param[in] other is the region.
+    /// @returns success/failure code. @see RetCode_t.
+    ///
+    RetCode_t Subtract(const Region & other);
+
+    /// Keep only what is within a rectangle.
+    ///
+    /// @param[in] r is the rectangle.
+    /// @returns success/failure code. @see RetCode_t.
+    ///
+    RetCode_t Intersect(const rect_t & r);
+
+    /// Keep only what is within a region.
+    ///
+    /// @param[in] other is the region.
+    /// @returns success/failure code. @see RetCode_t.
+    ///
+    RetCode_t Intersect(const Region & other);
+
+    /// Cover the region with few rectangles, for the least bus cost.
+    ///
+    /// Each rectangle that is flushed costs a fixed number of bytes, to
+    /// set the window and start the drawing, and then some bytes per
+    /// pixel. Rectangles are merged into their bounding box, the
+    /// cheapest first, while there are more than maxRects, or while a
+    /// merge saves more in fixed cost than it adds in pixels. The result
+    /// covers the region, and perhaps some more.
+    ///
+    /// @param[out] out receives the rectangles, which may overlap.
+    /// @param[in] maxRects is the size of out.
+    /// @param[in] rectCost is the bytes to flush a rectangle, beyond its pixels.
+    /// @param[in] pixelCost is the bytes per pixel, which is 0 for a
+    ///         hardware fill and 2 for a stream of 16-bit pixels.
+    /// @returns the number of rectangles in out.
+    ///
+    int Simplify(rect_t * out, int maxRects, uint32_t rectCost = 40, uint32_t pixelCost = 2) const;
+
+private:
+    /// Not copyable, since a copy would share, and then free, the same
+    /// storage. Use Set(const Region &) to copy into a second region.
+    Region(const Region &);
+    Region & operator=(const Region &);
+
+    typedef enum { OpUnion, OpSubtract, OpIntersect } Op_T;
+
+    RetCode_t _Op(const rect_t * b, int bCount, Op_T op);
+    void _Overflow(const rect_t * result, int n);
+    static void _Nearest(const rect_t * w, const bool * gone, int total, int i,
+        int32_t * cost, uint8_t * with, uint32_t rectCost, uint32_t pixelCost);
+
+    rect_t * rects;
+    int count;
+    int capacity;
+    bool owned;         ///< rects was allocated here
+};
+
+#endif // REGION_H
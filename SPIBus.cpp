@@ -0,0 +1,197 @@
+/// This file contains the SPIBus methods.
+///
+#include "SPIBus.h"
+
+//#define DEBUG "SPIB"
+// ...
+// INFO("Stuff to show %d", var); // new-line is automatically appended
+//
+#if (defined(DEBUG) && !defined(TARGET_LPC11U24))
+#define INFO(x, ...) std::printf("[INF %s %4d] "x"\r\n", DEBUG, __LINE__, ##__VA_ARGS__);
+#define WARN(x, ...) std::printf("[WRN %s %4d] "x"\r\n", DEBUG, __LINE__, ##__VA_ARGS__);
+#define ERR(x, ...)  std::printf("[ERR %s %4d] "x"\r\n", DEBUG, __LINE__, ##__VA_ARGS__);
+#else
+#define INFO(x, ...)
+#define WARN(x, ...)
+#define ERR(x, ...)
+#endif
+
+
+SPIBus::SPIBus(PinName mosi, PinName miso, PinName sclk)
+    : spi(mosi, miso, sclk)
+#ifdef SPIBUS_RTOS
+    , grant(1)
+#endif
+{
+    devices = 0;
+    owner = -1;
+    configured = -1;
+    selected = 0;
+#ifdef SPIBUS_RTOS
+    holder = NULL;
+#else
+    nextTicket = serving = 0;
+#endif
+    switches = 0;
+}
+
+
+int SPIBus::AddDevice(DigitalOut & cs, unsigned long hz, int mode, int bits)
+{
+    if (devices >= SPIBUS_MAX_DEVICES)
+        return -1;
+    cs = 1;
+    device[devices].cs = &cs;
+    device[devices].hz = hz;
+    device[devices].mode = mode;
+    device[devices].bits = bits;
+    INFO("AddDevice %d at %lu Hz, mode %d", devices, hz, mode);
+    return devices++;
+}
+
+
+void SPIBus::SetFrequency(int id, unsigned long hz)
+{
+    if (!_Valid(id))
+        return;
+    if (device[id].hz != hz) {
+        device[id].hz = hz;
+        if (configured == id)
+            spi.frequency(hz);
+    }
+}
+
+
+void SPIBus::SetFormat(int id, int bits, int mode)
+{
+    if (!_Valid(id))
+        return;
+    device[id].bits = bits;
+    device[id].mode = mode;
+    if (configured == id)
+        configured = -1;            // applied on the next grant
+}
+
+
+void SPIBus::Acquire(int id)
+{
+    if (!_Valid(id))
+        return;
+#ifdef SPIBUS_RTOS
+    osThreadId_t self = osThreadGetId();
+
+    // Only this thread can make itself the holder, or stop being it, so
+    // this test needs no lock.
+    if (holder == self && owner == id) {
+        *device[id].cs = 0;         // already granted, just select it again
+        selected |= 1 << id;
+        return;
+    }
+#if (MBED_MAJOR_VERSION >= 6)
+    grant.acquire();                // blocks, so the holder can run
+#else
+    grant.wait(osWaitForever);
+#endif
+    holder = self;
+#else
+    uint16_t ticket;
+
+    // Without an RTOS, only an interrupt could have the bus as well, and
+    // it releases it before this can run, so owner is stable here.
+    if (owner == id) {
+        *device[id].cs = 0;         // already granted, just select it again
+        selected |= 1 << id;
+        return;
+    }
+    core_util_critical_section_enter();
+    ticket = nextTicket++;
+    core_util_critical_section_exit();
+    while (ticket != serving)       // first come, first served
+        ;
+#endif
+    _Grant(id);
+}
+
+
+bool SPIBus::TryAcquire(int id)
+{
+    bool granted = false;
+
+    if (!_Valid(id))
+        return false;
+#ifdef SPIBUS_RTOS
+#if (MBED_MAJOR_VERSION >= 6)
+    granted = grant.try_acquire();
+#else
+    granted = (grant.wait(0) > 0);
+#endif
+    if (granted)
+        holder = (core_util_is_isr_active()) ? NULL : osThreadGetId();
+#else
+    core_util_critical_section_enter();
+    if (owner < 0 && nextTicket == serving) {
+        nextTicket++;
+        granted = true;
+    }
+    core_util_critical_section_exit();
+#endif
+    if (granted)
+        _Grant(id);
+    return granted;
+}
+
+
+void SPIBus::Release(int id)
+{
+    if (!_Valid(id) || owner != id) // already released, by a nested selection
+        return;
+    Deselect(selected);
+    owner = -1;
+#ifdef SPIBUS_RTOS
+    holder = NULL;
+    grant.release();                // the next waiter may have it
+#else
+    serving++;                      // the next ticket may have it
+#endif
+}
+
+
+void SPIBus::Select(uint32_t mask)
+{
+    selected |= mask;
+    for (int i = 0; i < devices; i++) {
+        if (mask & (1 << i))
+            *device[i].cs = 0;
+    }
+}
+
+
+void SPIBus::Deselect(uint32_t mask)
+{
+    mask &= selected;
+    selected &= ~mask;
+    for (int i = 0; i < devices; i++) {
+        if (mask & (1 << i))
+            *device[i].cs = 1;
+    }
+}
+
+
+bool SPIBus::IsBusy(void)
+{
+    return owner >= 0;
+}
+
+
+void SPIBus::_Grant(int id)
+{
+    owner = id;
+    if (configured != id) {
+        spi.format(device[id].bits, device[id].mode);
+        spi.frequency(device[id].hz);
+        configured = id;
+        switches++;
+    }
+    *device[id].cs = 0;
+    selected = 1 << id;
+}
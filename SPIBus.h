@@ -0,0 +1,183 @@
+/// SPIBus - a shared SPI bus for several devices.
+///
+/// Several devices, such as display controllers and SD cards, may share
+/// one SPI peripheral, each with its own chip select, clock rate and
+/// mode. The bus is granted to one device at a time, and it is
+/// reconfigured only when the grant passes to a different device.
+///
+#ifndef SPIBUS_H
+#define SPIBUS_H
+#include "mbed.h"
+
+// Under an RTOS the waiting threads block, so a holder of lower priority
+// can still run to release the bus.
+#if defined(MBED_CONF_RTOS_PRESENT) && defined(MBED_MAJOR_VERSION) && (MBED_MAJOR_VERSION >= 5)
+#include "rtos.h"
+#define SPIBUS_RTOS
+#endif
+
+/// The maximum number of devices on one bus.
+#define SPIBUS_MAX_DEVICES 8
+
+/// A shared SPI bus, with per-device configuration and fair arbitration.
+///
+/// Under an RTOS, a thread waiting for the bus blocks on a semaphore, so
+/// the thread that has it keeps running, whatever its priority. Waiting
+/// threads are granted the bus in priority order, and in request order
+/// among equal priorities. Without an RTOS, the bus is granted in request
+/// order, using a ticket.
+///
+/// Interrupt handlers must not wait for the bus, so they use
+/// @ref TryAcquire, and retry later when it is busy. They must release
+/// it before they return.
+///
+/// Several devices may be selected at once by the owner, with @ref Select,
+/// so a single write reaches all of them. This is how identical panels
+/// are mirrored.
+///
+/// @code
+/// SPIBus bus(p5, p6, p7);
+/// DigitalOut sdcs(p8);
+/// int sd = bus.AddDevice(sdcs, 12000000, 0);
+///
+/// RA8875 lcd1(bus, p12, NC, "lcd1");
+/// RA8875 lcd2(bus, p13, NC, "lcd2");
+///
+/// bus.Acquire(sd);        // the SD card has the bus, at its own rate and mode
+/// bus.Port().write(0xFF);
+/// bus.Release(sd);
+/// @endcode
+///
+class SPIBus
+{
+public:
+    /// Constructor for a shared SPI bus.
+    ///
+    /// @param[in] mosi is the SPI master out slave in pin on the mbed.
+    /// @param[in] miso is the SPI master in slave out pin on the mbed.
+    /// @param[in] sclk is the SPI shift clock pin on the mbed.
+    ///
+    SPIBus(PinName mosi, PinName miso, PinName sclk);
+
+    /// Add a device to the bus.
+    ///
+    /// @param[in] cs is the active low chip select of the device, which
+    ///         is driven by the bus. It is deselected here.
+    /// @param[in] hz is the clock rate of the device.
+    /// @param[in] mode is the SPI mode of the device, 0 to 3.
+    /// @param[in] bits is the number of bits per frame. The default is 8.
+    /// @returns the device id, or -1 if the bus is full. The other
+    ///         methods ignore an id of -1, so check it before use.
+    ///
+    int AddDevice(DigitalOut & cs, unsigned long hz, int mode, int bits = 8);
+
+    /// Change the clock rate of a device.
+    ///
+    /// If the device presently has the bus, the clock is changed at once,
+    /// otherwise it is applied when it is next granted the bus.
+    ///
+    /// @param[in] id is the device id.
+    /// @param[in] hz is the clock rate.
+    ///
+    void SetFrequency(int id, unsigned long hz);
+
+    /// Change the frame format and mode of a device.
+    ///
+    /// @param[in] id is the device id.
+    /// @param[in] bits is the number of bits per frame.
+    /// @param[in] mode is the SPI mode, 0 to 3.
+    ///
+    void SetFormat(int id, int bits, int mode);
+
+    /// Acquire the bus, and select the device.
+    ///
+    /// This waits its turn when the bus is in use. When the device
+    /// already has the bus, in the same thread, it is selected again and
+    /// this returns at once. Another thread using the same device waits
+    /// like any other. This must not be called from an interrupt.
+    ///
+    /// @param[in] id is the device id. If it is not one from
+    ///         @ref AddDevice, this returns at once, without the bus.
+    ///
+    void Acquire(int id);
+
+    /// Acquire the bus, and select the device, only if it is free.
+    ///
+    /// This is for interrupt handlers, which cannot wait.
+    ///
+    /// @param[in] id is the device id.
+    /// @returns true if the bus was acquired, and false if it is in use,
+    ///         or the id is not one from @ref AddDevice.
+    ///
+    bool TryAcquire(int id);
+
+    /// Deselect all the devices, and release the bus, if the device has it.
+    ///
+    /// @param[in] id is the device id.
+    ///
+    void Release(int id);
+
+    /// Select additional devices, which then receive what the owner writes.
+    ///
+    /// @param[in] mask is a bit mask of device ids.
+    ///
+    void Select(uint32_t mask);
+
+    /// Deselect some of the selected devices, while keeping the bus.
+    ///
+    /// @param[in] mask is a bit mask of device ids.
+    ///
+    void Deselect(uint32_t mask);
+
+    /// Determine if the bus is in use.
+    ///
+    /// @returns true if any device has the bus.
+    ///
+    bool IsBusy(void);
+
+    /// Get the SPI port, for the transfers of the device that has the bus.
+    ///
+    /// @returns a reference to the SPI port.
+    ///
+    SPI & Port(void) { return spi; }
+
+    /// Get the number of times the bus was reconfigured for another device.
+    ///
+    /// @returns the count of configuration switches.
+    ///
+    uint32_t GetSwitchCount(void) { return switches; }
+
+private:
+    /// Test that an id is one that @ref AddDevice returned.
+    ///
+    bool _Valid(int id) const { return id >= 0 && id < devices; }
+
+    /// Grant the bus to a device, reconfiguring it if necessary.
+    ///
+    void _Grant(int id);
+
+    typedef struct
+    {
+        DigitalOut * cs;            ///< chip select, active low
+        unsigned long hz;           ///< clock rate
+        uint8_t mode;               ///< SPI mode
+        uint8_t bits;               ///< bits per frame
+    } Device_T;
+
+    SPI spi;                        ///< the shared port
+    Device_T device[SPIBUS_MAX_DEVICES];    ///< the devices on the bus
+    int devices;                    ///< number of devices added
+    volatile int owner;             ///< device that has the bus, or -1
+    int configured;                 ///< device the port is configured for, or -1
+    uint32_t selected;              ///< mask of the devices that are selected
+#ifdef SPIBUS_RTOS
+    rtos::Semaphore grant;          ///< one token, taken by the device that has the bus
+    volatile osThreadId_t holder;   ///< thread that has the bus, or NULL
+#else
+    volatile uint16_t nextTicket;   ///< next ticket to issue
+    volatile uint16_t serving;      ///< ticket that may have the bus
+#endif
+    uint32_t switches;              ///< count of configuration switches
+};
+
+#endif // SPIBUS_H
@@ -0,0 +1,256 @@
+/// This file contains the StripChart methods.
+///
+#include "StripChart.h"
+
+#ifndef UTILITY_H
+#define swMalloc malloc         // use the standard
+#define swFree free
+#endif
+
+//#define DEBUG "STRP"
+// ...
+// INFO("Stuff to show %d", var); // new-line is automatically appended
+//
+#if (defined(DEBUG) && !defined(TARGET_LPC11U24))
+#define INFO(x, ...) std::printf("[INF %s %4d] "x"\r\n", DEBUG, __LINE__, ##__VA_ARGS__);
+#define WARN(x, ...) std::printf("[WRN %s %4d] "x"\r\n", DEBUG, __LINE__, ##__VA_ARGS__);
+#define ERR(x, ...)  std::printf("[ERR %s %4d] "x"\r\n", DEBUG, __LINE__, ##__VA_ARGS__);
+#else
+#define INFO(x, ...)
+#define WARN(x, ...)
+#define ERR(x, ...)
+#endif
+
+
+StripChart::StripChart(RA8875 & _lcd, loc_t x, loc_t y, dim_t w, dim_t h, dim_t _step)
+    : Widget(x, y, w, h), lcd(_lcd)
+{
+    plot = bounds;
+    plot.p1.x++;
+    plot.p1.y++;
+    plot.p2.x--;
+    plot.p2.y--;
+    step = (_step) ? _step : 1;
+    columns = (plot.p2.x - plot.p1.x + 1) / step;
+    if (columns < 1)
+        columns = 1;
+    series = 0;
+    for (int s=0; s<STRIPCHART_MAX_SERIES; s++)
+        history[s] = NULL;
+    head = 0;
+    filled = 0;
+    decimation = 1;
+    samples = 0;
+    autoScale = true;
+    sweep = 0;
+    scaleLo = 0.0f;
+    scaleHi = 1.0f;
+    rescales = 0;
+}
+
+
+StripChart::~StripChart()
+{
+    for (int s=0; s<series; s++)
+        swFree(history[s]);
+}
+
+
+int StripChart::AddSeries(color_t _color)
+{
+    if (series >= STRIPCHART_MAX_SERIES)
+        return -1;
+    history[series] = (Column_T *)swMalloc(columns * sizeof(Column_T));
+    if (history[series] == NULL)
+        return -1;
+    color[series] = _color;
+    filled = 0;                 // the columns of the others have no partner
+    samples = 0;
+    return series++;
+}
+
+
+void StripChart::SetRange(float lo, float hi)
+{
+    autoScale = false;
+    scaleLo = lo;
+    scaleHi = (hi > lo) ? hi : lo + 1.0f;
+    Invalidate();
+}
+
+
+void StripChart::SetAutoScale(bool on)
+{
+    autoScale = on;
+    sweep = 0;
+    if (on && _Fit(true))
+        Invalidate();
+}
+
+
+void StripChart::SetDecimation(int samplesPerColumn)
+{
+    decimation = (samplesPerColumn > 1) ? samplesPerColumn : 1;
+    samples = 0;
+}
+
+
+void StripChart::Clear(void)
+{
+    filled = 0;
+    samples = 0;
+    sweep = 0;
+    Invalidate();
+}
+
+
+loc_t StripChart::_Y(float v)
+{
+    float f = (v - scaleLo) / (scaleHi - scaleLo);
+
+    if (f < 0.0f)
+        f = 0.0f;
+    else if (f > 1.0f)
+        f = 1.0f;
+    return plot.p2.y - (loc_t)(f * (plot.p2.y - plot.p1.y) + 0.5f);
+}
+
+
+// Draw the column k back from the newest, at x, joined to the one before it.
+void StripChart::_Column(int k, loc_t x)
+{
+    int i = (head - k + columns) % columns;
+    int prev = (i - 1 + columns) % columns;
+    bool joined = (k + 1 < filled);
+
+    for (int s=0; s<series; s++) {
+        const Column_T & c = history[s][i];
+        loc_t yLo = _Y(c.lo);
+        loc_t yHi = _Y(c.hi);
+
+        if (joined) {
+            float p = history[s][prev].last;
+            float j = (p < c.lo) ? c.lo : (p > c.hi) ? c.hi : p;
+
+            lcd.line(x - step, _Y(p), x, _Y(j), color[s]);
+        }
+        if (yLo != yHi || !joined)
+            lcd.line(x, yHi, x, yLo, color[s]);
+    }
+}
+
+
+// Fit the scale to the history, when it is outside the scale or, if
+// shrink is set, when it uses less than half of it.
+bool StripChart::_Fit(bool shrink)
+{
+    float lo = 0.0f, hi = 0.0f;
+    float margin;
+
+    if (filled == 0 || series == 0)
+        return false;
+    lo = hi = history[0][head].last;
+    for (int s=0; s<series; s++) {
+        for (int k=0; k<filled; k++) {
+            const Column_T & c = history[s][(head - k + columns) % columns];
+
+            if (c.lo < lo)
+                lo = c.lo;
+            if (c.hi > hi)
+                hi = c.hi;
+        }
+    }
+    if (lo >= scaleLo && hi <= scaleHi
+    && (!shrink || (hi - lo) * 2.0f >= scaleHi - scaleLo))
+        return false;
+    margin = (hi - lo) / 10.0f;
+    if (margin <= 0.0f)
+        margin = (hi != 0.0f) ? ((hi > 0.0f) ? hi : -hi) / 10.0f : 1.0f;
+    scaleLo = lo - margin;
+    scaleHi = hi + margin;
+    INFO("scale %d..%d", (int)scaleLo, (int)scaleHi);
+    return true;
+}
+
+
+void StripChart::_Scroll(void)
+{
+    dim_t w = plot.p2.x - plot.p1.x + 1;
+    dim_t h = plot.p2.y - plot.p1.y + 1;
+
+    lcd.window(plot);
+    if (w > step) {
+        uint16_t layer = lcd.GetDrawingLayer();
+        point_t src = { (loc_t)(plot.p1.x + step), plot.p1.y };
+        point_t dst = { plot.p1.x, plot.p1.y };
+
+        // Moving left, the positive direction never overwrites what it has yet to read.
+        lcd.BlockMove(layer, 0, dst, layer, 0, src, w - step, h, 0x2, 0xC);
+    }
+    lcd.fillrect(plot.p2.x - step + 1, plot.p1.y, plot.p2.x, plot.p2.y, bg);
+    _Column(0, plot.p2.x);
+    lcd.window();
+}
+
+
+RetCode_t StripChart::AddSample(const float * values)
+{
+    bool outside = false;
+    bool rescale = false;
+    int s;
+
+    if (series == 0 || values == NULL)
+        return bad_parameter;
+    for (s=0; s<series; s++) {
+        float v = values[s];
+
+        if (samples == 0) {
+            pending[s].lo = pending[s].hi = v;
+        } else {
+            if (v < pending[s].lo)
+                pending[s].lo = v;
+            if (v > pending[s].hi)
+                pending[s].hi = v;
+        }
+        pending[s].last = v;
+    }
+    if (++samples < decimation)
+        return noerror;
+    samples = 0;
+    head = (head + 1) % columns;
+    if (filled < columns)
+        filled++;
+    for (s=0; s<series; s++) {
+        history[s][head] = pending[s];
+        if (pending[s].lo < scaleLo || pending[s].hi > scaleHi)
+            outside = true;
+    }
+    if (autoScale) {
+        if (outside)
+            rescale = _Fit(false);
+        if (++sweep >= columns) {      // once per width, so the cost per sample stays flat
+            sweep = 0;
+            if (_Fit(true))
+                rescale = true;
+        }
+    }
+    if (!visible)
+        return noerror;
+    if (rescale) {
+        rescales++;
+        lcd.window(bounds);
+        Draw(lcd, bounds);
+        return lcd.window();
+    }
+    _Scroll();
+    return noerror;
+}
+
+
+void StripChart::Draw(RA8875 & display, rect_t)
+{
+    display.rect(bounds, fg);
+    display.fillrect(plot, bg);
+    for (int k=0; k<filled; k++)
+        _Column(k, plot.p2.x - k * step);
+}
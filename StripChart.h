@@ -0,0 +1,147 @@
+/// StripChart - a scrolling trend graph, drawn one column at a time.
+///
+/// Rather than redraw the plot for each sample, the plot is shifted left
+/// with a BTE block move, the exposed column is cleared, and only the
+/// newest segment of each series is drawn. So the bus cost of a sample
+/// does not depend on the width of the chart, or on how much is plotted.
+///
+#ifndef STRIPCHART_H
+#define STRIPCHART_H
+#include "Widgets.h"
+
+/// The maximum number of series on one chart.
+#ifndef STRIPCHART_MAX_SERIES
+#define STRIPCHART_MAX_SERIES 4
+#endif
+
+/// A strip chart of one or more series, which scrolls to the left.
+///
+/// Each column of the chart may stand for several samples, see
+/// @ref SetDecimation, in which case it is drawn as the span from the
+/// minimum to the maximum of them, so no peak is lost.
+///
+/// The chart keeps the history of each series, one column per step, so
+/// it can redraw itself when the scale changes, or when it is damaged.
+/// That is 12 bytes per column per series.
+///
+/// The plot is scrolled in display memory, so no other widget may
+/// overlap the chart.
+///
+/// @code
+/// StripChart chart(lcd, 10, 10, 300, 100, 2);
+/// int temp = chart.AddSeries(Red);
+/// int set = chart.AddSeries(Green);
+///
+/// chart.Draw(lcd, chart.GetBounds());
+/// while (1) {
+///     float v[2] = { ReadTemperature(), setpoint };
+///     chart.AddSample(v);
+/// }
+/// @endcode
+///
+class StripChart : public Widget
+{
+public:
+    /// Constructor for a strip chart.
+    ///
+    /// @param[in] lcd is the display, which the chart draws on as samples arrive.
+    /// @param[in] x is the left edge.
+    /// @param[in] y is the top edge.
+    /// @param[in] w is the width, including a one pixel frame.
+    /// @param[in] h is the height, including a one pixel frame.
+    /// @param[in] step is the width in pixels of each column.
+    ///
+    StripChart(RA8875 & lcd, loc_t x, loc_t y, dim_t w, dim_t h, dim_t step = 1);
+
+    /// Destructor, which frees the history.
+    ///
+    virtual ~StripChart();
+
+    /// Add a series.
+    ///
+    /// @param[in] color is the color of the series.
+    /// @returns the series index, or -1 if there is no room or no memory.
+    ///
+    int AddSeries(color_t color);
+
+    /// Set a fixed range, which turns off the auto-scaling.
+    ///
+    /// @param[in] lo is the value at the bottom.
+    /// @param[in] hi is the value at the top.
+    ///
+    void SetRange(float lo, float hi);
+
+    /// Scale the chart to fit the data.
+    ///
+    /// The range grows at once when a sample is outside it, and shrinks
+    /// when the plotted data has used less than half of it for a whole
+    /// width of the chart. Only then is the chart redrawn.
+    ///
+    /// @param[in] on is true to scale automatically.
+    ///
+    void SetAutoScale(bool on = true);
+
+    /// Set the number of samples in each column.
+    ///
+    /// @param[in] samplesPerColumn is the decimation, 1 or more.
+    ///
+    void SetDecimation(int samplesPerColumn);
+
+    /// Add one sample to each series.
+    ///
+    /// @param[in] values is an array with a value for each series.
+    /// @returns success/failure code. @see RetCode_t.
+    ///
+    RetCode_t AddSample(const float * values);
+
+    /// Add one sample to a chart of one series.
+    ///
+    /// @param[in] value is the value.
+    /// @returns success/failure code. @see RetCode_t.
+    ///
+    RetCode_t AddSample(float value) { return AddSample(&value); }
+
+    /// Forget the history, and clear the plot.
+    ///
+    void Clear(void);
+
+    /// Get the number of times the chart was redrawn to change the scale.
+    ///
+    /// @returns the count.
+    ///
+    uint32_t GetRescaleCount(void) { return rescales; }
+
+    virtual void Draw(RA8875 & lcd, rect_t clip);
+
+private:
+    typedef struct {
+        float lo;           ///< the least sample in the column
+        float hi;           ///< the greatest sample in the column
+        float last;         ///< the last sample, where the next column joins
+    } Column_T;
+
+    loc_t _Y(float v);
+    void _Column(int k, loc_t x);
+    bool _Fit(bool shrink);
+    void _Scroll(void);
+
+    RA8875 & lcd;
+    rect_t plot;                                ///< inside the frame
+    dim_t step;                                 ///< pixels per column
+    int columns;                                ///< columns in the plot
+    int series;
+    color_t color[STRIPCHART_MAX_SERIES];
+    Column_T * history[STRIPCHART_MAX_SERIES];  ///< ring of columns, per series
+    Column_T pending[STRIPCHART_MAX_SERIES];    ///< the column being collected
+    int head;                                   ///< the newest column in the ring
+    int filled;                                 ///< columns of history
+    int decimation;
+    int samples;                                ///< in the pending column
+    bool autoScale;
+    int sweep;                                  ///< columns since the last shrink check
+    float scaleLo;
+    float scaleHi;
+    uint32_t rescales;
+};
+
+#endif // STRIPCHART_H
@@ -60,10 +60,20 @@ int TextDisplay::_putc(int value)
     return value;
 }
 
-// crude cls implementation, should generally be overwritten in derived class
+// cls implementation, should generally be overwritten in derived class
 RetCode_t TextDisplay::cls(uint16_t layers)
 {
+    RetCode_t ret;
+
     INFO("cls()");
+    ret = _ClearCells();
+    locate(0, 0);
+    return ret;
+}
+
+// crude fallback, for a display that cannot fill an area
+RetCode_t TextDisplay::_ClearCells(void)
+{
     locate(0, 0);
     for(int i=0; i<columns()*rows(); i++) {
         putc(' ');
@@ -137,6 +137,17 @@ protected:
     ///
     virtual int _getc();
 
+    /// a method to clear every character cell to the background color,
+    /// for cls.
+    ///
+    /// @note this method should be overridden in a derived class that
+    ///     can fill an area in one operation. The default writes a space
+    ///     to every cell, one character at a time.
+    ///
+    /// @returns error code.
+    ///
+    virtual RetCode_t _ClearCells(void);
+
     uint16_t _column;           ///< character column location
     uint16_t _row;              ///< character row location
 
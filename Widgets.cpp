@@ -0,0 +1,763 @@
+/// This file contains the Widget and WidgetScreen methods.
+///
+#include "Widgets.h"
+
+//#define DEBUG "WIDG"
+// ...
+// INFO("Stuff to show %d", var); // new-line is automatically appended
+//
+#if (defined(DEBUG) && !defined(TARGET_LPC11U24))
+#define INFO(x, ...) std::printf("[INF %s %4d] "x"\r\n", DEBUG, __LINE__, ##__VA_ARGS__);
+#define WARN(x, ...) std::printf("[WRN %s %4d] "x"\r\n", DEBUG, __LINE__, ##__VA_ARGS__);
+#define ERR(x, ...)  std::printf("[ERR %s %4d] "x"\r\n", DEBUG, __LINE__, ##__VA_ARGS__);
+#else
+#define INFO(x, ...)
+#define WARN(x, ...)
+#define ERR(x, ...)
+#endif
+
+
+// Rectangle helpers. The rectangles here are always normalized,
+// so p1 is the top left and p2 the bottom right, inclusive.
+
+static uint32_t Area(const rect_t & r)
+{
+    return (uint32_t)(r.p2.x - r.p1.x + 1) * (uint32_t)(r.p2.y - r.p1.y + 1);
+}
+
+static bool Inside(const rect_t & inner, const rect_t & outer)
+{
+    return inner.p1.x >= outer.p1.x && inner.p2.x <= outer.p2.x
+        && inner.p1.y >= outer.p1.y && inner.p2.y <= outer.p2.y;
+}
+
+static bool Clip(rect_t * r, const rect_t & c)
+{
+    r->p1.x = max(r->p1.x, c.p1.x);
+    r->p1.y = max(r->p1.y, c.p1.y);
+    r->p2.x = min(r->p2.x, c.p2.x);
+    r->p2.y = min(r->p2.y, c.p2.y);
+    return r->p1.x <= r->p2.x && r->p1.y <= r->p2.y;
+}
+
+static bool Contains(const rect_t & r, point_t p)
+{
+    return p.x >= r.p1.x && p.x <= r.p2.x && p.y >= r.p1.y && p.y <= r.p2.y;
+}
+
+static rect_t Bound(const rect_t & a, const rect_t & b)
+{
+    rect_t r;
+
+    r.p1.x = min(a.p1.x, b.p1.x);
+    r.p1.y = min(a.p1.y, b.p1.y);
+    r.p2.x = max(a.p2.x, b.p2.x);
+    r.p2.y = max(a.p2.y, b.p2.y);
+    return r;
+}
+
+
+// ----------------------------------------------------------------------
+// Widget
+
+Widget::Widget(loc_t x, loc_t y, dim_t w, dim_t h)
+{
+    bounds.p1.x = x;
+    bounds.p1.y = y;
+    bounds.p2.x = x + w - 1;
+    bounds.p2.y = y + h - 1;
+    visible = true;
+    fg = White;
+    bg = Black;
+    font = NULL;
+    screen = NULL;
+    changed = NULL;
+}
+
+
+Widget::~Widget()
+{
+    if (screen)
+        screen->Remove(this);
+}
+
+
+void Widget::Move(loc_t x, loc_t y)
+{
+    Invalidate();
+    bounds.p2.x += x - bounds.p1.x;
+    bounds.p2.y += y - bounds.p1.y;
+    bounds.p1.x = x;
+    bounds.p1.y = y;
+    Invalidate();
+}
+
+
+void Widget::Show(bool show)
+{
+    if (show == visible)
+        return;
+    visible = true;         // so the invalidate is not ignored
+    Invalidate();
+    visible = show;
+}
+
+
+void Widget::SetColors(color_t _fg, color_t _bg)
+{
+    fg = _fg;
+    bg = _bg;
+    Invalidate();
+}
+
+
+void Widget::SetFont(const uint8_t * _font)
+{
+    font = _font;
+    Invalidate();
+}
+
+
+void Widget::Invalidate(void)
+{
+    Invalidate(bounds);
+}
+
+
+void Widget::Invalidate(rect_t r)
+{
+    if (screen && visible && Clip(&r, bounds))
+        screen->Invalidate(r);
+}
+
+
+void Widget::DrawText(RA8875 & lcd, loc_t x, loc_t y, loc_t right, const char * text,
+    color_t _fg, color_t _bg)
+{
+    if (lcd.GetUserFont() != font)
+        lcd.SelectUserFont(font);
+    lcd.foreground(_fg);
+    lcd.background(_bg);
+    if (font) {
+        // Each glyph is placed on its own, so nothing depends on the window.
+        while (*text) {
+            dim_t cw = 0;
+
+            if (lcd.getCharMetrics(*text, &cw, NULL)) {
+                if (x + cw - 1 > right)
+                    break;
+                x += lcd.character(x, y, *text);
+            }
+            text++;
+        }
+    } else {
+        dim_t cw = lcd.fontwidth();         // read once, rather than per character
+
+        lcd.SetTextCursor(x, y);
+        while (*text && x + cw - 1 <= right) {
+            lcd.putc(*text++);
+            x += cw;
+        }
+    }
+}
+
+
+dim_t Widget::TextWidth(RA8875 & lcd, const char * text)
+{
+    dim_t w = 0;
+
+    if (font) {
+        if (lcd.GetUserFont() != font)
+            lcd.SelectUserFont(font);
+        while (*text) {
+            dim_t cw = 0;
+
+            if (lcd.getCharMetrics(*text++, &cw, NULL))
+                w += cw;
+        }
+    } else {
+        if (lcd.GetUserFont())
+            lcd.SelectUserFont();
+        w = strlen(text) * lcd.fontwidth();
+    }
+    return w;
+}
+
+
+dim_t Widget::TextHeight(RA8875 & lcd)
+{
+    if (lcd.GetUserFont() != font)
+        lcd.SelectUserFont(font);
+    return lcd.fontheight();
+}
+
+
+// ----------------------------------------------------------------------
+// WidgetScreen
+
+WidgetScreen::WidgetScreen(RA8875 & _lcd, color_t _background)
+    : lcd(_lcd)
+{
+    background = _background;
+    widgets = 0;
+    damages = 0;
+    captured = NULL;
+}
+
+
+WidgetScreen::~WidgetScreen()
+{
+    for (int i=0; i<widgets; i++)
+        widget[i]->screen = NULL;
+}
+
+
+RetCode_t WidgetScreen::Add(Widget * w)
+{
+    if (w == NULL || w->screen)
+        return bad_parameter;
+    if (widgets >= WIDGET_MAX_COUNT)
+        return not_enough_ram;
+    widget[widgets++] = w;
+    w->screen = this;
+    w->Invalidate();
+    return noerror;
+}
+
+
+RetCode_t WidgetScreen::Remove(Widget * w)
+{
+    for (int i=0; i<widgets; i++) {
+        if (widget[i] == w) {
+            w->Invalidate();
+            w->screen = NULL;
+            for (widgets--; i<widgets; i++)
+                widget[i] = widget[i+1];
+            if (captured == w)
+                captured = NULL;
+            return noerror;
+        }
+    }
+    return bad_parameter;
+}
+
+
+void WidgetScreen::_RemoveDamage(int i)
+{
+    damage[i] = damage[--damages];
+}
+
+
+void WidgetScreen::Invalidate(rect_t r)
+{
+    rect_t screenRect = { { 0, 0 }, { (loc_t)(lcd.width() - 1), (loc_t)(lcd.height() - 1) } };
+    int i;
+
+    if (!Clip(&r, screenRect))
+        return;
+    for (;;) {
+        int merge = -1;
+
+        for (i=0; i<damages; i++) {
+            if (Inside(r, damage[i]))
+                return;                             // already pending
+        }
+        for (i=0; i<damages; ) {
+            if (Inside(damage[i], r))
+                _RemoveDamage(i);                   // swallowed
+            else
+                i++;
+        }
+        // Merge when the bounding rectangle costs no more pixels than the
+        // two do apart, which is when they overlap or abut along an edge.
+        for (i=0; i<damages && merge < 0; i++) {
+            if (Area(Bound(r, damage[i])) <= Area(r) + Area(damage[i]))
+                merge = i;
+        }
+        if (merge < 0 && damages < WIDGET_MAX_DAMAGE) {
+            damage[damages++] = r;
+            return;
+        }
+        if (merge < 0) {                            // full, so merge where it grows the least
+            uint32_t least = 0xFFFFFFFF;
+
+            for (i=0; i<damages; i++) {
+                uint32_t growth = Area(Bound(r, damage[i])) - Area(damage[i]);
+
+                if (growth < least) {
+                    least = growth;
+                    merge = i;
+                }
+            }
+        }
+        r = Bound(r, damage[merge]);
+        _RemoveDamage(merge);                       // and try again, since it grew
+    }
+}
+
+
+void WidgetScreen::InvalidateAll(void)
+{
+    rect_t screenRect = { { 0, 0 }, { (loc_t)(lcd.width() - 1), (loc_t)(lcd.height() - 1) } };
+
+    damages = 0;
+    Invalidate(screenRect);
+}
+
+
+// Is the widget at z-order i hidden within r by an opaque widget above it.
+bool WidgetScreen::_Hidden(int i, rect_t r)
+{
+    for (i++; i<widgets; i++) {
+        if (widget[i]->visible && widget[i]->IsOpaque() && Inside(r, widget[i]->bounds))
+            return true;
+    }
+    return false;
+}
+
+
+// Is r covered by one opaque widget, so the background need not be drawn.
+bool WidgetScreen::_Covered(rect_t r)
+{
+    return _Hidden(-1, r);
+}
+
+
+RetCode_t WidgetScreen::Update(void)
+{
+    int i, d, pass;
+    bool grown = true;
+
+    if (damages == 0)
+        return noerror;
+    // Some widgets must redraw more than the damage, such as a whole line
+    // of text, and that may in turn damage the widgets above and below.
+    for (pass=0; grown && pass<=widgets; pass++) {
+        grown = false;
+        for (i=0; i<widgets && !grown; i++) {
+            if (!widget[i]->visible)
+                continue;
+            for (d=0; d<damages && !grown; d++) {
+                rect_t x = damage[d];
+
+                if (Clip(&x, widget[i]->bounds)) {
+                    rect_t need = widget[i]->RedrawArea(x);
+
+                    if (!Inside(need, damage[d])) {
+                        Invalidate(need);
+                        grown = true;
+                    }
+                }
+            }
+        }
+    }
+    for (d=0; d<damages; d++) {
+        INFO("damage (%d,%d)-(%d,%d)", damage[d].p1.x, damage[d].p1.y, damage[d].p2.x, damage[d].p2.y);
+        if (!_Covered(damage[d])) {
+            lcd.window(damage[d]);
+            lcd.fillrect(damage[d], background);
+        }
+        for (i=0; i<widgets; i++) {
+            rect_t x = damage[d];
+
+            if (!widget[i]->visible || !Clip(&x, widget[i]->bounds) || _Hidden(i, x))
+                continue;
+            lcd.window(x);
+            widget[i]->Draw(lcd, x);
+        }
+    }
+    damages = 0;
+    return lcd.window();
+}
+
+
+RetCode_t WidgetScreen::Redraw(void)
+{
+    InvalidateAll();
+    return Update();
+}
+
+
+Widget * WidgetScreen::Touch(TouchCode_t code, point_t p)
+{
+    Widget * w = NULL;
+
+    if (code == touch) {
+        captured = NULL;
+        for (int i=widgets-1; i>=0; i--) {
+            if (widget[i]->visible && Contains(widget[i]->bounds, p)) {
+                if (widget[i]->Touch(code, p))
+                    captured = widget[i];
+                return widget[i];                   // the topmost takes it, or nobody
+            }
+        }
+    } else if ((code == held || code == release) && captured) {
+        w = captured;
+        w->Touch(code, p);
+        if (code == release)
+            captured = NULL;
+    }
+    return w;
+}
+
+
+// ----------------------------------------------------------------------
+// Label
+
+Label::Label(loc_t x, loc_t y, dim_t w, dim_t h, const char * _text, Align_T _align)
+    : Widget(x, y, w, h)
+{
+    text = _text;
+    align = _align;
+}
+
+
+void Label::SetText(const char * _text)
+{
+    text = _text;
+    Invalidate();
+}
+
+
+void Label::Draw(RA8875 & lcd, rect_t)
+{
+    dim_t th = TextHeight(lcd);
+    dim_t w = bounds.p2.x - bounds.p1.x + 1;
+    dim_t h = bounds.p2.y - bounds.p1.y + 1;
+    dim_t tw;
+    loc_t x = bounds.p1.x;
+
+    lcd.fillrect(bounds, bg);
+    if (th > h || text == NULL)
+        return;
+    tw = TextWidth(lcd, text);
+    if (tw < w) {
+        if (align == AlignCenter)
+            x += (w - tw) / 2;
+        else if (align == AlignRight)
+            x += w - tw;
+    }
+    DrawText(lcd, x, bounds.p1.y + (h - th) / 2, bounds.p2.x, text, fg, bg);
+}
+
+
+// ----------------------------------------------------------------------
+// Button
+
+Button::Button(loc_t x, loc_t y, dim_t w, dim_t h, const char * _text)
+    : Label(x, y, w, h, _text, AlignCenter)
+{
+    pressed = false;
+}
+
+
+void Button::Draw(RA8875 & lcd, rect_t)
+{
+    color_t face = (pressed) ? fg : bg;
+    color_t ink = (pressed) ? bg : fg;
+    dim_t th = TextHeight(lcd);
+    dim_t w = bounds.p2.x - bounds.p1.x + 1;
+    dim_t h = bounds.p2.y - bounds.p1.y + 1;
+    dim_t tw;
+
+    lcd.fillrect(bounds, bg);
+    lcd.fillroundrect(bounds, 4, 4, face);
+    lcd.roundrect(bounds, 4, 4, fg);
+    if (th + 2 > h || text == NULL)
+        return;
+    tw = TextWidth(lcd, text);
+    if (tw > w - 4)
+        tw = w - 4;
+    DrawText(lcd, bounds.p1.x + (w - tw) / 2, bounds.p1.y + (h - th) / 2,
+        bounds.p2.x - 2, text, ink, face);
+}
+
+
+bool Button::Touch(TouchCode_t code, point_t p)
+{
+    bool inside = Contains(bounds, p);
+
+    switch (code) {
+        case touch:
+        case held:
+            if (pressed != inside) {
+                pressed = inside;
+                Invalidate();
+            }
+            break;
+        case release:
+            if (pressed) {
+                pressed = false;
+                Invalidate();
+                Changed();
+            }
+            break;
+        default:
+            break;
+    }
+    return true;
+}
+
+
+// ----------------------------------------------------------------------
+// Slider
+
+Slider::Slider(loc_t x, loc_t y, dim_t w, dim_t h, int _minimum, int _maximum)
+    : Widget(x, y, w, h)
+{
+    minimum = _minimum;
+    maximum = (_maximum > _minimum) ? _maximum : _minimum + 1;
+    value = minimum;
+}
+
+
+rect_t Slider::_Knob(void)
+{
+    dim_t kw = bounds.p2.y - bounds.p1.y + 1;
+    dim_t travel = bounds.p2.x - bounds.p1.x + 1 - kw;
+    rect_t k = bounds;
+
+    k.p1.x += (loc_t)((long)travel * (value - minimum) / (maximum - minimum));
+    k.p2.x = k.p1.x + kw - 1;
+    return k;
+}
+
+
+void Slider::SetValue(int _value)
+{
+    _value = max(minimum, min(_value, maximum));
+    if (_value == value)
+        return;
+    Invalidate(_Knob());        // where the knob was
+    value = _value;
+    Invalidate(_Knob());        // and where it is
+}
+
+
+void Slider::Draw(RA8875 & lcd, rect_t)
+{
+    dim_t h = bounds.p2.y - bounds.p1.y + 1;
+    rect_t track = bounds;
+    rect_t knob = _Knob();
+
+    track.p1.y += h / 2 - 2;
+    track.p2.y = track.p1.y + 3;
+    lcd.fillrect(bounds, bg);
+    lcd.fillrect(track, fg);
+    lcd.fillroundrect(knob, 3, 3, fg);
+    lcd.roundrect(knob, 3, 3, bg);
+}
+
+
+bool Slider::Touch(TouchCode_t code, point_t p)
+{
+    if (code == touch || code == held) {
+        dim_t kw = bounds.p2.y - bounds.p1.y + 1;
+        long travel = bounds.p2.x - bounds.p1.x + 1 - kw;
+        long pos = p.x - bounds.p1.x - kw / 2;
+        int old = value;
+
+        pos = max(0L, min(pos, travel));
+        SetValue(minimum + (int)(travel ? (pos * (maximum - minimum) + travel / 2) / travel : 0));
+        if (value != old)
+            Changed();
+    }
+    return true;
+}
+
+
+// ----------------------------------------------------------------------
+// ProgressBar
+
+ProgressBar::ProgressBar(loc_t x, loc_t y, dim_t w, dim_t h, int _maximum)
+    : Widget(x, y, w, h)
+{
+    maximum = (_maximum > 0) ? _maximum : 1;
+    value = 0;
+}
+
+
+// The first column of the unfilled part, inside the border.
+loc_t ProgressBar::_Split(int v)
+{
+    long inner = bounds.p2.x - bounds.p1.x - 1;
+
+    return bounds.p1.x + 1 + (loc_t)(inner * v / maximum);
+}
+
+
+void ProgressBar::SetValue(int _value)
+{
+    rect_t span = bounds;
+    loc_t a, b;
+
+    _value = max(0, min(_value, maximum));
+    a = _Split(value);
+    b = _Split(_value);
+    value = _value;
+    if (a == b)
+        return;
+    span.p1.x = min(a, b);
+    span.p2.x = max(a, b) - 1;
+    span.p1.y++;
+    span.p2.y--;
+    Invalidate(span);           // only the columns that changed
+}
+
+
+void ProgressBar::Draw(RA8875 & lcd, rect_t clip)
+{
+    rect_t inner = bounds;
+    rect_t filled, empty;
+    loc_t split = _Split(value);
+
+    inner.p1.x++;
+    inner.p1.y++;
+    inner.p2.x--;
+    inner.p2.y--;
+    filled = empty = inner;
+    filled.p2.x = split - 1;
+    empty.p1.x = split;
+    if (Clip(&filled, clip))
+        lcd.fillrect(filled, fg);
+    if (Clip(&empty, clip))
+        lcd.fillrect(empty, bg);
+    if (!Inside(clip, inner))
+        lcd.rect(bounds, fg);
+}
+
+
+// ----------------------------------------------------------------------
+// ListBox
+
+ListBox::ListBox(loc_t x, loc_t y, dim_t w, dim_t h, const char * const * _items, int _count,
+    dim_t _rowHeight)
+    : Widget(x, y, w, h)
+{
+    items = _items;
+    count = _count;
+    rowHeight = (_rowHeight) ? _rowHeight : 1;
+    selected = -1;
+}
+
+
+rect_t ListBox::_Row(int index)
+{
+    rect_t r = bounds;
+
+    r.p1.y += index * rowHeight;
+    r.p2.y = r.p1.y + rowHeight - 1;
+    return r;
+}
+
+
+void ListBox::Select(int index)
+{
+    if (index < -1 || index >= count || index == selected)
+        return;
+    if (selected >= 0)
+        Invalidate(_Row(selected));
+    selected = index;
+    if (selected >= 0)
+        Invalidate(_Row(selected));
+}
+
+
+void ListBox::InvalidateItem(int index)
+{
+    if (index >= 0 && index < count)
+        Invalidate(_Row(index));
+}
+
+
+rect_t ListBox::RedrawArea(rect_t damage)
+{
+    int first = (damage.p1.y - bounds.p1.y) / rowHeight;
+    int last = (damage.p2.y - bounds.p1.y) / rowHeight;
+    rect_t r = bounds;
+
+    r.p1.y = _Row(first).p1.y;
+    r.p2.y = min(_Row(last).p2.y, bounds.p2.y);
+    return r;                   // whole rows, across the full width
+}
+
+
+void ListBox::Draw(RA8875 & lcd, rect_t clip)
+{
+    int first = (clip.p1.y - bounds.p1.y) / rowHeight;
+    int last = (clip.p2.y - bounds.p1.y) / rowHeight;
+    dim_t th = TextHeight(lcd);
+
+    for (int i=first; i<=last; i++) {
+        rect_t row = _Row(i);
+        bool sel = (i == selected);
+
+        Clip(&row, bounds);
+        lcd.fillrect(row, (sel) ? fg : bg);
+        if (i < count && items[i] && th <= row.p2.y - row.p1.y + 1)
+            DrawText(lcd, row.p1.x + 2, row.p1.y + (rowHeight - th) / 2, row.p2.x - 2,
+                items[i], (sel) ? bg : fg, (sel) ? fg : bg);
+    }
+}
+
+
+bool ListBox::Touch(TouchCode_t code, point_t p)
+{
+    if (code == touch) {
+        int index = (p.y - bounds.p1.y) / rowHeight;
+
+        if (index < count && index != selected) {
+            Select(index);
+            Changed();
+        }
+    }
+    return true;
+}
+
+
+// ----------------------------------------------------------------------
+// Image
+
+Image::Image(loc_t x, loc_t y, dim_t w, dim_t h, const color_t * _pixels)
+    : Widget(x, y, w, h)
+{
+    pixels = _pixels;
+    fileName = NULL;
+}
+
+
+Image::Image(loc_t x, loc_t y, dim_t w, dim_t h, const char * _fileName)
+    : Widget(x, y, w, h)
+{
+    pixels = NULL;
+    fileName = _fileName;
+}
+
+
+rect_t Image::RedrawArea(rect_t damage)
+{
+    return (fileName) ? bounds : damage;
+}
+
+
+void Image::Draw(RA8875 & lcd, rect_t clip)
+{
+    if (fileName) {
+        if (lcd.RenderImageFile(bounds.p1.x, bounds.p1.y, fileName) != noerror)
+            lcd.fillrect(bounds, bg);
+        return;
+    }
+    if (pixels == NULL)
+        return;
+    dim_t w = bounds.p2.x - bounds.p1.x + 1;
+    dim_t cw = clip.p2.x - clip.p1.x + 1;
+    const color_t * p = pixels + (clip.p1.y - bounds.p1.y) * w + (clip.p1.x - bounds.p1.x);
+
+    if (cw == w) {              // whole rows, so one stream
+        lcd.pixelStream((color_t *)p, (uint32_t)w * (clip.p2.y - clip.p1.y + 1),
+            clip.p1.x, clip.p1.y);
+    } else {
+        for (loc_t y=clip.p1.y; y<=clip.p2.y; y++, p+=w)
+            lcd.pixelStream((color_t *)p, cw, clip.p1.x, y);
+    }
+}
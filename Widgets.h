@@ -0,0 +1,544 @@
+/// Widgets - a small retained-mode user interface on the RA8875.
+///
+/// Each widget holds its own state, and when that state changes, it
+/// invalidates only the part of the screen that changed. The
+/// @ref WidgetScreen collects that damage, coalesces it, and on
+/// @ref WidgetScreen::Update it redraws, in z-order, only the widgets
+/// that touch the damage, with the active window clipped to it. So a
+/// slider that moves costs about the bytes of its knob, rather than the
+/// bytes of the whole screen.
+///
+#ifndef WIDGETS_H
+#define WIDGETS_H
+#include "RA8875.h"
+
+/// The maximum number of widgets on one screen.
+#ifndef WIDGET_MAX_COUNT
+#define WIDGET_MAX_COUNT 24
+#endif
+
+/// The maximum number of separate damage rectangles per frame. When more
+/// are invalidated, the two that grow the least are merged.
+#ifndef WIDGET_MAX_DAMAGE
+#define WIDGET_MAX_DAMAGE 8
+#endif
+
+class Widget;
+class WidgetScreen;
+
+/// The callback that a widget makes when the user changes it.
+///
+/// @param[in] w is the widget that changed.
+///
+typedef void (* WidgetCallback_T)(Widget * w);
+
+
+/// The base of all the widgets.
+///
+/// A widget draws itself in @ref Draw, in screen coordinates, and it may
+/// draw outside the clip rectangle that it is given, since the active
+/// window clips it. It should not draw outside its bounds.
+///
+class Widget
+{
+public:
+    /// Constructor for a widget.
+    ///
+    /// @param[in] x is the left edge.
+    /// @param[in] y is the top edge.
+    /// @param[in] w is the width.
+    /// @param[in] h is the height.
+    ///
+    Widget(loc_t x, loc_t y, dim_t w, dim_t h);
+
+    /// Destructor, which removes the widget from its screen.
+    ///
+    virtual ~Widget();
+
+    /// Get the bounds of the widget.
+    ///
+    /// @returns the bounding rectangle.
+    ///
+    rect_t GetBounds(void) { return bounds; }
+
+    /// Move the widget, which invalidates where it was and where it is.
+    ///
+    /// @param[in] x is the new left edge.
+    /// @param[in] y is the new top edge.
+    ///
+    void Move(loc_t x, loc_t y);
+
+    /// Show or hide the widget.
+    ///
+    /// @param[in] show is true to show it.
+    ///
+    void Show(bool show);
+
+    /// Is the widget visible.
+    ///
+    /// @returns true when it is shown.
+    ///
+    bool IsVisible(void) { return visible; }
+
+    /// Set the colors of the widget.
+    ///
+    /// Each widget uses these two colors in its own way, for instance the
+    /// selected row of a @ref ListBox, and a pressed @ref Button, swap them.
+    ///
+    /// @param[in] fg is the foreground color.
+    /// @param[in] bg is the background color.
+    ///
+    void SetColors(color_t fg, color_t bg);
+
+    /// Set the font of the widget.
+    ///
+    /// @param[in] font is the user font, or NULL for the internal font.
+    ///
+    void SetFont(const uint8_t * font = NULL);
+
+    /// Set the callback for a change made by the user.
+    ///
+    /// @param[in] callback is the function, or NULL for none.
+    ///
+    void SetCallback(WidgetCallback_T callback = NULL) { changed = callback; }
+
+    /// Invalidate the whole widget.
+    ///
+    void Invalidate(void);
+
+    /// Invalidate part of the widget.
+    ///
+    /// @param[in] r is the part that changed. It is clipped to the bounds.
+    ///
+    void Invalidate(rect_t r);
+
+    /// Draw the widget.
+    ///
+    /// @param[in] lcd is the display, with the active window set to the clip.
+    /// @param[in] clip is the part of the widget that must be drawn.
+    ///
+    virtual void Draw(RA8875 & lcd, rect_t clip) = 0;
+
+    /// Get the area that must be redrawn to repair some damage.
+    ///
+    /// Most widgets can redraw any part of themselves, but text cannot be
+    /// clipped by the window, so such widgets grow the damage to whole
+    /// lines of text.
+    ///
+    /// @param[in] damage is the damage, within the bounds.
+    /// @returns the area to redraw, which includes the damage.
+    ///
+    virtual rect_t RedrawArea(rect_t damage) { return damage; }
+
+    /// Does the widget cover every pixel of its bounds.
+    ///
+    /// @returns true when nothing beneath it shows through.
+    ///
+    virtual bool IsOpaque(void) { return true; }
+
+    /// Handle a touch within the widget.
+    ///
+    /// After a touch, the widget receives the held and release events
+    /// that follow, even when they are outside its bounds.
+    ///
+    /// @param[in] code is the touch code.
+    /// @param[in] p is the point of the touch.
+    /// @returns true when the widget uses touch.
+    ///
+    virtual bool Touch(TouchCode_t /*code*/, point_t /*p*/) { return false; }
+
+protected:
+    /// Draw one line of text, which is truncated to what fits.
+    ///
+    /// @param[in] lcd is the display.
+    /// @param[in] x is the left edge of the text.
+    /// @param[in] y is the top edge of the text.
+    /// @param[in] right is the rightmost column the text may use.
+    /// @param[in] text is the text.
+    /// @param[in] fg is the text color.
+    /// @param[in] bg is the text background color.
+    ///
+    void DrawText(RA8875 & lcd, loc_t x, loc_t y, loc_t right, const char * text,
+        color_t fg, color_t bg);
+
+    /// Get the width of text in the font of the widget.
+    ///
+    /// @param[in] lcd is the display.
+    /// @param[in] text is the text.
+    /// @returns the width in pixels.
+    ///
+    dim_t TextWidth(RA8875 & lcd, const char * text);
+
+    /// Get the height of a line in the font of the widget.
+    ///
+    /// @param[in] lcd is the display.
+    /// @returns the height in pixels.
+    ///
+    dim_t TextHeight(RA8875 & lcd);
+
+    /// Report a change made by the user.
+    ///
+    void Changed(void) { if (changed) (*changed)(this); }
+
+    rect_t bounds;              ///< screen coordinates
+    bool visible;               ///< shown
+    color_t fg;                 ///< foreground color
+    color_t bg;                 ///< background color
+    const uint8_t * font;       ///< user font, or NULL for the internal font
+    WidgetScreen * screen;      ///< the screen it is on, if any
+    WidgetCallback_T changed;   ///< the change callback
+
+    friend class WidgetScreen;
+};
+
+
+/// A screen of widgets, which owns the damage and the redraw.
+///
+/// Widgets are drawn in the order they are added, so the last is on top.
+/// The screen does not own the widgets.
+///
+/// @code
+/// WidgetScreen ui(lcd, Black);
+/// Label title(10, 10, 200, 20, "Volume");
+/// Slider volume(10, 40, 200, 24, 0, 100);
+///
+/// ui.Add(&title);
+/// ui.Add(&volume);
+/// ui.Redraw();
+/// while (1) {
+///     point_t p;
+///     TouchCode_t code = lcd.TouchPanelReadable(&p);
+///     if (code != no_touch && code != no_cal)
+///         ui.Touch(code, p);
+///     ui.Update();
+/// }
+/// @endcode
+///
+class WidgetScreen
+{
+public:
+    /// Constructor for a screen.
+    ///
+    /// @param[in] lcd is the display.
+    /// @param[in] background is the color where no widget is drawn.
+    ///
+    WidgetScreen(RA8875 & lcd, color_t background = Black);
+
+    /// Destructor, which releases the widgets.
+    ///
+    ~WidgetScreen();
+
+    /// Add a widget on top of the others.
+    ///
+    /// @param[in] w is the widget, which must not be on another screen.
+    /// @returns success/failure code. @see RetCode_t.
+    ///
+    RetCode_t Add(Widget * w);
+
+    /// Remove a widget, which invalidates where it was.
+    ///
+    /// @param[in] w is the widget.
+    /// @returns success/failure code. @see RetCode_t.
+    ///
+    RetCode_t Remove(Widget * w);
+
+    /// Add damage, which is coalesced with the damage already pending.
+    ///
+    /// @param[in] r is the damaged rectangle.
+    ///
+    void Invalidate(rect_t r);
+
+    /// Damage the whole screen.
+    ///
+    void InvalidateAll(void);
+
+    /// Repair the damage, by redrawing in z-order only what touches it.
+    ///
+    /// @returns success/failure code. @see RetCode_t.
+    ///
+    RetCode_t Update(void);
+
+    /// Redraw the whole screen, whether damaged or not.
+    ///
+    /// @returns success/failure code. @see RetCode_t.
+    ///
+    RetCode_t Redraw(void);
+
+    /// Deliver a touch to the topmost widget under it.
+    ///
+    /// A widget that takes the touch then receives the held and release
+    /// events that follow.
+    ///
+    /// @param[in] code is the touch code from the touch panel.
+    /// @param[in] p is the point of the touch.
+    /// @returns the widget that received it, or NULL.
+    ///
+    Widget * Touch(TouchCode_t code, point_t p);
+
+    /// Get the number of damage rectangles that are pending.
+    ///
+    /// @returns the count.
+    ///
+    int GetDamageCount(void) { return damages; }
+
+    /// Get the color where no widget is drawn.
+    ///
+    /// @returns the background color.
+    ///
+    color_t GetBackground(void) { return background; }
+
+private:
+    void _RemoveDamage(int i);
+    bool _Hidden(int i, rect_t r);
+    bool _Covered(rect_t r);
+
+    RA8875 & lcd;
+    color_t background;
+    Widget * widget[WIDGET_MAX_COUNT];  ///< in z-order, the last is on top
+    int widgets;
+    rect_t damage[WIDGET_MAX_DAMAGE];
+    int damages;
+    Widget * captured;                  ///< receives the touch until the release
+};
+
+
+/// A line of text.
+///
+class Label : public Widget
+{
+public:
+    /// How the text is placed within the bounds.
+    typedef enum {
+        AlignLeft,
+        AlignCenter,
+        AlignRight
+    } Align_T;
+
+    /// Constructor for a label.
+    ///
+    /// @param[in] x is the left edge.
+    /// @param[in] y is the top edge.
+    /// @param[in] w is the width.
+    /// @param[in] h is the height.
+    /// @param[in] text is the text, which is not copied, so it must remain.
+    /// @param[in] align is the placement of the text.
+    ///
+    Label(loc_t x, loc_t y, dim_t w, dim_t h, const char * text = "", Align_T align = AlignLeft);
+
+    /// Set the text.
+    ///
+    /// @param[in] text is the text, which is not copied, so it must remain.
+    ///
+    void SetText(const char * text);
+
+    /// Get the text.
+    ///
+    /// @returns the text.
+    ///
+    const char * GetText(void) { return text; }
+
+    virtual void Draw(RA8875 & lcd, rect_t clip);
+    virtual rect_t RedrawArea(rect_t /*damage*/) { return bounds; }
+
+protected:
+    const char * text;
+    Align_T align;
+};
+
+
+/// A push button, with a text caption.
+///
+/// The callback is made when the button is released while the touch is
+/// still on it.
+///
+class Button : public Label
+{
+public:
+    /// Constructor for a button.
+    ///
+    /// @param[in] x is the left edge.
+    /// @param[in] y is the top edge.
+    /// @param[in] w is the width.
+    /// @param[in] h is the height.
+    /// @param[in] text is the caption, which is not copied, so it must remain.
+    ///
+    Button(loc_t x, loc_t y, dim_t w, dim_t h, const char * text = "");
+
+    /// Is the button pressed.
+    ///
+    /// @returns true while it is pressed.
+    ///
+    bool IsPressed(void) { return pressed; }
+
+    virtual void Draw(RA8875 & lcd, rect_t clip);
+    virtual bool Touch(TouchCode_t code, point_t p);
+
+protected:
+    bool pressed;
+};
+
+
+/// A horizontal slider, with a knob on a track.
+///
+class Slider : public Widget
+{
+public:
+    /// Constructor for a slider.
+    ///
+    /// @param[in] x is the left edge.
+    /// @param[in] y is the top edge.
+    /// @param[in] w is the width.
+    /// @param[in] h is the height, which is also the width of the knob.
+    /// @param[in] minimum is the value at the left end.
+    /// @param[in] maximum is the value at the right end.
+    ///
+    Slider(loc_t x, loc_t y, dim_t w, dim_t h, int minimum = 0, int maximum = 100);
+
+    /// Set the value, which moves the knob.
+    ///
+    /// @param[in] value is the value, which is limited to the range.
+    ///
+    void SetValue(int value);
+
+    /// Get the value.
+    ///
+    /// @returns the value.
+    ///
+    int GetValue(void) { return value; }
+
+    virtual void Draw(RA8875 & lcd, rect_t clip);
+    virtual bool Touch(TouchCode_t code, point_t p);
+
+protected:
+    rect_t _Knob(void);
+
+    int minimum;
+    int maximum;
+    int value;
+};
+
+
+/// A horizontal progress bar.
+///
+class ProgressBar : public Widget
+{
+public:
+    /// Constructor for a progress bar.
+    ///
+    /// @param[in] x is the left edge.
+    /// @param[in] y is the top edge.
+    /// @param[in] w is the width.
+    /// @param[in] h is the height.
+    /// @param[in] maximum is the value when it is full.
+    ///
+    ProgressBar(loc_t x, loc_t y, dim_t w, dim_t h, int maximum = 100);
+
+    /// Set the value, which invalidates only the span that changed.
+    ///
+    /// @param[in] value is the value, which is limited to 0 to the maximum.
+    ///
+    void SetValue(int value);
+
+    /// Get the value.
+    ///
+    /// @returns the value.
+    ///
+    int GetValue(void) { return value; }
+
+    virtual void Draw(RA8875 & lcd, rect_t clip);
+
+protected:
+    loc_t _Split(int value);
+
+    int maximum;
+    int value;
+};
+
+
+/// A list of text items, one of which may be selected.
+///
+class ListBox : public Widget
+{
+public:
+    /// Constructor for a list.
+    ///
+    /// @param[in] x is the left edge.
+    /// @param[in] y is the top edge.
+    /// @param[in] w is the width.
+    /// @param[in] h is the height.
+    /// @param[in] items is the array of items, which is not copied.
+    /// @param[in] count is the number of items.
+    /// @param[in] rowHeight is the height of a row.
+    ///
+    ListBox(loc_t x, loc_t y, dim_t w, dim_t h, const char * const * items, int count,
+        dim_t rowHeight = 20);
+
+    /// Select an item, which invalidates only the two rows that changed.
+    ///
+    /// @param[in] index is the item, or -1 for none.
+    ///
+    void Select(int index);
+
+    /// Get the selected item.
+    ///
+    /// @returns the index, or -1 for none.
+    ///
+    int GetSelected(void) { return selected; }
+
+    /// Invalidate one item, after its text has changed.
+    ///
+    /// @param[in] index is the item.
+    ///
+    void InvalidateItem(int index);
+
+    virtual void Draw(RA8875 & lcd, rect_t clip);
+    virtual rect_t RedrawArea(rect_t damage);
+    virtual bool Touch(TouchCode_t code, point_t p);
+
+protected:
+    rect_t _Row(int index);
+
+    const char * const * items;
+    int count;
+    dim_t rowHeight;
+    int selected;
+};
+
+
+/// An image, from a bitmap in memory or from a file.
+///
+/// An image in memory is redrawn only where it is damaged. An image file
+/// is rendered whole, so any damage redraws all of it.
+///
+class Image : public Widget
+{
+public:
+    /// Constructor for an image in memory.
+    ///
+    /// @param[in] x is the left edge.
+    /// @param[in] y is the top edge.
+    /// @param[in] w is the width.
+    /// @param[in] h is the height.
+    /// @param[in] pixels is the w * h array of pixels, by rows, which is not copied.
+    ///
+    Image(loc_t x, loc_t y, dim_t w, dim_t h, const color_t * pixels);
+
+    /// Constructor for an image file.
+    ///
+    /// @param[in] x is the left edge.
+    /// @param[in] y is the top edge.
+    /// @param[in] w is the width of the image.
+    /// @param[in] h is the height of the image.
+    /// @param[in] fileName is a bmp or jpeg file, which is not copied.
+    ///
+    Image(loc_t x, loc_t y, dim_t w, dim_t h, const char * fileName);
+
+    virtual void Draw(RA8875 & lcd, rect_t clip);
+    virtual rect_t RedrawArea(rect_t damage);
+
+protected:
+    const color_t * pixels;
+    const char * fileName;
+};
+
+#endif // WIDGETS_H
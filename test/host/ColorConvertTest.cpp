@@ -0,0 +1,220 @@
+/// ColorConvertTest - checks and times the ColorConvert spans on the host.
+///
+/// Every span converter is checked against the one pixel converters, for
+/// lengths that end in each of the scalar tails, from sources at each
+/// byte offset, and in place where that is allowed. Then each one is
+/// timed over a 480 pixel row, and reported in pixels per cycle.
+///
+/// "make color" builds it with the word at a time loops, and "make
+/// color-scalar" with COLOR_SCALAR, so the two rates can be compared.
+///
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#include "ColorConvert.h"
+
+#define ROW         480         ///< pixels in a timed span
+#define ROW_LOOPS   2000        ///< spans per timed sample
+#define SAMPLES     200         ///< the fastest sample is reported
+#define TRIALS      20000
+
+static int fails = 0;
+
+#define CHECK(c) do { if (!(c)) { if (fails < 10) printf("%s:%d failed\n", __FILE__, __LINE__); fails++; } } while (0)
+
+
+/// The wire order bytes of one color, high byte first.
+static bool IsWire(const uint8_t * p, color_t c)
+{
+    return p[0] == (uint8_t)(c >> 8) && p[1] == (uint8_t)c;
+}
+
+
+/// Every color through the one pixel round trips.
+static void CheckPixels(void)
+{
+    for (uint32_t c = 0; c < 65536; c++) {
+        color_t in = (color_t)c, back;
+        uint8_t q[3];
+
+        RGB565ToRGB888(q, &in, 1);
+        RGB888ToRGB565(&back, q, 1);
+        CHECK(back == in);
+        CHECK(RGB888To565(q[0], q[1], q[2]) == RGB(q[0], q[1], q[2]));
+    }
+    for (int c = 0; c < 256; c++)
+        CHECK(RGB565To332(RGB332To565((uint8_t)c)) == c);
+}
+
+
+/// One random span of each converter against the one pixel converters.
+static void CheckSpans(void)
+{
+    uint32_t n = rand() % 40;
+    int off = rand() % 4;
+    uint8_t s8[200], d8[200], e8[200];
+    color_t s16[64], d16[64], e16[64];
+
+    for (int i = 0; i < 200; i++)
+        s8[i] = (uint8_t)rand();
+    for (int i = 0; i < 64; i++)
+        s16[i] = (color_t)rand();
+    const uint8_t * p = s8 + off;
+
+    RGB888ToRGB565(d16, p, n);
+    for (uint32_t i = 0; i < n; i++)
+        CHECK(d16[i] == RGB888To565(p[3*i], p[3*i+1], p[3*i+2]));
+    BGR888ToRGB565(d16, p, n);
+    for (uint32_t i = 0; i < n; i++)
+        CHECK(d16[i] == RGB888To565(p[3*i+2], p[3*i+1], p[3*i]));
+    RGB888ToWire565(d8 + off, p, n);
+    for (uint32_t i = 0; i < n; i++)
+        CHECK(IsWire(d8 + off + 2*i, RGB888To565(p[3*i], p[3*i+1], p[3*i+2])));
+    BGR888ToWire565(d8, p, n);
+    for (uint32_t i = 0; i < n; i++)
+        CHECK(IsWire(d8 + 2*i, RGB888To565(p[3*i+2], p[3*i+1], p[3*i])));
+    RGB565ToWire(d8 + off, s16, n);
+    for (uint32_t i = 0; i < n; i++)
+        CHECK(IsWire(d8 + off + 2*i, s16[i]));
+    WireToRGB565(d16, d8 + off, n);
+    for (uint32_t i = 0; i < n; i++)
+        CHECK(d16[i] == s16[i]);
+    RGB565ToRGB888(d8 + off, s16, n);
+    RGB565ToBGR888(e8, s16, n);
+    for (uint32_t i = 0; i < n; i++) {
+        const uint8_t * q = d8 + off + 3*i;
+
+        CHECK(q[0] == e8[3*i+2] && q[1] == e8[3*i+1] && q[2] == e8[3*i]);
+        CHECK(RGB888To565(q[0], q[1], q[2]) == s16[i]);
+    }
+    RGB565ToRGB332(d8 + off, s16, n);
+    for (uint32_t i = 0; i < n; i++)
+        CHECK(d8[off + i] == RGB565To332(s16[i]));
+    RGB332ToRGB565(d16, p, n);
+    for (uint32_t i = 0; i < n; i++)
+        CHECK(d16[i] == RGB332To565(p[i]));
+    SwapRedBlue888(d8, p, n);
+    for (uint32_t i = 0; i < n; i++)
+        CHECK(d8[3*i] == p[3*i+2] && d8[3*i+1] == p[3*i+1] && d8[3*i+2] == p[3*i]);
+    SwapColorBytes(d16, s16, n);
+    for (uint32_t i = 0; i < n; i++)
+        CHECK(d16[i] == SwapColorBytes(s16[i]));
+
+    // in place, where the header allows it
+    memcpy(e8, s8, sizeof(e8));
+    RGB888ToRGB565((color_t *)e8, e8, n);
+    for (uint32_t i = 0; i < n; i++) {
+        color_t c;
+
+        memcpy(&c, e8 + 2*i, 2);
+        CHECK(c == RGB888To565(s8[3*i], s8[3*i+1], s8[3*i+2]));
+    }
+    memcpy(e8, s8, sizeof(e8));
+    BGR888ToWire565(e8, e8, n);
+    for (uint32_t i = 0; i < n; i++)
+        CHECK(IsWire(e8 + 2*i, RGB888To565(s8[3*i+2], s8[3*i+1], s8[3*i])));
+    memcpy(e16, s16, sizeof(e16));
+    RGB565ToWire((uint8_t *)e16, e16, n);
+    WireToRGB565(e16, (uint8_t *)e16, n);
+    for (uint32_t i = 0; i < n; i++)
+        CHECK(e16[i] == s16[i]);
+    memcpy(e16, s16, sizeof(e16));
+    RGB565ToRGB332((uint8_t *)e16, e16, n);
+    for (uint32_t i = 0; i < n; i++)
+        CHECK(((uint8_t *)e16)[i] == RGB565To332(s16[i]));
+    memcpy(e8, s8, sizeof(e8));
+    SwapRedBlue888(e8, e8, n);
+    for (uint32_t i = 0; i < n; i++)
+        CHECK(e8[3*i] == s8[3*i+2] && e8[3*i+1] == s8[3*i+1] && e8[3*i+2] == s8[3*i]);
+    memcpy(e16, s16, sizeof(e16));
+    SwapColorBytes(e16, e16, n);
+    for (uint32_t i = 0; i < n; i++)
+        CHECK(e16[i] == SwapColorBytes(s16[i]));
+}
+
+
+/// A cycle count where the host has one, else nanoseconds.
+static unsigned long long Ticks(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (unsigned long long)t.tv_sec * 1000000000ULL + t.tv_nsec;
+#endif
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+#define TICK_NAME "cycle"
+#else
+#define TICK_NAME "nsec"
+#endif
+
+static uint8_t row8[3 * ROW + 4], out8[3 * ROW + 4];
+static color_t row16[ROW + 2], out16[ROW + 2];
+
+
+static void Convert(int k)
+{
+    switch (k) {
+        case 0:  RGB888ToRGB565(out16, row8, ROW); break;
+        case 1:  BGR888ToRGB565(out16, row8, ROW); break;
+        case 2:  BGR888ToWire565(out8, row8, ROW); break;
+        case 3:  RGB565ToWire(out8, row16, ROW); break;
+        case 4:  WireToRGB565(out16, row8, ROW); break;
+        case 5:  RGB565ToRGB888(out8, row16, ROW); break;
+        case 6:  RGB565ToBGR888(out8, row16, ROW); break;
+        case 7:  RGB565ToRGB332(out8, row16, ROW); break;
+        case 8:  RGB332ToRGB565(out16, row8, ROW); break;
+        case 9:  SwapRedBlue888(out8, row8, ROW); break;
+        case 10: SwapColorBytes(out16, row16, ROW); break;
+    }
+}
+
+
+int main(void)
+{
+    static const char * const names[11] = {
+        "888 to 565", "BGR888 to 565", "BGR888 to wire", "565 to wire", "wire to 565",
+        "565 to 888", "565 to BGR888", "565 to 332", "332 to 565",
+        "swap red, blue", "swap bytes"
+    };
+
+    srand(1);
+    CheckPixels();
+    for (int t = 0; t < TRIALS && fails < 10; t++)
+        CheckSpans();
+#ifdef COLOR_SCALAR
+    printf("COLOR_SCALAR: %d failures\n", fails);
+#else
+    printf("word at a time: %d failures\n", fails);
+#endif
+
+    for (int i = 0; i < 3 * ROW; i++)
+        row8[i] = (uint8_t)rand();
+    for (int i = 0; i < ROW; i++)
+        row16[i] = (color_t)rand();
+    for (int k = 0; k < 11; k++) {
+        unsigned long long best = ~0ULL;
+
+        for (int s = 0; s < SAMPLES; s++) {
+            unsigned long long t = Ticks();
+            for (int r = 0; r < ROW_LOOPS; r++) {
+                Convert(k);
+                __asm__ volatile("" ::: "memory");
+            }
+            t = Ticks() - t;
+            if (t < best)
+                best = t;
+        }
+        printf("  %-15s %5.2f pixels per %s\n", names[k],
+            (double)ROW * ROW_LOOPS / (double)best, TICK_NAME);
+    }
+    return fails ? 1 : 0;
+}
@@ -0,0 +1,224 @@
+/// RegionTest - checks and times the Region methods on the host.
+///
+/// Random sequences of Union, Subtract and Intersect are checked against
+/// a bitmap of the same operations. Every result must cover exactly the
+/// pixels of the bitmap, be in bands, and Simplify to rectangles that
+/// still cover all of it. An operation that runs out of capacity only
+/// has to give a superset.
+///
+/// Then a damage list like a frame of widgets is timed: 16 unions, a
+/// copy and 4 subtracts, and a Simplify to 4 rectangles.
+///
+/// Build and run it with "make region" in this directory.
+///
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "Region.h"
+
+#define GRID_W      500
+#define GRID_H      300
+#define TRIALS      3000
+#define BENCH_LOOPS 20000
+
+static uint8_t expect[GRID_H][GRID_W];
+static uint8_t drawn[GRID_H][GRID_W];
+
+
+static rect_t MakeRect(int x1, int y1, int x2, int y2)
+{
+    rect_t r;
+
+    r.p1.x = (loc_t)x1;
+    r.p1.y = (loc_t)y1;
+    r.p2.x = (loc_t)x2;
+    r.p2.y = (loc_t)y2;
+    return r;
+}
+
+
+static uint32_t RectArea(const rect_t & r)
+{
+    return (uint32_t)(r.p2.x - r.p1.x + 1) * (uint32_t)(r.p2.y - r.p1.y + 1);
+}
+
+
+static void Fill(uint8_t grid[GRID_H][GRID_W], const rect_t & r, uint8_t v)
+{
+    for (int y = r.p1.y; y <= r.p2.y; y++)
+        for (int x = r.p1.x; x <= r.p2.x; x++)
+            grid[y][x] = v;
+}
+
+
+/// Paint the rectangles into drawn, and fail if any two overlap.
+static bool Paint(const rect_t * rects, int n)
+{
+    bool ok = true;
+
+    memset(drawn, 0, sizeof(drawn));
+    for (int i = 0; i < n; i++) {
+        for (int y = rects[i].p1.y; y <= rects[i].p2.y; y++) {
+            for (int x = rects[i].p1.x; x <= rects[i].p2.x; x++) {
+                if (drawn[y][x])
+                    ok = false;
+                drawn[y][x] = 1;
+            }
+        }
+    }
+    return ok;
+}
+
+
+/// Run one random sequence of operations, and check the result.
+static bool Trial(void)
+{
+    Region r(256);
+    bool overflow = false;
+    bool ok = true;
+    int ops = 1 + rand() % 8;
+
+    memset(expect, 0, sizeof(expect));
+    for (int k = 0; k < ops; k++) {
+        int x = rand() % 450;
+        int y = rand() % 250;
+        rect_t q = MakeRect(x, y, x + rand() % 60, y + rand() % 40);
+        int op = (k == 0) ? 0 : rand() % 3;
+        RetCode_t ret;
+
+        if (op == 0) {
+            ret = r.Union(q);
+            Fill(expect, q, 1);
+        } else if (op == 1) {
+            ret = r.Subtract(q);
+            Fill(expect, q, 0);
+        } else {
+            ret = r.Intersect(q);
+            for (int yy = 0; yy < GRID_H; yy++)
+                for (int xx = 0; xx < GRID_W; xx++)
+                    if (yy < q.p1.y || yy > q.p2.y || xx < q.p1.x || xx > q.p2.x)
+                        expect[yy][xx] = 0;
+        }
+        if (ret != noerror)
+            overflow = true;
+    }
+
+    // A superset may overlap itself only when it overflowed.
+    rect_t all[256];
+    for (int i = 0; i < r.Count(); i++)
+        all[i] = r.Rect(i);
+    if (!Paint(all, r.Count()) && !overflow)
+        ok = false;
+    uint32_t area = 0;
+    for (int y = 0; y < GRID_H; y++) {
+        for (int x = 0; x < GRID_W; x++) {
+            if (expect[y][x])
+                area++;
+            if (expect[y][x] && !drawn[y][x])
+                ok = false;
+            if (!overflow && !expect[y][x] && drawn[y][x])
+                ok = false;
+        }
+    }
+    if (!overflow && area != r.Area())
+        ok = false;
+
+    // Banded: each rectangle is below the last, or right of it in the same band.
+    for (int i = 1; i < r.Count(); i++) {
+        const rect_t & p = r.Rect(i - 1);
+        const rect_t & c = r.Rect(i);
+        if (!(c.p1.y > p.p1.y
+        || (c.p1.y == p.p1.y && c.p2.y == p.p2.y && c.p1.x > p.p2.x + 1)))
+            ok = false;
+    }
+
+    // Simplify may only grow the region.
+    rect_t out[4];
+    int n = r.Simplify(out, 4);
+    if (n > 4)
+        return false;
+    memset(drawn, 0, sizeof(drawn));
+    for (int i = 0; i < n; i++)
+        Fill(drawn, out[i], 1);
+    for (int y = 0; y < GRID_H; y++)
+        for (int x = 0; x < GRID_W; x++)
+            if (expect[y][x] && !drawn[y][x])
+                ok = false;
+    return ok;
+}
+
+
+static double Microseconds(void)
+{
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1e6 + t.tv_nsec / 1e3;
+}
+
+
+int main(void)
+{
+    int fails = 0;
+
+    srand(1);
+    for (int trial = 0; trial < TRIALS; trial++) {
+        if (!Trial()) {
+            if (fails < 5)
+                printf("trial %d failed\n", trial);
+            fails++;
+        }
+    }
+    printf("%d of %d trials failed\n", fails, TRIALS);
+
+    rect_t damage[16];
+    for (int i = 0; i < 16; i++) {
+        int x = rand() % 420;
+        int y = rand() % 230;
+        damage[i] = MakeRect(x, y, x + 10 + rand() % 50, y + 5 + rand() % 35);
+    }
+    volatile int sink = 0;
+    double t0, t1;
+
+    t0 = Microseconds();
+    for (int k = 0; k < BENCH_LOOPS; k++) {
+        rect_t store[64];
+        Region r(store, 64);
+        for (int i = 0; i < 16; i++)
+            r.Union(damage[i]);
+        sink += r.Count();
+    }
+    t1 = Microseconds();
+    rect_t baseStore[64];
+    Region base(baseStore, 64);
+    for (int i = 0; i < 16; i++)
+        base.Union(damage[i]);
+    printf("16 unions:          %6.2f usec, %d rects\n", (t1 - t0) / BENCH_LOOPS, base.Count());
+
+    t0 = Microseconds();
+    for (int k = 0; k < BENCH_LOOPS; k++) {
+        rect_t store[64];
+        Region r(store, 64);
+        r.Set(base);
+        for (int i = 0; i < 4; i++)
+            r.Subtract(damage[i * 3]);
+        sink += r.Count();
+    }
+    t1 = Microseconds();
+    printf("copy + 4 subtracts: %6.2f usec\n", (t1 - t0) / BENCH_LOOPS);
+
+    t0 = Microseconds();
+    for (int k = 0; k < BENCH_LOOPS; k++) {
+        rect_t out[4];
+        sink += base.Simplify(out, 4);
+    }
+    t1 = Microseconds();
+    rect_t out[4];
+    int n = base.Simplify(out, 4);
+    uint32_t area = 0;
+    for (int i = 0; i < n; i++)
+        area += RectArea(out[i]);
+    printf("simplify %2d to %d:  %6.2f usec, %u to %u pixels\n", base.Count(), n,
+        (t1 - t0) / BENCH_LOOPS, base.Area(), area);
+    return fails ? 1 : 0;
+}